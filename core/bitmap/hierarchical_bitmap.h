@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Two-layer occupancy bitmap.
+// - Layer 0: one bit per slot, packed in 64-bit words
+// - Layer 1 (summary): one bit per layer-0 word, set when that word is non-zero
+// next()/prev() find the closest set bit with tzcnt/lzcnt on at most 2 words in the common case,
+// long empty stretches are skipped on the summary layer (4 summary words per step with AVX2).
+class HierarchicalBitmap
+{
+    std::vector<uint64_t> m_words;
+    std::vector<uint64_t> m_summary;
+    size_t m_size = 0;
+
+public:
+    static constexpr size_t npos = SIZE_MAX;
+
+    HierarchicalBitmap() = default;
+    explicit HierarchicalBitmap(size_t size) { resize(size); }
+
+    void resize(size_t size)
+    {
+        m_size = size;
+        m_words.assign((size + 63) / 64, 0);
+        m_summary.assign((m_words.size() + 63) / 64, 0);
+    }
+
+    // Only the non-zero words (found through the summary) are written
+    void clear()
+    {
+        for (size_t s = 0; s < m_summary.size(); ++s)
+        {
+            for (uint64_t bits = m_summary[s]; bits; bits &= bits - 1)
+            {
+                m_words[(s << 6) + std::countr_zero(bits)] = 0;
+            }
+            m_summary[s] = 0;
+        }
+    }
+
+    // Visit every set bit in increasing order
+    template <typename F>
+    inline void for_each_set(F&& fn) const
+    {
+        for (size_t w = next_word_from(0); w != npos; w = next_word_from(w + 1))
+        {
+            for (uint64_t bits = m_words[w]; bits; bits &= bits - 1)
+            {
+                fn((w << 6) + std::countr_zero(bits));
+            }
+        }
+    }
+
+    inline size_t size() const { return m_size; }
+
+    inline bool test(size_t i) const
+    {
+        return (m_words[i >> 6] >> (i & 63)) & 1;
+    }
+
+    inline void set(size_t i)
+    {
+        size_t w = i >> 6;
+        m_words[w] |= 1ULL << (i & 63);
+        m_summary[w >> 6] |= 1ULL << (w & 63);
+    }
+
+    inline void reset(size_t i)
+    {
+        size_t w = i >> 6;
+        m_words[w] &= ~(1ULL << (i & 63));
+        if (m_words[w] == 0)
+        {
+            m_summary[w >> 6] &= ~(1ULL << (w & 63));
+        }
+    }
+
+    // First set bit at index >= from, npos if none
+    inline size_t next(size_t from) const
+    {
+        if (from >= m_size) return npos;
+
+        size_t w = from >> 6;
+        uint64_t bits = m_words[w] & (~0ULL << (from & 63));
+        if (bits) return (w << 6) + std::countr_zero(bits);
+
+        size_t next_word = next_word_from(w + 1);
+        if (next_word == npos) return npos;
+
+        return (next_word << 6) + std::countr_zero(m_words[next_word]);
+    }
+
+    // Last set bit at index <= from, npos if none
+    inline size_t prev(size_t from) const
+    {
+        if (m_size == 0 || from == npos) return npos;
+        if (from >= m_size) from = m_size - 1;
+
+        size_t w = from >> 6;
+        uint64_t bits = m_words[w] & mask_up_to(from & 63);
+        if (bits) return (w << 6) + 63 - std::countl_zero(bits);
+
+        if (w == 0) return npos;
+
+        size_t prev_word = prev_word_from(w - 1);
+        if (prev_word == npos) return npos;
+
+        return (prev_word << 6) + 63 - std::countl_zero(m_words[prev_word]);
+    }
+
+private:
+    static inline uint64_t mask_up_to(size_t bit)
+    {
+        return bit == 63 ? ~0ULL : ((1ULL << (bit + 1)) - 1);
+    }
+
+    // First non-zero layer-0 word at index >= w
+    inline size_t next_word_from(size_t w) const
+    {
+        if (w >= m_words.size()) return npos;
+
+        size_t s = w >> 6;
+        uint64_t bits = m_summary[s] & (~0ULL << (w & 63));
+        if (bits) return (s << 6) + std::countr_zero(bits);
+
+        for (++s; s < m_summary.size(); ++s)
+        {
+#ifdef __AVX2__
+            // Skip 4 empty summary words (16384 slots) at a time
+            while (s + 4 <= m_summary.size())
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_summary[s]));
+                if (!_mm256_testz_si256(v, v)) break;
+                s += 4;
+            }
+            if (s >= m_summary.size()) break;
+#endif
+            if (m_summary[s]) return (s << 6) + std::countr_zero(m_summary[s]);
+        }
+        return npos;
+    }
+
+    // Last non-zero layer-0 word at index <= w
+    inline size_t prev_word_from(size_t w) const
+    {
+        size_t s = w >> 6;
+        uint64_t bits = m_summary[s] & mask_up_to(w & 63);
+        if (bits) return (s << 6) + 63 - std::countl_zero(bits);
+
+        while (s > 0)
+        {
+#ifdef __AVX2__
+            // Skip 4 empty summary words (16384 slots) at a time
+            while (s >= 4)
+            {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_summary[s - 4]));
+                if (!_mm256_testz_si256(v, v)) break;
+                s -= 4;
+            }
+            if (s == 0) break;
+#endif
+            --s;
+            if (m_summary[s]) return (s << 6) + 63 - std::countl_zero(m_summary[s]);
+        }
+        return npos;
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Single-threaded object pool backed by fixed-size slabs.
+// - Objects never move once acquired (slabs are never reallocated), so raw pointers stay valid
+// - Released objects go to an intrusive free list and are reused LIFO (hot in cache)
+// - reset() drops every live object in O(1) without returning memory to the system
+template <class T, size_t SlabSize = 65536>
+class SlabPool
+{
+    static_assert(std::is_trivially_destructible_v<T>, "SlabPool requires a trivially destructible type");
+    static_assert(SlabSize > 0, "SlabSize must be greater than 0");
+
+    union Slot
+    {
+        Slot* next_free;
+        alignas(T) std::byte storage[sizeof(T)];
+    };
+
+    std::vector<std::unique_ptr<Slot[]>> m_slabs;
+    Slot* m_free_list = nullptr;
+    size_t m_slab_index = 0;    // slab currently used for bump allocation
+    size_t m_slab_offset = 0;   // next unused slot inside that slab
+    size_t m_live_count = 0;
+
+public:
+    SlabPool() = default;
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    // Pre-allocate enough slabs to hold `count` objects
+    void reserve(size_t count)
+    {
+        size_t needed = (count + SlabSize - 1) / SlabSize;
+        while (m_slabs.size() < needed)
+        {
+            m_slabs.emplace_back(new Slot[SlabSize]);
+        }
+    }
+
+    template <typename... Args>
+    inline T* acquire(Args&&... args)
+    {
+        Slot* slot;
+        if (m_free_list != nullptr)
+        {
+            slot = m_free_list;
+            m_free_list = slot->next_free;
+        }
+        else
+        {
+            if (m_slab_index == m_slabs.size() || m_slab_offset == SlabSize)
+            {
+                next_slab();
+            }
+            slot = &m_slabs[m_slab_index][m_slab_offset++];
+        }
+
+        m_live_count++;
+        return ::new (slot->storage) T{std::forward<Args>(args)...};
+    }
+
+    inline void release(T* object)
+    {
+        Slot* slot = reinterpret_cast<Slot*>(object);
+        slot->next_free = m_free_list;
+        m_free_list = slot;
+        m_live_count--;
+    }
+
+    // Forget every live object, keep the slabs for reuse
+    void reset()
+    {
+        m_free_list = nullptr;
+        m_slab_index = 0;
+        m_slab_offset = 0;
+        m_live_count = 0;
+    }
+
+    inline size_t size() const { return m_live_count; }
+    inline size_t capacity() const { return m_slabs.size() * SlabSize; }
+
+private:
+    void next_slab()
+    {
+        if (m_slab_index < m_slabs.size())
+        {
+            m_slab_index++;
+        }
+
+        if (m_slab_index == m_slabs.size())
+        {
+            m_slabs.emplace_back(new Slot[SlabSize]);
+        }
+        m_slab_offset = 0;
+    }
+};
@@ -24,7 +24,11 @@ enum EventBaseID
     BUY_SPOT_STRATEGY,        // Strategy - Buy Spot
     MEAN_REVERSION_STRATEGY,  // Strategy - Mean Reversion Strategy
     PRICE_ARBITRAGE_STRATEGY, // Strategy - Price Arbitrage
-    TREND_FOLLOW_STRATEGY     // Strategy - Trend Follow
+    TREND_FOLLOW_STRATEGY,    // Strategy - Trend Follow
+
+    DBN_READER,               // DBN replay reader (pipelined replay)
+
+    ORDERBOOK_SHARD_0         // OrderBook shards - shard i runs on ORDERBOOK_SHARD_0 + i
 };
 
 class EventBaseManager
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Binary indexed (Fenwick) tree over slots [0, size): point add and prefix sum in O(log n).
+// T needs a value-initialized zero, += and -=.
+template <class T>
+class FenwickTree
+{
+    std::vector<T> m_tree;  // 1-based: m_tree[i] sums the (i & -i) slots ending at slot i - 1
+
+public:
+    FenwickTree() : m_tree(1) {}
+    explicit FenwickTree(size_t size) : m_tree(size + 1) {}
+
+    inline size_t size() const { return m_tree.size() - 1; }
+
+    // All slots back to zero, new size
+    void reset(size_t size)
+    {
+        m_tree.assign(size + 1, T{});
+    }
+
+    // Replace every slot with `values` (values.size() slots) in O(n)
+    void build(const std::vector<T>& values)
+    {
+        m_tree.assign(values.size() + 1, T{});
+        for (size_t i = 1; i < m_tree.size(); ++i)
+        {
+            m_tree[i] += values[i - 1];
+            size_t parent = i + (i & (~i + 1));
+            if (parent < m_tree.size())
+            {
+                m_tree[parent] += m_tree[i];
+            }
+        }
+    }
+
+    inline void add(size_t slot, const T& delta)
+    {
+        for (size_t i = slot + 1; i < m_tree.size(); i += i & (~i + 1))
+        {
+            m_tree[i] += delta;
+        }
+    }
+
+    // Sum of slots [0, slot)
+    inline T prefix_sum(size_t slot) const
+    {
+        T sum{};
+        for (size_t i = slot; i > 0; i -= i & (~i + 1))
+        {
+            sum += m_tree[i];
+        }
+        return sum;
+    }
+};
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Insert-only map from integer keys to pointers: one writer thread, lock-free readers on any thread.
+// - Linear probing from the low bits of the key (dense ids and instrument ids spread by themselves)
+// - A slot's value is stored before its key (release), a reader that sees the key sees the value
+// - Power-of-two capacity, doubles at half load: the new table is filled, then swapped in. Outgrown tables are kept
+//   until the map goes away since a reader may still be probing them (at most as much memory as the current one)
+//
+// EmptyKey marks empty slots and is rejected: find() returns nullptr, insert() returns false. Values are not nullptr.
+template <class T, uint64_t EmptyKey = std::numeric_limits<uint64_t>::max()>
+class AtomicPointerMap
+{
+    struct Slot
+    {
+        std::atomic<uint64_t> key = EmptyKey;
+        std::atomic<T*> value = nullptr;
+    };
+
+    struct Table
+    {
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    std::vector<std::unique_ptr<Table>> m_tables;   // current one last (writer only)
+    std::atomic<const Table*> m_table = nullptr;    // current one (readers)
+    size_t m_size = 0;
+
+public:
+    AtomicPointerMap(size_t initial_capacity = 16)
+    {
+        size_t capacity = 2;
+        while (capacity < initial_capacity) capacity <<= 1;
+        grow(capacity);
+    }
+
+    AtomicPointerMap(const AtomicPointerMap&) = delete;
+    AtomicPointerMap& operator=(const AtomicPointerMap&) = delete;
+
+    // Any thread: nullptr when the key has not been inserted (yet)
+    inline T* find(uint64_t key) const
+    {
+        if (key == EmptyKey) [[unlikely]] return nullptr;
+
+        const Table* table = m_table.load(std::memory_order_acquire);
+        for (size_t pos = key & table->mask; ; pos = (pos + 1) & table->mask)
+        {
+            uint64_t slot_key = table->slots[pos].key.load(std::memory_order_acquire);
+            if (slot_key == key) return table->slots[pos].value.load(std::memory_order_relaxed);
+            if (slot_key == EmptyKey) return nullptr;
+        }
+    }
+
+    // Writer thread only. A key is inserted once, false for EmptyKey or a key already there
+    bool insert(uint64_t key, T* value)
+    {
+        if (key == EmptyKey || find(key) != nullptr) return false;
+
+        if (2 * (m_size + 1) > capacity())
+        {
+            grow(2 * capacity());
+        }
+        place(*m_tables.back(), key, value);
+        ++m_size;
+        return true;
+    }
+
+    inline size_t size() const { return m_size; }
+    inline size_t capacity() const { return m_tables.back()->mask + 1; }
+
+private:
+    static void place(Table& table, uint64_t key, T* value)
+    {
+        size_t pos = key & table.mask;
+        while (table.slots[pos].key.load(std::memory_order_relaxed) != EmptyKey) pos = (pos + 1) & table.mask;
+
+        table.slots[pos].value.store(value, std::memory_order_relaxed);
+        table.slots[pos].key.store(key, std::memory_order_release);
+    }
+
+    void grow(size_t capacity)
+    {
+        auto table = std::make_unique<Table>(Table{capacity - 1, std::make_unique<Slot[]>(capacity)});
+        if (!m_tables.empty())
+        {
+            const Table& current = *m_tables.back();
+            for (size_t pos = 0; pos <= current.mask; ++pos)
+            {
+                uint64_t key = current.slots[pos].key.load(std::memory_order_relaxed);
+                if (key != EmptyKey) place(*table, key, current.slots[pos].value.load(std::memory_order_relaxed));
+            }
+        }
+
+        m_table.store(table.get(), std::memory_order_release);
+        m_tables.push_back(std::move(table));
+    }
+};
@@ -0,0 +1,334 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// 64-bit mixing hash (murmur3 fmix64), spreads sequential ids over the whole table
+struct Mix64Hash
+{
+    inline uint64_t operator()(uint64_t key) const
+    {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+};
+
+// Open-addressing hash map for integer keys.
+// - Robin Hood linear probing, backward-shift deletion (no tombstones)
+// - Power-of-two capacity, grows x2 above 7/8 load
+// - Slots are stored flat: { key, value }, an empty slot holds EmptyKey
+// - The probe distance of a resident is recomputed from its hash, so no metadata is stored
+// - clear() is O(1): it bumps a generation, blocks of slots whose generation is behind count as empty.
+//   Inserts then wipe them back to EmptyKey, one block per insert (or at once when written into),
+//   after the sweep lookups only compare keys again
+//
+// EmptyKey marks empty slots and is rejected: find() returns nullptr, insert_or_assign() and erase() return false.
+// Pointers returned by find() are invalidated by insert/erase.
+template <class K, class V, K EmptyKey = std::numeric_limits<K>::max(), class Hash = Mix64Hash>
+class FlatHashMap
+{
+    static_assert(std::is_integral_v<K>, "FlatHashMap only supports integer keys");
+
+public:
+    struct Slot
+    {
+        K key;
+        V value;
+    };
+
+private:
+    static constexpr size_t BLOCK_SHIFT = 4;   // 16 slots per generation block
+    static constexpr size_t SWEEP_BLOCKS = 1;  // stale blocks wiped per insert while sweeping
+
+    std::unique_ptr<Slot[]> m_slots;
+    std::unique_ptr<uint32_t[]> m_block_generations;   // generation each block of slots was last wiped in
+    uint32_t m_generation = 0;
+    bool m_sweeping = false;    // some blocks are still behind m_generation
+    size_t m_sweep_block = 0;   // next block the sweep looks at
+    size_t m_mask = 0;
+    size_t m_size = 0;
+    size_t m_grow_at = 0;
+    Hash m_hash;
+    V m_rejected;               // operator[] of EmptyKey: never stored, reset on each use
+
+public:
+    FlatHashMap(size_t initial_capacity = 16)
+    {
+        allocate(round_up_power_of_two(initial_capacity));
+    }
+
+    FlatHashMap(const FlatHashMap&) = delete;
+    FlatHashMap& operator=(const FlatHashMap&) = delete;
+
+    // Make sure `count` elements fit without rehashing
+    void reserve(size_t count)
+    {
+        size_t capacity = round_up_power_of_two(count + count / 7 + 1);
+        if (capacity > this->capacity())
+        {
+            rehash(capacity);
+        }
+    }
+
+    inline V* find(K key)
+    {
+        if (key == EmptyKey) [[unlikely]] return nullptr;   // would match the first empty slot
+
+        size_t pos = home(key);
+        for (size_t dist = 0;; ++dist, pos = (pos + 1) & m_mask)
+        {
+            if (is_empty(pos)) return nullptr;
+
+            Slot& slot = m_slots[pos];
+            if (slot.key == key) return &slot.value;
+
+            // Robin Hood invariant: the key would have been placed before a "richer" resident
+            if (probe_distance(slot.key, pos) < dist) return nullptr;
+        }
+    }
+
+    inline const V* find(K key) const
+    {
+        return const_cast<FlatHashMap*>(this)->find(key);
+    }
+
+    inline bool contains(K key) const
+    {
+        return find(key) != nullptr;
+    }
+
+    // Insert or overwrite, false for EmptyKey
+    inline bool insert_or_assign(K key, V value)
+    {
+        if (key == EmptyKey) [[unlikely]] return false;
+
+        if (V* existing = find(key))
+        {
+            *existing = std::move(value);
+            return true;
+        }
+
+        if (m_size >= m_grow_at)
+        {
+            rehash(capacity() * 2);
+        }
+
+        if (m_sweeping) [[unlikely]] sweep_step();
+        insert_new(key, std::move(value));
+        m_size++;
+        return true;
+    }
+
+    // EmptyKey gets a scratch value that is not part of the map
+    inline V& operator[](K key)
+    {
+        if (key == EmptyKey) [[unlikely]] return m_rejected = V{};
+        if (V* existing = find(key)) return *existing;
+
+        insert_or_assign(key, V{});
+        return *find(key);
+    }
+
+    inline bool erase(K key)
+    {
+        if (key == EmptyKey) [[unlikely]] return false;   // would empty the first empty slot and drop m_size
+
+        size_t pos = home(key);
+        for (size_t dist = 0;; ++dist, pos = (pos + 1) & m_mask)
+        {
+            if (is_empty(pos)) return false;
+
+            Slot& slot = m_slots[pos];
+            if (slot.key == key) break;
+            if (probe_distance(slot.key, pos) < dist) return false;
+        }
+
+        // Backward-shift: pull following displaced residents one slot closer to home
+        size_t next = (pos + 1) & m_mask;
+        while (!is_empty(next) && probe_distance(m_slots[next].key, next) > 0)
+        {
+            m_slots[pos] = std::move(m_slots[next]);
+            pos = next;
+            next = (next + 1) & m_mask;
+        }
+
+        m_slots[pos].key = EmptyKey;
+        m_size--;
+        return true;
+    }
+
+    // Hint the CPU to bring the home slot of `key` into cache
+    inline void prefetch(K key) const
+    {
+        __builtin_prefetch(&m_slots[home(key)]);
+    }
+
+    // O(1), the capacity is kept
+    void clear()
+    {
+        if (m_size == 0) return;    // every slot already empty, the blocks stay current
+
+        m_size = 0;
+        if (++m_generation == 0)
+        {
+            // Wrapped around: blocks of 2^32 clears ago would look current again
+            wipe_all();
+            return;
+        }
+
+        m_sweeping = true;
+        m_sweep_block = 0;
+    }
+
+    template <typename F>
+    void for_each(F&& fn) const
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+        {
+            if (!is_empty(i)) fn(m_slots[i].key, m_slots[i].value);
+        }
+    }
+
+    inline size_t size() const { return m_size; }
+    inline bool empty() const { return m_size == 0; }
+    inline size_t capacity() const { return m_mask + 1; }
+    inline size_t memory_usage() const { return capacity() * sizeof(Slot) + block_count() * sizeof(uint32_t); }
+
+private:
+    static size_t round_up_power_of_two(size_t n)
+    {
+        size_t capacity = 16;
+        while (capacity < n) capacity <<= 1;
+        return capacity;
+    }
+
+    inline size_t home(K key) const
+    {
+        return m_hash((uint64_t)key) & m_mask;
+    }
+
+    inline size_t probe_distance(K key, size_t pos) const
+    {
+        return (pos - home(key)) & m_mask;
+    }
+
+    inline size_t block_count() const
+    {
+        return (capacity() + (1 << BLOCK_SHIFT) - 1) >> BLOCK_SHIFT;
+    }
+
+    // A slot of a block left behind by clear() is empty whatever its key
+    inline bool is_empty(size_t pos) const
+    {
+        return m_slots[pos].key == EmptyKey || (m_sweeping && m_block_generations[pos >> BLOCK_SHIFT] != m_generation);
+    }
+
+    // Before writing into an empty slot: a stale block is wiped as a whole, its other slots must not come back
+    inline void claim_block(size_t pos)
+    {
+        if (!m_sweeping) [[likely]] return;
+
+        size_t block = pos >> BLOCK_SHIFT;
+        if (m_block_generations[block] != m_generation) wipe_block(block);
+    }
+
+    // Wipe the next SWEEP_BLOCKS blocks, the sweep ends after the last one
+    void sweep_step()
+    {
+        size_t end = std::min(m_sweep_block + SWEEP_BLOCKS, block_count());
+        for (; m_sweep_block < end; ++m_sweep_block)
+        {
+            if (m_block_generations[m_sweep_block] != m_generation) wipe_block(m_sweep_block);
+        }
+
+        if (m_sweep_block == block_count())
+        {
+            m_sweeping = false;
+        }
+    }
+
+    void wipe_block(size_t block)
+    {
+        size_t end = std::min((block + 1) << BLOCK_SHIFT, capacity());
+        for (size_t i = block << BLOCK_SHIFT; i < end; ++i)
+        {
+            m_slots[i].key = EmptyKey;
+        }
+        m_block_generations[block] = m_generation;
+    }
+
+    void wipe_all()
+    {
+        for (size_t i = 0; i <= m_mask; ++i)
+        {
+            m_slots[i].key = EmptyKey;
+        }
+        std::fill_n(m_block_generations.get(), block_count(), m_generation);
+        m_sweeping = false;
+    }
+
+    void allocate(size_t capacity)
+    {
+        m_slots.reset(new Slot[capacity]);
+        m_mask = capacity - 1;
+        m_grow_at = capacity - capacity / 8;
+        m_block_generations.reset(new uint32_t[block_count()]);
+        wipe_all();
+    }
+
+    // Place a key known to be absent, swapping with "richer" residents on the way
+    inline void insert_new(K key, V value)
+    {
+        size_t pos = home(key);
+        size_t dist = 0;
+        while (true)
+        {
+            Slot& slot = m_slots[pos];
+            if (is_empty(pos))
+            {
+                claim_block(pos);
+                slot.key = key;
+                slot.value = std::move(value);
+                return;
+            }
+
+            size_t resident_dist = probe_distance(slot.key, pos);
+            if (resident_dist < dist)
+            {
+                std::swap(slot.key, key);
+                std::swap(slot.value, value);
+                dist = resident_dist;
+            }
+
+            pos = (pos + 1) & m_mask;
+            dist++;
+        }
+    }
+
+    void rehash(size_t new_capacity)
+    {
+        std::unique_ptr<Slot[]> old_slots = std::move(m_slots);
+        std::unique_ptr<uint32_t[]> old_block_generations = std::move(m_block_generations);
+        size_t old_capacity = m_mask + 1;
+        bool was_sweeping = m_sweeping;
+
+        allocate(new_capacity);
+        for (size_t i = 0; i < old_capacity; ++i)
+        {
+            bool stale = was_sweeping && old_block_generations[i >> BLOCK_SHIFT] != m_generation;
+            if (!stale && old_slots[i].key != EmptyKey)
+            {
+                insert_new(old_slots[i].key, std::move(old_slots[i].value));
+            }
+        }
+    }
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <emmintrin.h>
+
+#define FORCE_INLINE inline __attribute__((always_inline))
+
+// Single-producer / single-consumer ring of values (not pointers).
+// - head is only written by the producer, tail only by the consumer, each on its own cache line
+// - both sides keep a cached copy of the other index, so the shared line is only read when the cache says full/empty
+template <class T, size_t Size>
+class SPSCQueue
+{
+    static_assert((Size & (Size - 1)) == 0, "SPSCQueue size must be a power of 2");
+
+    alignas(64) std::atomic<size_t> m_head = 0;     // next slot to write (producer)
+    alignas(64) size_t m_cached_tail = 0;           // producer's view of m_tail
+    alignas(64) std::atomic<size_t> m_tail = 0;     // next slot to read (consumer)
+    alignas(64) size_t m_cached_head = 0;           // consumer's view of m_head
+    alignas(64) std::array<T, Size> m_items;
+
+public:
+    // Producer side
+    FORCE_INLINE bool try_push(const T& item)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_cached_tail == Size)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+            if (head - m_cached_tail == Size) return false;
+        }
+
+        m_items[head & (Size - 1)] = item;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer side, spins while the consumer is behind
+    FORCE_INLINE void push(const T& item)
+    {
+        while (!try_push(item))
+        {
+            _mm_pause();
+        }
+    }
+
+    // Producer side, copies as many of the `count` items as there is room for, returns that number
+    FORCE_INLINE size_t push_batch(const T* items, size_t count)
+    {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (Size - (head - m_cached_tail) < count)
+        {
+            m_cached_tail = m_tail.load(std::memory_order_acquire);
+        }
+
+        size_t room = Size - (head - m_cached_tail);
+        if (count > room) count = room;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            m_items[(head + i) & (Size - 1)] = items[i];
+        }
+
+        m_head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side
+    FORCE_INLINE bool try_pop(T& out)
+    {
+        return pop_batch(&out, 1) == 1;
+    }
+
+    // Consumer side, copies up to `max_count` items into `out`
+    FORCE_INLINE size_t pop_batch(T* out, size_t max_count)
+    {
+        size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (m_cached_head == tail)
+        {
+            m_cached_head = m_head.load(std::memory_order_acquire);
+            if (m_cached_head == tail) return 0;
+        }
+
+        size_t count = m_cached_head - tail;
+        if (count > max_count) count = max_count;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = m_items[(tail + i) & (Size - 1)];
+        }
+
+        m_tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    FORCE_INLINE size_t size() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    FORCE_INLINE bool empty() const
+    {
+        return size() == 0;
+    }
+
+    static constexpr size_t capacity() { return Size; }
+};
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Paces a replay against event timestamps (e.g. ts_recv). Event time is mapped to wall time from a fixed anchor
+// (first event ↔ its release), so pacing errors never add up over a session.
+// - Events due less than RELEASE_GRANULARITY_NS after the first event of a group are released with it, in one batch
+// - A group only waits when it is early. A wait longer than SPIN_THRESHOLD_NS sleeps on a timer for all but the last
+//   SPIN_THRESHOLD_NS (one timer per gap, not per event), the rest is spun on the TSC, calibrated once against
+//   steady_clock. A replay running behind schedule makes no waits and no syscalls.
+// Wall time comes from a TimeSource, steady_clock unless a test injects one.
+// The TSC spin is x86 only (rdtsc / pause). Other targets spin on steady_clock for the whole wait.
+// Calibration busy-waits for CALIBRATION_NS: call ticks_per_ns() once at startup, not on a replay thread.
+class ReplayClock
+{
+public:
+    using TimeSource = int64_t (*)();   // wall time in ns
+
+    static constexpr int64_t RELEASE_GRANULARITY_NS = 1000;
+    static constexpr int64_t SPIN_THRESHOLD_NS = 100000;
+
+    // Another time source must have reached the due time when spin_until_due() is called (the TSC spin is real time)
+    explicit ReplayClock(TimeSource now = now_ns) : m_now(now) {}
+
+    // speed = 1.0 => real time, 2.0 => twice as fast. The first event after start() takes the anchor
+    void start(double speed)
+    {
+        m_speed = speed;
+        m_anchored = false;
+        m_groups = 0;
+        m_lag_sum = 0;
+        m_max_lag = 0;
+    }
+
+    // True when the event at `event_ns` opens a new group, which is released at due_ns()
+    inline bool starts_group(uint64_t event_ns)
+    {
+        if (!m_anchored) [[unlikely]]
+        {
+            m_anchored = true;
+            m_anchor_event = event_ns;
+            m_anchor_wall = m_now();
+            m_group_due = m_anchor_wall;
+            return true;
+        }
+
+        int64_t due = m_anchor_wall + (int64_t)((double)(int64_t)(event_ns - m_anchor_event) / m_speed);
+        if (due - m_group_due < RELEASE_GRANULARITY_NS) return false;
+
+        m_group_due = due;
+        return true;
+    }
+
+    inline int64_t due_ns() const { return m_group_due; }
+
+    // The current group is not due yet
+    inline bool early() const { return m_now() < m_group_due; }
+
+    // Part of the wait to sleep on a timer before spin_until_due(), 0 = none
+    inline int64_t sleep_ns() const
+    {
+        int64_t wait = m_group_due - m_now();
+        return wait > SPIN_THRESHOLD_NS ? wait - SPIN_THRESHOLD_NS : 0;
+    }
+
+    // Busy-waits on the TSC until the current group is due (returns at once when late) and records its release lag
+    inline void spin_until_due()
+    {
+        int64_t wait = m_group_due - m_now();
+        if (wait > 0)
+        {
+#if defined(__x86_64__) || defined(__i386__)
+            uint64_t end = __rdtsc() + (uint64_t)(wait * ticks_per_ns());
+            while (__rdtsc() < end) _mm_pause();
+            while (m_now() < m_group_due) _mm_pause();      // calibration error
+#else
+            while (m_now() < m_group_due) {}
+#endif
+        }
+
+        int64_t lag = std::max<int64_t>(m_now() - m_group_due, 0);
+        m_groups++;
+        m_lag_sum += lag;
+        m_max_lag = std::max(m_max_lag, lag);
+    }
+
+    // Release lag of the groups that waited: wall time past their due time
+    inline uint64_t waited_groups() const { return m_groups; }
+    inline double avg_lag_ns() const { return m_groups ? (double)m_lag_sum / m_groups : 0; }
+    inline int64_t max_lag_ns() const { return m_max_lag; }
+
+    static inline int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // TSC ticks per nanosecond, measured once over CALIBRATION_NS (1 without a TSC: the spin counts steady_clock ns)
+    static double ticks_per_ns()
+    {
+        static const double ratio = calibrate();
+        return ratio;
+    }
+
+private:
+    static constexpr int64_t CALIBRATION_NS = 2000000;
+
+    static double calibrate()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        int64_t t0 = now_ns();
+        uint64_t c0 = __rdtsc();
+        int64_t t1 = t0;
+        while (t1 - t0 < CALIBRATION_NS) t1 = now_ns();
+        uint64_t c1 = __rdtsc();
+        return (double)(c1 - c0) / (double)(t1 - t0);
+#else
+        return 1.0;
+#endif
+    }
+
+    TimeSource m_now;
+    double m_speed = 1.0;
+    bool m_anchored = false;
+    uint64_t m_anchor_event = 0;
+    int64_t m_anchor_wall = 0;
+    int64_t m_group_due = 0;
+
+    uint64_t m_groups = 0;
+    int64_t m_lag_sum = 0;
+    int64_t m_max_lag = 0;
+};
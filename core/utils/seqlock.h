@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <emmintrin.h>
+
+// Single-writer sequence lock over a trivially copyable block.
+// - The writer never waits: odd sequence while writing, even once the block is consistent again
+// - Readers copy the block and retry if the sequence moved (or was odd) meanwhile, they never block the writer
+// SAME_CACHE_LINE packs a small block right behind the sequence: a read then touches a single cache line
+// (one miss after each write instead of two), at the cost of readers and writer sharing it.
+template <class T, bool SAME_CACHE_LINE = false>
+class SeqLock
+{
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock value must be trivially copyable");
+    static_assert(!SAME_CACHE_LINE || sizeof(std::atomic<uint64_t>) + sizeof(T) <= 64, "Block does not fit in the sequence's cache line");
+
+    alignas(64) std::atomic<uint64_t> m_seq = 0;
+    alignas(SAME_CACHE_LINE ? alignof(T) : 64) T m_value{};
+
+public:
+    // Writer side, `fn(T&)` updates the block in place
+    template <typename F>
+    inline void write(F&& fn)
+    {
+        uint64_t seq = m_seq.load(std::memory_order_relaxed);
+        m_seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        fn(m_value);
+
+        m_seq.store(seq + 2, std::memory_order_release);
+    }
+
+    // Writer side
+    inline void store(const T& value)
+    {
+        write([&](T& block) { std::memcpy(&block, &value, sizeof(T)); });
+    }
+
+    // Reader side, any thread. Returns the version of the copied block (number of completed writes)
+    inline uint64_t load(T& out) const
+    {
+        while (true)
+        {
+            uint64_t seq_before = m_seq.load(std::memory_order_acquire);
+            if (seq_before & 1)
+            {
+                _mm_pause();
+                continue;
+            }
+
+            std::memcpy(&out, (const void*)&m_value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (m_seq.load(std::memory_order_relaxed) == seq_before)
+            {
+                return seq_before / 2;
+            }
+        }
+    }
+
+    inline uint64_t version() const
+    {
+        return m_seq.load(std::memory_order_acquire) / 2;
+    }
+};
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <zstd.h>
+#include <spdlog/spdlog.h>
+
+#include <databento/dbn.hpp>
+
+// Reader of a DBN file (plain or zstd-compressed) handing out MBO records in place, without per-record copies.
+// - Plain DBN: the file is mmapped read-only (sequential read-ahead and huge-page hints), batches point straight into
+//   the mapping and stay valid as long as the reader
+// - .dbn.zst (detected by the zstd magic): the mapped file is streamed through one zstd context into a large reusable
+//   buffer, batches point into that buffer and stay valid until the next call
+// The metadata header is parsed once when opening, records of other types are skipped.
+class DbnFileReader
+{
+public:
+    static constexpr size_t ZSTD_BUFFER_SIZE = 8 << 20;    // decompressed bytes buffered at once
+
+    explicit DbnFileReader(const std::string& file_path)
+    {
+        int fd = ::open(file_path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("Cannot open DBN file: " + file_path);
+        }
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size == 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Empty or unreadable DBN file: " + file_path);
+        }
+
+        m_file_size = (size_t)st.st_size;
+        void* mapping = ::mmap(nullptr, m_file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);    // the mapping keeps the file
+        if (mapping == MAP_FAILED)
+        {
+            throw std::runtime_error("Cannot mmap DBN file: " + file_path);
+        }
+
+        m_file = (const char*)mapping;
+        ::madvise(mapping, m_file_size, MADV_SEQUENTIAL);
+        ::madvise(mapping, m_file_size, MADV_HUGEPAGE);
+
+        uint32_t magic = 0;
+        std::memcpy(&magic, m_file, std::min(sizeof(magic), m_file_size));
+        if (magic == ZSTD_MAGICNUMBER)
+        {
+            m_zstd = ZSTD_createDStream();
+            ZSTD_initDStream(m_zstd);
+            m_zstd_in = ZSTD_inBuffer{m_file, m_file_size, 0};
+            m_buffer = std::make_unique_for_overwrite<uint64_t[]>(ZSTD_BUFFER_SIZE / sizeof(uint64_t));
+            m_pos = m_end = (const char*)m_buffer.get();
+        }
+        else
+        {
+            m_pos = m_file;
+            m_end = m_file + m_file_size;
+        }
+
+        if (!read_metadata())
+        {
+            close();
+            throw std::runtime_error("Not a DBN file: " + file_path);
+        }
+    }
+
+    ~DbnFileReader()
+    {
+        close();
+    }
+
+    DbnFileReader(const DbnFileReader&) = delete;
+    DbnFileReader& operator=(const DbnFileReader&) = delete;
+
+    inline uint8_t version() const { return m_version; }
+    inline const std::string& dataset() const { return m_dataset; }
+    inline bool compressed() const { return m_zstd != nullptr; }
+
+    // Offset of the next unread record in the (decompressed) DBN stream, for seek()
+    inline uint64_t offset() const
+    {
+        return m_zstd ? m_buffer_offset + (m_pos - (const char*)m_buffer.get()) : m_pos - m_file;
+    }
+
+    // Continue reading at `offset` (taken from offset() of the same file). Plain DBN jumps straight there, compressed
+    // input is decompressed from the closest point before it (the start of the file when seeking backwards), without
+    // parsing the records in between
+    bool seek(uint64_t offset)
+    {
+        if (!m_zstd)
+        {
+            if (offset < m_records_offset || offset > m_file_size) return false;
+            m_pos = m_file + offset;
+            return true;
+        }
+
+        if (offset < m_records_offset) return false;
+        if (offset < m_buffer_offset)
+        {
+            ZSTD_DCtx_reset(m_zstd, ZSTD_reset_session_only);
+            m_zstd_in.pos = 0;
+            m_buffer_offset = 0;
+            m_pos = m_end = (const char*)m_buffer.get();
+        }
+
+        // Whole buffers before the offset are dropped
+        while (m_buffer_offset + (m_end - (const char*)m_buffer.get()) < offset)
+        {
+            m_pos = m_end;
+            if (!refill(1)) return false;
+        }
+
+        m_pos = (const char*)m_buffer.get() + (offset - m_buffer_offset);
+        return true;
+    }
+
+    // Next run of consecutive MBO records, at most `max_count`, in file order. Empty at the end of the file
+    std::span<const databento::MboMsg> next_mbo_batch(size_t max_count)
+    {
+        if (max_count == 0) return {};
+
+        // Skip records of other types
+        while (true)
+        {
+            if (!ensure(sizeof(databento::RecordHeader))) return {};
+
+            const auto* header = (const databento::RecordHeader*)m_pos;
+            size_t size = header->Size();
+            if (size < sizeof(databento::RecordHeader) || !ensure(size)) return {};     // corrupt or truncated
+
+            if (is_mbo(*header)) break;
+            m_pos += size;
+        }
+
+        // MBO records are fixed-size, a run of them is an array of MboMsg
+        const auto* first = (const databento::MboMsg*)m_pos;
+        size_t available = std::min<size_t>((m_end - m_pos) / sizeof(databento::MboMsg), max_count);
+        size_t count = 1;
+        while (count < available && is_mbo(first[count].hd))
+        {
+            ++count;
+        }
+
+        m_pos += count * sizeof(databento::MboMsg);
+        return {first, count};
+    }
+
+private:
+    static inline bool is_mbo(const databento::RecordHeader& header)
+    {
+        return header.rtype == databento::RType::Mbo && header.Size() == sizeof(databento::MboMsg);
+    }
+
+    // Prefix "DBN" + version, u32 length of the rest of the metadata (dataset first), records start behind it
+    bool read_metadata()
+    {
+        static constexpr size_t PREFIX_SIZE = 8;
+        static constexpr size_t DATASET_SIZE = 16;
+
+        if (!ensure(PREFIX_SIZE) || std::memcmp(m_pos, "DBN", 3) != 0) return false;
+
+        m_version = (uint8_t)m_pos[3];
+        uint32_t length = 0;
+        std::memcpy(&length, m_pos + 4, sizeof(length));
+        if (!ensure(PREFIX_SIZE + length)) return false;
+
+        size_t dataset_size = std::min<size_t>(length, DATASET_SIZE);
+        m_dataset.assign(m_pos + PREFIX_SIZE, strnlen(m_pos + PREFIX_SIZE, dataset_size));
+        m_pos += PREFIX_SIZE + length;
+        m_records_offset = offset();
+        return true;
+    }
+
+    // At least `size` bytes readable at m_pos, false at the end of the input
+    inline bool ensure(size_t size)
+    {
+        if ((size_t)(m_end - m_pos) >= size) [[likely]] return true;
+        return m_zstd && refill(size);
+    }
+
+    // Move the unread bytes to the front of the buffer (records stay aligned) and decompress behind them
+    bool refill(size_t size)
+    {
+        char* buffer = (char*)m_buffer.get();
+        size_t left = m_end - m_pos;
+        if (size > ZSTD_BUFFER_SIZE) return false;
+
+        m_buffer_offset += m_pos - buffer;
+        std::memmove(buffer, m_pos, left);
+        ZSTD_outBuffer out{buffer, ZSTD_BUFFER_SIZE, left};
+
+        // The whole buffer is filled: fewer and larger batches
+        while (out.pos < out.size && m_zstd_in.pos < m_zstd_in.size)
+        {
+            size_t ret = ZSTD_decompressStream(m_zstd, &out, &m_zstd_in);
+            if (ZSTD_isError(ret))
+            {
+                spdlog::error("DBN zstd stream: {}", ZSTD_getErrorName(ret));
+                m_zstd_in.pos = m_zstd_in.size;
+                break;
+            }
+        }
+
+        m_pos = buffer;
+        m_end = buffer + out.pos;
+        return out.pos >= size;
+    }
+
+    void close()
+    {
+        if (m_zstd)
+        {
+            ZSTD_freeDStream(m_zstd);
+            m_zstd = nullptr;
+        }
+        if (m_file)
+        {
+            ::munmap((void*)m_file, m_file_size);
+            m_file = nullptr;
+        }
+    }
+
+    const char* m_file = nullptr;       // read-only mapping of the whole file
+    size_t m_file_size = 0;
+
+    // Unread bytes: inside the mapping, or inside m_buffer for compressed input
+    const char* m_pos = nullptr;
+    const char* m_end = nullptr;
+
+    // Compressed input
+    ZSTD_DStream* m_zstd = nullptr;
+    ZSTD_inBuffer m_zstd_in{};
+    std::unique_ptr<uint64_t[]> m_buffer;    // 8-byte aligned, MboMsg can be read in place
+    uint64_t m_buffer_offset = 0;           // stream offset of the start of m_buffer
+
+    uint64_t m_records_offset = 0;          // first record, behind the metadata
+
+    uint8_t m_version = 0;
+    std::string m_dataset;
+};
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <span>
+#include <tuple>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include <databento/dbn.hpp>
+
+#include <dbn_wrapper/dbn_file_reader.h>
+
+// MBO records of several DBN files (e.g. one per product per day) in global (ts_recv, sequence) order, ties broken
+// by file order. Each file is read through its own DbnFileReader, whose current batch is the read-ahead buffer:
+// nothing is materialized besides one merge buffer.
+// - A min-heap holds the head of every file that has records left. The winning file hands out its whole run of
+//   records up to the runner-up head at once, so files that do not overlap in time (a multi-day range) are copied
+//   in large runs and not record by record
+// - Once a single file is left (always the case for one file), its batches are handed out in place, without a copy
+// Batches stay valid until the next call.
+class DbnMergeReader
+{
+public:
+    static constexpr size_t MERGE_BATCH = 4096;     // merged MBO records handed out at once when several files overlap in time
+
+    explicit DbnMergeReader(const std::vector<std::string>& file_paths)
+    {
+        if (file_paths.empty())
+        {
+            throw std::runtime_error("No DBN file to replay");
+        }
+
+        for (const std::string& path : file_paths)
+        {
+            m_readers.push_back(std::make_unique<DbnFileReader>(path));
+        }
+        m_pending.resize(m_readers.size());
+        m_heap.reserve(m_readers.size());
+
+        for (uint32_t file = 0; file < m_readers.size(); ++file)
+        {
+            read_ahead(file);
+        }
+        if (m_readers.size() > 1)
+        {
+            m_merged = std::make_unique_for_overwrite<databento::MboMsg[]>(MERGE_BATCH);
+        }
+    }
+
+    static constexpr uint64_t NO_OFFSET = UINT64_MAX;
+
+    inline size_t file_count() const { return m_readers.size(); }
+    inline const DbnFileReader& file(size_t index) const { return *m_readers[index]; }
+
+    // Single file only: continue at `offset` of that file (see DbnFileReader::seek). The stream ends when it fails
+    bool seek(uint64_t offset)
+    {
+        if (m_readers.size() != 1) return false;
+
+        m_heap.clear();
+        m_pending[0] = {};
+        m_drained = NO_FILE;
+        if (!m_readers[0]->seek(offset)) return false;
+
+        read_ahead(0);
+        return true;
+    }
+
+    // Single file only: DbnFileReader::offset() of the first record of the last batch, NO_OFFSET otherwise
+    inline uint64_t batch_offset() const { return m_batch_offset; }
+
+    // Batches end before the first record at or after `ts_recv`, which stays pending (UINT64_MAX: no end)
+    inline void set_end_ts_recv(uint64_t ts_recv) { m_end_ts_recv = ts_recv; }
+
+    // Next MBO records in merged order, at most `max_count`. Empty at the end of every file
+    std::span<const databento::MboMsg> next_mbo_batch(size_t max_count)
+    {
+        // The last batch handed out in place emptied its file: reading ahead may overwrite it, so only now
+        if (m_drained != NO_FILE)
+        {
+            read_ahead(m_drained);
+            m_drained = NO_FILE;
+        }
+
+        if (max_count == 0 || m_heap.empty()) return {};
+
+        if (m_heap.size() == 1)
+        {
+            uint32_t file = m_heap[0].file;
+            std::span<const databento::MboMsg>& pending = m_pending[file];
+            size_t count = std::min(max_count, pending.size());
+            if (m_end_ts_recv != UINT64_MAX)
+            {
+                size_t before_end = 0;
+                while (before_end < count && ts_recv_of(pending[before_end]) < m_end_ts_recv) ++before_end;
+                count = before_end;
+            }
+
+            // Pending records are the tail of the file reader's batch, which ends at its offset
+            std::span<const databento::MboMsg> batch = pending.first(count);
+            m_batch_offset = m_readers.size() == 1 ? m_readers[file]->offset() - pending.size_bytes() : NO_OFFSET;
+            pending = pending.subspan(batch.size());
+
+            if (pending.empty())
+            {
+                m_heap.clear();
+                m_drained = file;
+            }
+            else
+            {
+                m_heap[0] = head_of(pending.front(), file);
+            }
+            return batch;
+        }
+
+        m_batch_offset = NO_OFFSET;
+        size_t limit = std::min<size_t>(max_count, MERGE_BATCH);
+        size_t count = 0;
+        while (count < limit && !m_heap.empty() && m_heap.front().ts_recv < m_end_ts_recv)
+        {
+            std::pop_heap(m_heap.begin(), m_heap.end(), later);
+            uint32_t file = m_heap.back().file;
+            m_heap.pop_back();
+
+            // Run of the winner: every record that still sorts before the runner-up head
+            std::span<const databento::MboMsg>& pending = m_pending[file];
+            size_t run_limit = std::min(pending.size(), limit - count);
+            size_t run = run_limit;
+            if (!m_heap.empty())
+            {
+                const Head& runner_up = m_heap.front();
+                run = 1;
+                while (run < run_limit && later(runner_up, head_of(pending[run], file))) ++run;
+            }
+            if (m_end_ts_recv != UINT64_MAX)
+            {
+                size_t before_end = 1;
+                while (before_end < run && ts_recv_of(pending[before_end]) < m_end_ts_recv) ++before_end;
+                run = before_end;
+            }
+
+            std::memcpy(m_merged.get() + count, pending.data(), run * sizeof(databento::MboMsg));
+            count += run;
+            pending = pending.subspan(run);
+
+            if (pending.empty())
+            {
+                read_ahead(file);   // copied out already
+            }
+            else
+            {
+                push(head_of(pending.front(), file));
+            }
+        }
+
+        return {m_merged.get(), count};
+    }
+
+private:
+    static constexpr uint32_t NO_FILE = UINT32_MAX;
+
+    struct Head
+    {
+        uint64_t ts_recv;
+        uint32_t sequence;
+        uint32_t file;
+    };
+
+    static inline uint64_t ts_recv_of(const databento::MboMsg& mbo)
+    {
+        return (uint64_t)mbo.ts_recv.time_since_epoch().count();
+    }
+
+    static inline Head head_of(const databento::MboMsg& mbo, uint32_t file)
+    {
+        return {ts_recv_of(mbo), mbo.sequence, file};
+    }
+
+    // Heap order (std heaps keep the greatest on top): `a` sorts after `b`
+    static inline bool later(const Head& a, const Head& b)
+    {
+        return std::tie(a.ts_recv, a.sequence, a.file) > std::tie(b.ts_recv, b.sequence, b.file);
+    }
+
+    inline void push(const Head& head)
+    {
+        m_heap.push_back(head);
+        std::push_heap(m_heap.begin(), m_heap.end(), later);
+    }
+
+    // Next batch of a file whose pending records are used up, its head goes back into the heap unless it ended
+    void read_ahead(uint32_t file)
+    {
+        m_pending[file] = m_readers[file]->next_mbo_batch(SIZE_MAX);
+        if (!m_pending[file].empty())
+        {
+            push(head_of(m_pending[file].front(), file));
+        }
+    }
+
+    std::vector<std::unique_ptr<DbnFileReader>> m_readers;
+    std::vector<std::span<const databento::MboMsg>> m_pending;  // per file: records read but not handed out yet
+    std::vector<Head> m_heap;                                   // one head per file with pending records
+    uint32_t m_drained = NO_FILE;
+    uint64_t m_end_ts_recv = UINT64_MAX;
+    uint64_t m_batch_offset = NO_OFFSET;
+    std::unique_ptr<databento::MboMsg[]> m_merged;              // merge buffer (more than one file)
+};
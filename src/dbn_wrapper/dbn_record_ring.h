@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <algorithm>
+
+#include <databento/dbn.hpp>
+
+#include <json/json.h>
+#include <queue/spsc_queue.h>
+
+// Fixed-size MBO record slots between the reader thread (single producer) and the apply thread (single consumer),
+// with the counters telling which side waits for the other:
+// - reader stalls: the ring was full, the apply side is the bottleneck
+// - apply stalls: the ring was empty while the reader was still running, reading / decompressing is the bottleneck
+// Each side only writes the counters on its own cache line, stats() can be read from any thread.
+class DbnRecordRing
+{
+public:
+    struct Stats
+    {
+        uint64_t records;           // pushed by the reader
+        uint64_t reader_stalls;
+        uint64_t apply_stalls;
+        uint64_t drains;            // non-empty pops by the apply side
+        double avg_occupancy;       // records queued, averaged over the drains
+        uint64_t max_occupancy;
+        uint64_t occupancy;         // records queued right now
+    };
+
+    static constexpr size_t RING_SIZE = 65536;  // MBO records buffered between the pipelined reader thread and the apply thread
+
+private:
+    SPSCQueue<databento::MboMsg, RING_SIZE> m_queue;
+
+    // Reader side
+    alignas(64) std::atomic<uint64_t> m_records = 0;
+    std::atomic<uint64_t> m_reader_stalls = 0;
+
+    // Apply side
+    alignas(64) std::atomic<uint64_t> m_apply_stalls = 0;
+    std::atomic<uint64_t> m_drains = 0;
+    std::atomic<uint64_t> m_occupancy_sum = 0;
+    std::atomic<uint64_t> m_max_occupancy = 0;
+
+public:
+    static constexpr size_t capacity() { return RING_SIZE; }
+
+    // Reader side: copies as many records as there is room for, counts a stall when that is not all of them
+    inline size_t push_batch(const databento::MboMsg* records, size_t count)
+    {
+        size_t pushed = m_queue.push_batch(records, count);
+        m_records.store(m_records.load(std::memory_order_relaxed) + pushed, std::memory_order_relaxed);
+        if (pushed < count)
+        {
+            m_reader_stalls.store(m_reader_stalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        return pushed;
+    }
+
+    // Apply side: copies up to `max_count` records into `out`. `reader_running`: an empty ring counts as a stall
+    inline size_t pop_batch(databento::MboMsg* out, size_t max_count, bool reader_running)
+    {
+        size_t occupancy = m_queue.size();
+        size_t count = m_queue.pop_batch(out, max_count);
+        if (count == 0)
+        {
+            if (reader_running)
+            {
+                m_apply_stalls.store(m_apply_stalls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+            return 0;
+        }
+
+        m_drains.store(m_drains.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        m_occupancy_sum.store(m_occupancy_sum.load(std::memory_order_relaxed) + occupancy, std::memory_order_relaxed);
+        if (occupancy > m_max_occupancy.load(std::memory_order_relaxed))
+        {
+            m_max_occupancy.store(occupancy, std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    // Apply side, while no reader runs: drops the queued records and zeroes the counters for a new replay
+    void reset()
+    {
+        databento::MboMsg drop[256];
+        while (m_queue.pop_batch(drop, std::size(drop)) > 0) {}
+
+        m_records.store(0, std::memory_order_relaxed);
+        m_reader_stalls.store(0, std::memory_order_relaxed);
+        m_apply_stalls.store(0, std::memory_order_relaxed);
+        m_drains.store(0, std::memory_order_relaxed);
+        m_occupancy_sum.store(0, std::memory_order_relaxed);
+        m_max_occupancy.store(0, std::memory_order_relaxed);
+    }
+
+    // Any thread, the counters are read one by one (not a consistent snapshot)
+    Stats stats() const
+    {
+        Stats stats;
+        stats.records = m_records.load(std::memory_order_relaxed);
+        stats.reader_stalls = m_reader_stalls.load(std::memory_order_relaxed);
+        stats.apply_stalls = m_apply_stalls.load(std::memory_order_relaxed);
+        stats.drains = m_drains.load(std::memory_order_relaxed);
+        stats.avg_occupancy = stats.drains ? (double)m_occupancy_sum.load(std::memory_order_relaxed) / stats.drains : 0;
+        stats.max_occupancy = m_max_occupancy.load(std::memory_order_relaxed);
+        stats.occupancy = m_queue.size();
+        return stats;
+    }
+
+    Json stats_json() const
+    {
+        Stats s = stats();
+        return {
+            {"records", s.records},
+            {"capacity", capacity()},
+            {"occupancy", s.occupancy},
+            {"avg_occupancy", s.avg_occupancy},
+            {"max_occupancy", s.max_occupancy},
+            {"reader_stalls", s.reader_stalls},
+            {"apply_stalls", s.apply_stalls},
+            {"drains", s.drains},
+            {"bottleneck", s.reader_stalls >= s.apply_stalls ? "apply" : "reader"}
+        };
+    }
+};
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include <sys/stat.h>
+#include <spdlog/spdlog.h>
+
+#include <databento/dbn.hpp>
+
+#include <dbn_wrapper/dbn_file_reader.h>
+
+// Sidecar seek index of a DBN file ("<file>.idx"): one entry every `interval` MBO records with the ts_recv, sequence,
+// record index and stream offset of that record, written by one scan of the file.
+// Each entry also holds the nearest preceding reset point: the earliest record from which a replay into empty books
+// rebuilds every book as of that entry. A book is rebuilt from its last Clear record, or from its first record when
+// it never had one (the file starts with empty books), books are keyed by (instrument_id, publisher_id) so the reset
+// point holds with and without venue books.
+class DbnSeekIndex
+{
+public:
+    struct Entry
+    {
+        uint64_t ts_recv;
+        uint32_t sequence;
+        uint32_t reserved;
+        uint64_t record_index;          // MBO records before this one
+        uint64_t offset;                // DbnFileReader::offset() of this record
+        uint64_t reset_record_index;    // nearest preceding reset point
+        uint64_t reset_offset;
+    };
+
+    static constexpr uint64_t FILE_MAGIC = 0x32584449424f4d4dULL;  // "MMOBIDX2"
+    static constexpr uint64_t DEFAULT_INTERVAL = 4096;
+
+    static std::string path_for(const std::string& dbn_path) { return dbn_path + ".idx"; }
+
+    // Scans `dbn_path` once and writes its index to `index_path` ("<path>.tmp" then renamed)
+    static bool build(const std::string& dbn_path, const std::string& index_path, uint64_t interval = DEFAULT_INTERVAL)
+    {
+        FileIdentity dbn_file = file_identity(dbn_path);    // before the scan: a file replaced meanwhile is stale
+        DbnFileReader reader(dbn_path);
+        std::vector<Entry> entries;
+        interval = std::max<uint64_t>(interval, 1);
+
+        struct ResetPoint
+        {
+            uint64_t record_index;
+            uint64_t offset;
+        };
+        std::unordered_map<uint64_t, ResetPoint> book_resets;     // (instrument_id << 16 | publisher_id) => last reset
+        ResetPoint reset{0, 0};
+        bool reset_stale = false;
+
+        uint64_t record_index = 0;
+        std::span<const databento::MboMsg> batch;
+        while (!(batch = reader.next_mbo_batch(SIZE_MAX)).empty())
+        {
+            uint64_t batch_offset = reader.offset() - batch.size_bytes();
+            for (size_t i = 0; i < batch.size(); ++i, ++record_index)
+            {
+                const databento::MboMsg& mbo = batch[i];
+                uint64_t offset = batch_offset + i * sizeof(databento::MboMsg);
+
+                uint64_t key = ((uint64_t)mbo.hd.instrument_id << 16) | mbo.hd.publisher_id;
+                auto [it, inserted] = book_resets.try_emplace(key, ResetPoint{record_index, offset});
+                if (inserted)
+                {
+                    if (book_resets.size() == 1) reset = it->second;
+                }
+                else if (mbo.action == databento::Action::Clear)
+                {
+                    it->second = ResetPoint{record_index, offset};
+                    reset_stale = true;
+                }
+
+                if (record_index % interval != 0) continue;
+
+                // Earliest reset over every book seen so far: a new book never moves it, a cleared one may
+                if (reset_stale)
+                {
+                    reset = ResetPoint{UINT64_MAX, 0};
+                    for (const auto& [book, point] : book_resets)
+                    {
+                        if (point.record_index < reset.record_index) reset = point;
+                    }
+                    reset_stale = false;
+                }
+
+                entries.push_back(Entry{(uint64_t)mbo.ts_recv.time_since_epoch().count(), mbo.sequence, 0,
+                    record_index, offset, reset.record_index, reset.offset});
+            }
+        }
+
+        FileHeader header{FILE_MAGIC, dbn_file, interval, record_index};
+
+        std::string tmp_path = index_path + ".tmp";
+        FILE* file = std::fopen(tmp_path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            spdlog::error("Cannot open seek index file: {}", tmp_path);
+            return false;
+        }
+
+        bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        ok = ok && std::fwrite(entries.data(), sizeof(Entry), entries.size(), file) == entries.size();
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok || std::rename(tmp_path.c_str(), index_path.c_str()) != 0)
+        {
+            spdlog::error("Cannot write seek index file: {}", index_path);
+            return false;
+        }
+        return true;
+    }
+
+    // False when the index is missing, truncated or was built for another version of `dbn_path` (its size,
+    // modification time or inode differs: rewritten in place or replaced)
+    bool load(const std::string& index_path, const std::string& dbn_path)
+    {
+        m_entries.clear();
+
+        FILE* file = std::fopen(index_path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        FileHeader header;
+        bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+            && header.magic == FILE_MAGIC
+            && header.dbn_file == file_identity(dbn_path);
+        if (ok)
+        {
+            std::fseek(file, 0, SEEK_END);
+            long size = std::ftell(file);
+            std::fseek(file, sizeof(header), SEEK_SET);
+
+            m_entries.resize((size - sizeof(header)) / sizeof(Entry));
+            ok = std::fread(m_entries.data(), sizeof(Entry), m_entries.size(), file) == m_entries.size()
+                && m_entries.size() == (header.record_count + header.interval - 1) / header.interval;
+        }
+        std::fclose(file);
+
+        if (!ok)
+        {
+            m_entries.clear();
+            return false;
+        }
+        m_record_count = header.record_count;
+        return true;
+    }
+
+    // Loads the index of `dbn_path`, (re)builds it first when missing or stale
+    bool load_or_build(const std::string& dbn_path)
+    {
+        std::string index_path = path_for(dbn_path);
+        if (load(index_path, dbn_path)) return true;
+
+        auto t0 = std::chrono::steady_clock::now();
+        if (!build(dbn_path, index_path) || !load(index_path, dbn_path)) return false;
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        spdlog::info("Built seek index {}: {} entries over {} records, in {:.2f} ms", index_path, m_entries.size(), m_record_count, ms);
+        return true;
+    }
+
+    inline const std::vector<Entry>& entries() const { return m_entries; }
+    inline uint64_t record_count() const { return m_record_count; }
+
+    // Last entry whose record has a ts_recv before `ts_recv`, nullptr when there is none (binary search, ts_recv is
+    // non-decreasing in a DBN file)
+    const Entry* find_before(uint64_t ts_recv) const
+    {
+        auto it = std::lower_bound(m_entries.begin(), m_entries.end(), ts_recv,
+            [](const Entry& entry, uint64_t ts) { return entry.ts_recv < ts; });
+        return it == m_entries.begin() ? nullptr : &*(it - 1);
+    }
+
+    // Last entry at or before the record at `record_index`, nullptr when there is none
+    const Entry* find_record(uint64_t record_index) const
+    {
+        auto it = std::upper_bound(m_entries.begin(), m_entries.end(), record_index,
+            [](uint64_t index, const Entry& entry) { return index < entry.record_index; });
+        return it == m_entries.begin() ? nullptr : &*(it - 1);
+    }
+
+private:
+    // The DBN file an index was built for
+    struct FileIdentity
+    {
+        uint64_t size;
+        uint64_t mtime_ns;
+        uint64_t inode;
+
+        bool operator==(const FileIdentity&) const = default;
+    };
+
+    struct FileHeader
+    {
+        uint64_t magic;
+        FileIdentity dbn_file;
+        uint64_t interval;
+        uint64_t record_count;
+    };
+
+    static FileIdentity file_identity(const std::string& path)
+    {
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0) return FileIdentity{0, 0, 0};
+        return FileIdentity{(uint64_t)st.st_size, (uint64_t)st.st_mtim.tv_sec * 1000000000ULL + (uint64_t)st.st_mtim.tv_nsec, (uint64_t)st.st_ino};
+    }
+
+    std::vector<Entry> m_entries;
+    uint64_t m_record_count = 0;
+};
@@ -2,76 +2,195 @@
 
 #include <functional>
 #include <chrono>
+#include <span>
+#include <vector>
 
 #include <databento/dbn.hpp>
-#include <databento/dbn_file_store.hpp>
 
+#include <dbn_wrapper/dbn_merge_reader.h>
+#include <dbn_wrapper/dbn_record_ring.h>
 #include <coroutine/task.h>
 #include <coroutine/future.h>
 #include <time/timer.h>
+#include <time/replay_clock.h>
 
 class DbnWrapper
 {
 public:
-    using Callback = std::function<void(const databento::MboMsg&, Json&)>;
+    using Callback = std::function<void(const databento::MboMsg&)>;
+    using BatchCallback = std::function<void(std::span<const databento::MboMsg>)>;
 
-    DbnWrapper(const std::string& file_path) : m_store(file_path), m_speed(1.0), m_is_streaming(false)
+    static constexpr size_t APPLY_BATCH = 256;  // MBO messages handed to a batch callback at once (at max speed)
+
+    DbnWrapper(const std::string& file_path) : DbnWrapper(std::vector<std::string>{file_path})
+    {}
+
+    // Several files are replayed as one stream, merged by (ts_recv, sequence)
+    DbnWrapper(const std::vector<std::string>& file_paths) : m_reader(file_paths), m_speed(1.0), m_is_streaming(false)
     {}
 
     // speed = 1.0  => real time
     // speed = 2.0  => 2x faster
     // speed = 0.5  => half speed
     // speed = 0    => max speed (no sleep)
+    // Pacing follows ts_recv through a ReplayClock: messages are released in groups at their scheduled wall time
     void set_speed(double speed)
     {
         m_speed = speed;
     }
 
+    // Messages are handed over one by one, in file order
     Task<void> start_stream_data(Callback cb)
     {
-        Json feed_snapshots;
+        return start_stream_data_batched([cb = std::move(cb)](std::span<const databento::MboMsg> records)
+        {
+            for (const databento::MboMsg& mbo : records) cb(mbo);
+        });
+    }
+
+    // Same replay, but messages are handed over in chunks of up to `batch_size` (in file order).
+    // A chunk is flushed before every pacing wait, so with speed > 0 no message waits for later ones. A replay behind
+    // schedule does not wait, its chunks fill up to batch_size while it catches up.
+    // event_boundaries: a chunk only ends on the last message of an event (F_LAST), it may grow past batch_size for that
+    // Chunks point straight into the reader's records, only an event cut by the end of a reader batch is copied.
+    Task<void> start_stream_data_batched(BatchCallback cb, size_t batch_size = APPLY_BATCH, bool event_boundaries = false)
+    {
+        m_is_streaming.store(true);
+        m_stop_future_value = nullptr;
+
+        auto sink = [cb = std::move(cb)](std::span<const databento::MboMsg> chunk)
+        {
+            cb(chunk);
+            return chunk.size();
+        };
+        return replay(std::move(sink), batch_size, event_boundaries, false, [this]() { finish_stream(); });
+    }
+
+    // Same chunks as start_stream_data_batched(), but decoding (and pacing) runs on `reader_event_base`: the reader
+    // copies the records into `ring`, this task drains it and calls `cb`, yielding to other tasks between chunks.
+    // The ring is reset first, it must not be shared with another running replay.
+    Task<void> start_stream_data_pipelined(BatchCallback cb, DbnRecordRing& ring, EventBase* reader_event_base, size_t batch_size = APPLY_BATCH, bool event_boundaries = false)
+    {
         m_is_streaming.store(true);
         m_stop_future_value = nullptr;
 
-        const databento::Record* rec;
-        std::optional<databento::UnixNanos> prev_ts;
+        ring.reset();
+        m_reader_done.store(false, std::memory_order_relaxed);
+        auto reader = read_into_ring(ring);
+        reader.start_running_on(reader_event_base);
+
+        // Popped records, the front `kept` of them are an event whose F_LAST message is still in the ring
+        std::vector<databento::MboMsg> batch(batch_size);
+        size_t kept = 0;
 
-        while (m_is_streaming.load() && (rec = m_store.NextRecord()))
+        while (true)
         {
-            const auto* mbo = rec->GetIf<databento::MboMsg>();
-            if (!mbo) continue;
+            bool reader_done = m_reader_done.load(std::memory_order_acquire);
+            if (!m_is_streaming.load())
+            {
+                // Stopped: the reader still uses the file and the ring until it notices
+                if (reader_done) break;
+                co_await yield();
+                continue;
+            }
 
-            if (mbo->ts_in_delta.count() > 0 && m_speed > 0.0)
+            if (batch.size() < kept + batch_size) batch.resize(kept + batch_size);
+            size_t count = ring.pop_batch(batch.data() + kept, batch_size, !reader_done);
+            if (count == 0)
             {
-                auto sleep_ns = static_cast<long long>(mbo->ts_in_delta.count() / m_speed);
-                co_await Timer::sleep_for(sleep_ns, Timer::TimerUnit::NANOSECOND);
+                if (reader_done) break;
+                co_await yield();
+                continue;
             }
 
-            // invoke user callback
-            cb(*mbo, feed_snapshots);
-        }
+            size_t total = kept + count;
+            size_t complete = total;
+            if (event_boundaries)
+            {
+                while (complete > kept && !batch[complete - 1].flags.IsLast()) --complete;
+                if (complete == kept) complete = 0;
+            }
 
-        m_is_streaming.store(false);
+            if (complete > 0)
+            {
+                cb(std::span<const databento::MboMsg>(batch.data(), complete));
+            }
+            std::copy(batch.begin() + complete, batch.begin() + total, batch.begin());
+            kept = total - complete;
 
-        if (m_end_callback)
-        {
-            m_end_callback();
+            // The rest of an open event is already in the ring, finish it before other tasks run
+            if (kept == 0) co_await yield();
         }
 
-        if (m_stop_future_value && m_stop_future_value->is_value_set() == false)
+        if (kept > 0 && m_is_streaming.load())
         {
-            m_stop_future_value->set_value(true);
+            cb(std::span<const databento::MboMsg>(batch.data(), kept));
         }
 
-        spdlog::warn("Finished streaming DBN file");
+        DbnRecordRing::Stats stats = ring.stats();
+        spdlog::info("Pipelined replay: {} records, {} reader stalls (ring full), {} apply stalls (ring empty), avg occupancy {:.0f} / {}",
+            stats.records, stats.reader_stalls, stats.apply_stalls, stats.avg_occupancy, DbnRecordRing::capacity());
 
-        // spdlog::info("size of feed_snapshots: {}", feed_snapshots["snapshots"].size());
-        // spdlog::info("size of feed_snapshots 0: {}", feed_snapshots["snapshots"][0]);
-        // feed_snapshots.write_to_file("mbp_msg10.json");
+        finish_stream();
 
         co_return;
     }
 
+    // Single file: continue reading at `offset` (see DbnSeekIndex), before the replay starts
+    bool seek(uint64_t offset)
+    {
+        m_last_offset = NO_OFFSET;
+        return m_reader.seek(offset);
+    }
+
+    // Single file: offset of the last MBO record handed over (by a replay, fast_forward() or skip_records()), a
+    // checkpoint resumes there with seek(). NO_OFFSET with several files or when unknown. A pipelined replay
+    // updates it on the reader thread as records enter the ring, not as they are applied
+    static constexpr uint64_t NO_OFFSET = DbnMergeReader::NO_OFFSET;
+    inline uint64_t last_record_offset() const { return m_last_offset; }
+
+    // Hands the records before the first one at or after `ts_recv` to `cb` at once, without pacing, before the
+    // replay starts (which then begins at that record). At most `max_count` per call: the caller calls again (e.g.
+    // after yielding) while it gets `max_count`. Returns the number of records handed over
+    uint64_t fast_forward(uint64_t ts_recv, const BatchCallback& cb, uint64_t max_count = UINT64_MAX)
+    {
+        m_reader.set_end_ts_recv(ts_recv);
+
+        uint64_t count = 0;
+        std::span<const databento::MboMsg> records;
+        while (count < max_count && !(records = m_reader.next_mbo_batch(max_count - count)).empty())
+        {
+            cb(records);
+            count += records.size();
+            m_last_offset = offset_of_last(records.size());
+        }
+
+        m_reader.set_end_ts_recv(UINT64_MAX);
+        return count;
+    }
+
+    // Resume after a checkpoint: drops the first `count` MBO records.
+    // True when the last of them has the ts_recv / sequence the checkpoint was taken at.
+    bool skip_records(uint64_t count, uint64_t last_ts_recv, uint32_t last_sequence)
+    {
+        if (count == 0) return true;
+
+        databento::MboMsg last{};
+        uint64_t skipped = 0;
+        std::span<const databento::MboMsg> records;
+
+        while (skipped < count && !(records = m_reader.next_mbo_batch(count - skipped)).empty())
+        {
+            last = records.back();
+            skipped += records.size();
+            m_last_offset = offset_of_last(records.size());
+        }
+
+        return skipped == count
+            && (uint64_t)last.ts_recv.time_since_epoch().count() == last_ts_recv
+            && last.sequence == last_sequence;
+    }
+
     void set_end_callback(std::function<void()> cb)
     {
         m_end_callback = std::move(cb);
@@ -92,9 +211,151 @@ public:
     }
 
 private:
-    databento::DbnFileStore m_store;
+    using BatchSink = std::function<size_t(std::span<const databento::MboMsg>)>;
+
+    // Pipelined replay, on the reader EventBase: paces and pushes the records, waits while the ring is full
+    Task<void> read_into_ring(DbnRecordRing& ring)
+    {
+        auto sink = [&ring](std::span<const databento::MboMsg> chunk)
+        {
+            return ring.push_batch(chunk.data(), chunk.size());
+        };
+        return replay(std::move(sink), SIZE_MAX, false, true, [this]() { m_reader_done.store(true, std::memory_order_release); });
+    }
+
+    // The replay loop of every mode: reads the records, paces them and hands them to `sink` in chunks (see
+    // start_stream_data_batched()). `sink` returns how many records it took, the rest is handed again after a yield.
+    // spin: the end of a pacing wait is spun on the TSC, only for a thread of its own (the pipelined reader). On a shared
+    // EventBase it yields between clock checks instead, so the tasks queued there keep running.
+    // Stops when the stream is stopped or every file is read, then calls `on_end`
+    Task<void> replay(BatchSink sink, size_t batch_size, bool event_boundaries, bool spin, std::function<void()> on_end)
+    {
+        m_clock.start(m_speed);
+
+        std::span<const databento::MboMsg> records;     // reader batch, handed over up to `begin`
+        size_t begin = 0;
+        size_t i = 0;
+        std::vector<databento::MboMsg> carried;         // start of an event continued in the next reader batch
+        uint64_t carried_offset = NO_OFFSET;            // offset of its last record
+        bool group_waits = false;                       // records[i] opens a group that is not due yet (passed to the clock)
+
+        while (m_is_streaming.load())
+        {
+            if (begin == records.size())
+            {
+                records = m_reader.next_mbo_batch(SIZE_MAX);
+                begin = i = 0;
+                if (records.empty() && carried.empty()) break;
+            }
+
+            // Next chunk: `carried` then records[begin, i)
+            for (; i < records.size() && m_is_streaming.load(); ++i)
+            {
+                const databento::MboMsg& mbo = records[i];
+
+                if (m_speed > 0.0 && !group_waits) group_waits = m_clock.starts_group(ts_recv_ns(mbo)) && m_clock.early();
+                if (group_waits)
+                {
+                    // What is due already is handed over first (the wait starts on the next pass)
+                    const databento::MboMsg* last = i > begin ? &records[i - 1] : (carried.empty() ? nullptr : &carried.back());
+                    if (last && (!event_boundaries || last->flags.IsLast())) break;
+
+                    if (int64_t sleep_ns = m_clock.sleep_ns()) co_await Timer::sleep_for(sleep_ns, Timer::TimerUnit::NANOSECOND);
+                    if (!spin)
+                    {
+                        while (m_clock.early()) co_await yield();
+                    }
+                    m_clock.spin_until_due();   // records the release lag, no spin left when yielding
+                    group_waits = false;
+                }
+
+                if (carried.size() + i + 1 - begin >= batch_size && (!event_boundaries || mbo.flags.IsLast()))
+                {
+                    ++i;
+                    break;
+                }
+            }
+
+            std::span<const databento::MboMsg> chunk = records.subspan(begin, i - begin);
+            uint64_t chunk_offset = chunk.empty() ? carried_offset : offset_of_last(i);
+            begin = i;
+
+            // An event continued in the next reader batch, whose records replace the current ones: keep a copy
+            if (event_boundaries && i == records.size() && !chunk.empty() && !chunk.back().flags.IsLast())
+            {
+                carried.insert(carried.end(), chunk.begin(), chunk.end());
+                carried_offset = chunk_offset;
+                continue;
+            }
+            if (!carried.empty())
+            {
+                carried.insert(carried.end(), chunk.begin(), chunk.end());
+                chunk = carried;
+            }
+
+            for (size_t taken = 0; taken < chunk.size() && m_is_streaming.load(); )
+            {
+                taken += sink(chunk.subspan(taken));
+                if (taken < chunk.size()) co_await yield();
+                else m_last_offset = chunk_offset;
+            }
+            carried.clear();
+        }
+
+        on_end();
+        co_return;
+    }
+
+    // Suspend and go back to the end of the EventBase ready queue, so queued tasks can run
+    static Future<bool> yield()
+    {
+        return Future<bool>([](Future<bool>::FutureValue* future_value)
+        {
+            future_value->set_value(true);
+        });
+    }
+
+    static inline uint64_t ts_recv_ns(const databento::MboMsg& mbo)
+    {
+        return (uint64_t)mbo.ts_recv.time_since_epoch().count();
+    }
+
+    // Offset of the `end - 1`th record of the last reader batch
+    inline uint64_t offset_of_last(size_t end) const
+    {
+        uint64_t batch_offset = m_reader.batch_offset();
+        return batch_offset == NO_OFFSET ? NO_OFFSET : batch_offset + (end - 1) * sizeof(databento::MboMsg);
+    }
+
+    void finish_stream()
+    {
+        m_is_streaming.store(false);
+
+        if (m_clock.waited_groups() > 0)
+        {
+            spdlog::info("Replay clock: {} paced groups released {:.0f} ns late on average, {} ns at most",
+                m_clock.waited_groups(), m_clock.avg_lag_ns(), m_clock.max_lag_ns());
+        }
+
+        if (m_end_callback)
+        {
+            m_end_callback();
+        }
+
+        if (m_stop_future_value && m_stop_future_value->is_value_set() == false)
+        {
+            m_stop_future_value->set_value(true);
+        }
+
+        spdlog::warn("Finished streaming DBN file");
+    }
+
+    DbnMergeReader m_reader;
     double m_speed;
+    ReplayClock m_clock;    // touched by the task that paces: the replay task, or the reader task when pipelined
     std::atomic<bool> m_is_streaming = false;
+    std::atomic<bool> m_reader_done = true;     // pipelined replay: the reader task has exited
     std::function<void()> m_end_callback = nullptr;
     Future<bool>::FutureValue* m_stop_future_value = nullptr;
+    uint64_t m_last_offset = NO_OFFSET;
 };
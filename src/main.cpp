@@ -2,6 +2,9 @@
 #include <string>
 #include <thread>
 #include <chrono>
+#include <charconv>
+#include <optional>
+#include <ctime>
 
 #include <spdlog/spdlog.h>
 #include <utils/log_init.h>
@@ -9,9 +12,72 @@
 #include <network/https_server/route/route_controller.h>
 #include <system_io/https_server_io/https_server_socket.h>
 #include <dbn_wrapper/dbn_wrapper.h>
+#include <time/replay_clock.h>
 #include <coroutine/event_base_manager.h>
 #include <orderbook/orderbook_controller.h>
 
+// Unsigned integer query param, returns false when it is present but not a valid number
+template <typename T>
+static bool parse_query_param(HttpRequest* request, const std::string& name, std::optional<T>& out)
+{
+    const std::string& param = request->get_query_param(name);
+    if (param == PARAM_NOT_FOUND)
+    {
+        return true;
+    }
+
+    T value = 0;
+    auto [ptr, ec] = std::from_chars(param.data(), param.data() + param.size(), value);
+    if (ec != std::errc() || ptr != param.data() + param.size())
+    {
+        return false;
+    }
+
+    out = value;
+    return true;
+}
+
+// Timestamp as nanoseconds since the epoch, or UTC "YYYY-MM-DDTHH:MM:SS[.fraction][Z]"
+static bool parse_timestamp(const std::string& text, uint64_t& out)
+{
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, out);
+    if (ec == std::errc() && ptr == end)
+    {
+        return true;
+    }
+
+    std::tm tm{};
+    int consumed = 0;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2dT%2d:%2d:%2d%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &consumed) != 6)
+    {
+        return false;
+    }
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+
+    uint64_t nanos = 0;
+    ptr = text.data() + consumed;
+    if (ptr < end && *ptr == '.')
+    {
+        uint64_t scale = 100000000;
+        for (++ptr; ptr < end && *ptr >= '0' && *ptr <= '9'; ++ptr, scale /= 10)
+        {
+            nanos += (*ptr - '0') * scale;
+        }
+    }
+    if (ptr < end && *ptr == 'Z') ++ptr;
+
+    time_t seconds = timegm(&tm);
+    if (ptr != end || seconds < 0)
+    {
+        return false;
+    }
+
+    out = (uint64_t)seconds * 1000000000ULL + nanos;
+    return true;
+}
+
 void init_api_endpoints()
 {
     ADD_ROUTE(RequestMethod::GET, "/")
@@ -21,7 +87,39 @@ void init_api_endpoints()
 
     ADD_ROUTE(RequestMethod::GET, "/get_snapshot")
     {
-        Json snapshot = co_await OrderBookController::instance().get_orderbook_snapshot();
+        // Optional query params:
+        // - instrument_id (default: first instrument seen in the feed)
+        // - levels per side (default: the top-N depth cache size)
+        // - bucket: aggregate the ladder in buckets of that many ticks, `levels` then counts buckets
+        // - publisher_id: with venue books, the book of one venue (default: the consolidated view)
+        std::optional<uint32_t> instrument_id;
+        if (!parse_query_param(request, "instrument_id", instrument_id))
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid query param: [instrument_id]");
+        }
+
+        std::optional<size_t> levels;
+        if (!parse_query_param(request, "levels", levels))
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid query param: [levels]");
+        }
+
+        std::optional<uint32_t> bucket;
+        if (!parse_query_param(request, "bucket", bucket) || bucket == 0u)
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid query param: [bucket]");
+        }
+
+        std::optional<uint16_t> publisher_id;
+        if (!parse_query_param(request, "publisher_id", publisher_id))
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid query param: [publisher_id]");
+        }
+
+        std::optional<int64_t> bucket_ticks;
+        if (bucket) bucket_ticks = *bucket;
+
+        Json snapshot = co_await OrderBookController::instance().get_orderbook_snapshot(instrument_id, levels.value_or(OrderBook::DEFAULT_DEPTH_CACHE_LEVELS), bucket_ticks, publisher_id);
 
         Json response;
         response["status"] = "OK";
@@ -29,17 +127,137 @@ void init_api_endpoints()
         co_return HttpResponse(OK_200, response);
     };
 
+    ADD_ROUTE(RequestMethod::GET, "/get_queue_position")
+    {
+        // Required query param: order_id, optional: instrument_id (default: first instrument seen in the feed),
+        // publisher_id (the venue of the order, with venue books)
+        std::optional<uint64_t> order_id;
+        if (!parse_query_param(request, "order_id", order_id) || !order_id)
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid or missing query param: [order_id]");
+        }
+
+        std::optional<uint32_t> instrument_id;
+        if (!parse_query_param(request, "instrument_id", instrument_id))
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid query param: [instrument_id]");
+        }
+
+        std::optional<uint16_t> publisher_id;
+        if (!parse_query_param(request, "publisher_id", publisher_id))
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid query param: [publisher_id]");
+        }
+
+        Json position = co_await OrderBookController::instance().get_queue_position(instrument_id, *order_id, publisher_id);
+
+        Json response;
+        response["status"] = "OK";
+        response["queue_position"] = position;
+        co_return HttpResponse(OK_200, response);
+    };
+
+    ADD_ROUTE(RequestMethod::GET, "/get_instruments")
+    {
+        Json instruments = co_await OrderBookController::instance().get_instruments();
+
+        Json response;
+        response["status"] = "OK";
+        response["instruments"] = instruments;
+        co_return HttpResponse(OK_200, response);
+    };
+
     ADD_ROUTE(RequestMethod::POST, "/start_streaming_orderbook")
     {
         // Get speed from request body
         Json body_json = request->get_body_json();
         double speed = body_json.has_field("speed") ? (double)(body_json["speed"]) : 1.0;
 
+        OrderBookController::StreamingOptions options;
+        options.num_shards = body_json.has_field("shards") ? (size_t)(body_json["shards"]) : 0;
+        options.mbp10_output_path = body_json.has_field("mbp10_output") ? (std::string)(body_json["mbp10_output"]) : "";
+        options.event_batching = body_json.has_field("event_batching") ? (bool)(body_json["event_batching"]) : false;
+        options.checkpoint_path = body_json.has_field("checkpoint") ? (std::string)(body_json["checkpoint"]) : "";
+        options.queue_positions = body_json.has_field("queue_positions") ? (bool)(body_json["queue_positions"]) : false;
+        options.venue_books = body_json.has_field("venue_books") ? (bool)(body_json["venue_books"]) : false;
+        options.signal_levels = body_json.has_field("signal_levels") ? (size_t)(body_json["signal_levels"]) : 0;
+        options.pipelined_reader = body_json.has_field("pipelined_reader") ? (bool)(body_json["pipelined_reader"]) : false;
+        options.product = body_json.has_field("product") ? (std::string)(body_json["product"]) : "";
+        if (!options.product.empty() && !is_known_product(options.product))
+        {
+            co_return HttpRequest::response_bad_request_400("Unknown body param: [product] = " + options.product);
+        }
+        if (body_json.has_field("start_ts"))
+        {
+            // ns since the epoch (number or string), or a UTC ISO-8601 string
+            Json& start_ts = body_json["start_ts"];
+            bool valid = false;
+            if (start_ts.is_string())
+            {
+                valid = parse_timestamp((std::string)start_ts, options.start_ts_recv);
+            }
+            else
+            {
+                int64_t start_ts_ns = (int64_t)start_ts;
+                valid = start_ts_ns > 0;
+                options.start_ts_recv = (uint64_t)start_ts_ns;
+            }
+
+            if (!valid)
+            {
+                co_return HttpRequest::response_bad_request_400("Invalid body param: [start_ts]");
+            }
+        }
+        if (body_json.has_field("buckets") && body_json["buckets"].is_array())
+        {
+            body_json["buckets"].for_each([&](Json& ticks)
+            {
+                options.bucket_resolutions.push_back((int64_t)ticks);
+            });
+        }
+
+        // DBN files to replay, merged by ts_recv (the sample file by default)
+        std::vector<std::string> files;
+        if (body_json.has_field("files") && body_json["files"].is_array())
+        {
+            body_json["files"].for_each([&](Json& path)
+            {
+                files.push_back((std::string)path);
+            });
+        }
+        if (files.empty())
+        {
+            files.push_back("z_orderbook_data/CLX5_mbo.dbn");
+        }
+
+        if (options.start_ts_recv != 0 && (options.num_shards != 0 || files.size() != 1))
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid body param: [start_ts] needs a single file and no shards");
+        }
+
+        // A file that cannot be replayed is reported now, before the running replay is torn down
+        std::string file_error;
+        for (const std::string& path : files)
+        {
+            try
+            {
+                DbnFileReader reader(path);
+            }
+            catch (const std::runtime_error& e)
+            {
+                file_error = e.what();
+                break;
+            }
+        }
+        if (!file_error.empty())
+        {
+            co_return HttpRequest::response_bad_request_400("Invalid body param: [files]: " + file_error);
+        }
+
         // Stop first if it's already streaming
         co_await OrderBookController::instance().stop_streaming();
 
-        // Init with DBN file path (hardcode for now)
-        OrderBookController::instance().initialize("z_orderbook_data/CLX5_mbo.dbn");
+        co_await OrderBookController::instance().initialize(files, options);
 
         // Start streaming orderbook data
         auto task = OrderBookController::instance().start_streaming(speed);
@@ -52,6 +270,19 @@ void init_api_endpoints()
         co_return HttpResponse(OK_200, response);
     };
 
+    ADD_ROUTE(RequestMethod::POST, "/save_checkpoint")
+    {
+        Json body_json = request->get_body_json();
+        if (!body_json.has_field("path"))
+        {
+            co_return HttpRequest::response_bad_request_400("Missing body param: [path]");
+        }
+
+        Json result = co_await OrderBookController::instance().save_checkpoint((std::string)(body_json["path"]));
+
+        co_return HttpResponse(OK_200, result);
+    };
+
     ADD_ROUTE(RequestMethod::GET, "/stop_streaming_orderbook")
     {
         co_await OrderBookController::instance().stop_streaming();
@@ -72,6 +303,9 @@ int main(int argc, char **argv)
     // Init spdlog
     LogInit::init();
 
+    // Calibrate the replay clock's TSC spin now, not on the first replay (busy-waits for a few ms)
+    ReplayClock::ticks_per_ns();
+
     // Init API endpoints
     init_api_endpoints();
 
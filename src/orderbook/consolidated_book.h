@@ -0,0 +1,181 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+#include <hash_map/flat_hash_map.h>
+#include <orderbook/orderbook.h>
+
+// Consolidated ladder of one instrument across venues (publisher_id), one OrderBook per venue.
+// The venue books report every level change (OrderBook::set_level_callback) and the consolidated totals of the price
+// are updated right away (one hash update, no ordered structure to maintain on the write path).
+// Reads go from best to worst through the occupancy bitmaps of the venue books (next occupied tick = best of the
+// venues' next levels, O(venues) per level) and take the totals of each tick from the hash. The per-venue breakdown
+// of a level is read from the venue books (one level lookup per venue).
+class ConsolidatedBook
+{
+public:
+    struct Entry
+    {
+        int64_t  price;
+        uint64_t size;      // summed across venues
+        uint64_t count;     // orders, summed across venues
+    };
+
+    struct Venue
+    {
+        uint16_t publisher_id;
+        const OrderBookBase* book;
+    };
+
+private:
+    struct Totals
+    {
+        int64_t size = 0;
+        int64_t count = 0;
+    };
+
+    FlatHashMap<int64_t, Totals> m_bids;    // tick → totals, non-empty levels only
+    FlatHashMap<int64_t, Totals> m_asks;
+    std::vector<Venue> m_venues;    // in order of first sight
+
+public:
+    ConsolidatedBook() = default;
+
+    ConsolidatedBook(const ConsolidatedBook&) = delete;
+    ConsolidatedBook& operator=(const ConsolidatedBook&) = delete;
+
+    // The book of a new venue, its resting levels are added. Venue books share the tick size and outlive this view
+    void add_venue(uint16_t publisher_id, OrderBookBase& book)
+    {
+        m_venues.push_back(Venue{publisher_id, &book});
+        book.set_level_callback([this](bool is_bid, int64_t tick, int64_t size, int64_t count)
+        {
+            level_changed(is_bid, tick, size, count);
+        });
+    }
+
+    inline const std::vector<Venue>& venues() const { return m_venues; }
+
+    // A venue level of `tick` changed by `size` / `count` orders
+    inline void level_changed(bool is_bid, int64_t tick, int64_t size, int64_t count)
+    {
+        FlatHashMap<int64_t, Totals>& side = is_bid ? m_bids : m_asks;
+
+        Totals* totals = side.find(tick);
+        if (totals == nullptr)
+        {
+            side.insert_or_assign(tick, Totals{size, count});
+            return;
+        }
+
+        totals->size += size;
+        totals->count += count;
+        if (totals->count == 0)
+        {
+            side.erase(tick);
+        }
+    }
+
+    // Best `max_levels` consolidated levels of a side (best → worst)
+    void get_levels(bool is_bid, size_t max_levels, std::vector<Entry>& out) const
+    {
+        out.clear();
+        for_each_tick(is_bid, max_levels, [&](int64_t tick, const Totals& totals)
+        {
+            out.push_back(Entry{tick_to_price(tick), (uint64_t)totals.size, (uint64_t)totals.count});
+        });
+    }
+
+    // build_snapshot() layout of the consolidated ladder, every level with its order count and per-venue breakdown
+    Json build_snapshot(size_t max_levels) const
+    {
+        Json snap;
+
+        for (bool is_bid : {true, false})
+        {
+            Json side;
+            for_each_tick(is_bid, max_levels, [&](int64_t tick, const Totals& totals)
+            {
+                Json venues;
+                for (const Venue& venue : m_venues)
+                {
+                    const OrderBookBase::Level* level = venue.book->find_level(is_bid, tick);
+                    if (level == nullptr) continue;
+
+                    venues.push_back({
+                        {"publisher_id", venue.publisher_id},
+                        {"size" , level->total_size},
+                        {"count", level->queue.size()}
+                    });
+                }
+
+                side.push_back({
+                    {"price", tick_to_price(tick)},
+                    {"size" , totals.size},
+                    {"count", totals.count},
+                    {"venues", venues}
+                });
+            });
+            snap[is_bid ? "bids" : "asks"] = side;
+        }
+
+        Json publisher_ids;
+        for (const Venue& venue : m_venues)
+        {
+            publisher_ids.push_back(venue.publisher_id);
+        }
+        snap["publisher_ids"] = publisher_ids;
+        return snap;
+    }
+
+private:
+    inline int64_t tick_to_price(int64_t tick) const
+    {
+        return m_venues.front().book->tick_to_price(tick);
+    }
+
+    // fn(tick, totals) from best to worst, at most `max_levels`
+    template <typename F>
+    inline void for_each_tick(bool is_bid, size_t max_levels, F&& fn) const
+    {
+        const FlatHashMap<int64_t, Totals>& side = is_bid ? m_bids : m_asks;
+        if (side.empty()) return;
+
+        int64_t tick = 0;
+        bool found = best_tick(is_bid, tick, [is_bid](const OrderBookBase& book, int64_t& out_tick)
+        {
+            return book.best_level(is_bid, out_tick) != nullptr;
+        });
+
+        for (size_t count = 0; found && count < max_levels; ++count)
+        {
+            fn(tick, *side.find(tick));
+
+            int64_t from = tick;
+            found = best_tick(is_bid, tick, [is_bid, from](const OrderBookBase& book, int64_t& out_tick)
+            {
+                return book.next_worse_level(is_bid, from, out_tick) != nullptr;
+            });
+        }
+    }
+
+    // Best of the ticks `level_of(book, tick)` finds in the venue books, false when none
+    template <typename F>
+    inline bool best_tick(bool is_bid, int64_t& best, F&& level_of) const
+    {
+        bool found = false;
+        for (const Venue& venue : m_venues)
+        {
+            int64_t tick = 0;
+            if (!level_of(*venue.book, tick)) continue;
+
+            if (!found || (is_bid ? tick > best : tick < best))
+            {
+                best = tick;
+                found = true;
+            }
+        }
+        return found;
+    }
+};
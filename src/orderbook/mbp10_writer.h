@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <databento/dbn.hpp>
+#include <spdlog/spdlog.h>
+
+// Appends binary MBP-10 records (DBN record layout, no metadata header) to a file.
+// Records are buffered in memory and written by flush(), which the owning registry calls once per applied batch.
+// Single threaded: used by the thread that applies the books.
+class Mbp10Writer
+{
+    FILE* m_file = nullptr;
+    std::vector<databento::Mbp10Msg> m_buffer;
+    size_t m_record_count = 0;
+
+public:
+    explicit Mbp10Writer(const std::string& path)
+    {
+        m_file = std::fopen(path.c_str(), "wb");
+        if (m_file == nullptr)
+        {
+            spdlog::error("Cannot open MBP-10 output file: {}", path);
+        }
+        m_buffer.reserve(4096);
+    }
+
+    ~Mbp10Writer()
+    {
+        flush();
+        if (m_file) std::fclose(m_file);
+    }
+
+    Mbp10Writer(const Mbp10Writer&) = delete;
+    Mbp10Writer& operator=(const Mbp10Writer&) = delete;
+
+    inline void write(const databento::Mbp10Msg& msg)
+    {
+        m_buffer.push_back(msg);
+    }
+
+    void flush()
+    {
+        if (m_buffer.empty()) return;
+
+        if (m_file)
+        {
+            std::fwrite(m_buffer.data(), sizeof(databento::Mbp10Msg), m_buffer.size(), m_file);
+            std::fflush(m_file);
+        }
+        m_record_count += m_buffer.size();
+        m_buffer.clear();
+    }
+
+    inline bool is_open() const { return m_file != nullptr; }
+    inline size_t record_count() const { return m_record_count; }
+};
@@ -1,40 +1,184 @@
 #pragma once
 
 #include <vector>
-#include <list>
-#include <unordered_map>
+#include <map>
+#include <algorithm>
 #include <cstdint>
 #include <optional>
+#include <memory>
+#include <span>
+#include <array>
+#include <cstring>
+#include <functional>
 
 #include <databento/dbn.hpp>
+#include <databento/constants.hpp>
 #include <databento/dbn_file_store.hpp>
 
 #include <json/json.h>
+#include <cache/slab_pool.h>
+#include <hash_map/flat_hash_map.h>
+#include <bitmap/hierarchical_bitmap.h>
+#include <fenwick/fenwick_tree.h>
+#include <utils/seqlock.h>
 #include <coroutine/event_base_manager.h>
 #include <coroutine/task.h>
 #include <coroutine/future.h>
 
-class OrderBook
+// Runtime-configured book: tick size and ladder bounds are constructor arguments
+struct RuntimeBookConfig
+{
+    static constexpr bool IS_STATIC = false;
+    static constexpr bool TRADES_MUTATE = true;
+};
+
+// Compile-time configured book for a known product.
+// The tick size is a constant so price → tick is a multiply/shift instead of a 64-bit division,
+// the dense window is fixed on [PriceMin, PriceMax] (prices outside go to the overflow levels) and never re-centers.
+// TradesMutate = false ignores T/F/N, for feeds where the resting order is also reduced by its own C/M message.
+template <int64_t TickSize, int64_t PriceMin, int64_t PriceMax, bool TradesMutate = true>
+struct StaticBookConfig
+{
+    static_assert(TickSize > 0, "tick size must be positive");
+    static_assert(PriceMin <= PriceMax, "empty price range");
+    static_assert(PriceMin % TickSize == 0, "price_min must be a multiple of the tick size");
+
+    static constexpr bool IS_STATIC = true;
+    static constexpr bool TRADES_MUTATE = TradesMutate;
+
+    static constexpr int64_t TICK_SIZE = TickSize;
+    static constexpr int64_t BASE_TICK = PriceMin / TickSize;
+    static constexpr size_t NUM_LEVELS = (PriceMax - PriceMin) / TickSize + 1;
+};
+
+// Book interface shared by every BasicOrderBook<Config>: the nested types (so books of different configs hand out
+// the same Level, Bbo, Signals, ...) and the calls the registry, the consolidated view and the controller make.
+// The registry holds books through it, so runtime and compile-time configured books (orderbook_products.h) live
+// side by side. Books are final: inside a book every call is direct, only calls through this interface are virtual
+// (once per batch run, per snapshot or per read).
+class OrderBookBase
 {
 public:
+    // Order node, linked intrusively into the FIFO queue of its level
     struct Order
     {
         uint64_t order_id;
+        int64_t  price;
+        int64_t  tick;      // absolute price tick (price / tick size), locates the level
         uint32_t size;
+        bool     is_bid;
+        uint32_t slot = 0;  // FIFO slot in the queue-position index of its level (only with queue positions on)
+
+        Order* prev = nullptr;
+        Order* next = nullptr;
+    };
+
+    // Intrusive doubly linked FIFO over pooled order nodes (no allocation per order)
+    class OrderQueue
+    {
+        Order* m_head = nullptr;
+        Order* m_tail = nullptr;
+        size_t m_size = 0;
+
+    public:
+        struct Iterator
+        {
+            Order* node;
+
+            inline Order& operator*() const { return *node; }
+            inline Order* operator->() const { return node; }
+            inline Iterator& operator++() { node = node->next; return *this; }
+            inline bool operator==(const Iterator& other) const { return node == other.node; }
+            inline bool operator!=(const Iterator& other) const { return node != other.node; }
+        };
+
+        inline bool empty() const { return m_head == nullptr; }
+        inline size_t size() const { return m_size; }
+        inline Order& front() const { return *m_head; }
+        inline Order& back() const { return *m_tail; }
+
+        inline Iterator begin() const { return Iterator{m_head}; }
+        inline Iterator end() const { return Iterator{nullptr}; }
+
+        inline void push_back(Order* order)
+        {
+            order->prev = m_tail;
+            order->next = nullptr;
+
+            if (m_tail) m_tail->next = order;
+            else        m_head = order;
+
+            m_tail = order;
+            m_size++;
+        }
+
+        inline void erase(Order* order)
+        {
+            if (order->prev) order->prev->next = order->next;
+            else             m_head = order->next;
+
+            if (order->next) order->next->prev = order->prev;
+            else             m_tail = order->prev;
+
+            m_size--;
+        }
+
+        // Move an order to the back of the queue (loses priority)
+        inline void move_to_back(Order* order)
+        {
+            if (order == m_tail) return;
+
+            erase(order);
+            push_back(order);
+        }
+    };
+
+    // Size and order count summed over FIFO slots
+    struct QueueAmount
+    {
+        int64_t size = 0;
+        int64_t count = 0;
+
+        inline QueueAmount& operator+=(const QueueAmount& other) { size += other.size; count += other.count; return *this; }
+        inline QueueAmount& operator-=(const QueueAmount& other) { size -= other.size; count -= other.count; return *this; }
+    };
+
+    // Queue-position index of a level: an order takes the next free slot when it joins the back of the queue,
+    // so the orders ahead of it are exactly the lower slots. Slots of removed orders are zeroed and left behind,
+    // once the slots run out the live orders are renumbered in FIFO order (and the tree grows if half of them are live).
+    struct QueueIndex
+    {
+        FenwickTree<QueueAmount> tree;
+        uint32_t next_slot = 0;
     };
 
     struct Level
     {
-        std::list<Order> queue;     // FIFO queue
+        OrderQueue queue;           // FIFO queue
         uint64_t total_size = 0;
+        std::unique_ptr<QueueIndex> queue_index;    // only with queue positions on
 
         inline bool empty() const { return queue.empty(); }
     };
 
-    struct LevelByPrice
+    // Where an order stands in its level's FIFO queue
+    struct QueuePosition
     {
-        int64_t price;
-        Level* level;
+        int64_t  price;
+        bool     is_bid;
+        uint32_t size;
+        uint64_t size_ahead;    // total size of the orders in front of it
+        uint64_t count_ahead;   // number of orders in front of it
+        uint64_t level_size;
+        uint64_t level_count;
+    };
+
+    // Levels aggregated over [price, price + bucket ticks * tick size)
+    struct BucketEntry
+    {
+        int64_t  price;     // lowest price of the bucket
+        uint64_t size;
+        uint64_t count;     // resting orders
     };
 
     struct DepthEntry
@@ -49,62 +193,398 @@ public:
         std::vector<DepthEntry> asks;   // sorted asc (best → worst)
     };
 
+    static constexpr size_t DEFAULT_DEPTH_CACHE_LEVELS = 50;
+    static constexpr size_t PUBLISHED_DEPTH_LEVELS = DEFAULT_DEPTH_CACHE_LEVELS;
+
+    // Top levels copied out by publish(), readable from any thread through read_published()
+    struct PublishedDepth
+    {
+        uint64_t last_ts_recv;      // ts_recv of the last message applied before publishing
+        uint32_t bid_count;
+        uint32_t ask_count;
+        DepthEntry bids[PUBLISHED_DEPTH_LEVELS];    // best → worst
+        DepthEntry asks[PUBLISHED_DEPTH_LEVELS];    // best → worst
+    };
+
+    // Best bid / ask published after every message that changes them, readable from any thread through read_bbo().
+    // An empty side has size 0 (and price 0)
+    struct Bbo
+    {
+        int64_t bid_price;
+        uint64_t bid_size;
+        int64_t ask_price;
+        uint64_t ask_size;
+        uint64_t ts_recv;           // ts_recv of the message that produced this top of book
+
+        inline bool same_top(const Bbo& other) const
+        {
+            return bid_price == other.bid_price && bid_size == other.bid_size
+                && ask_price == other.ask_price && ask_size == other.ask_size;
+        }
+    };
+
+    // Microstructure signals of the top levels, published with the BBO after every message that changes their inputs,
+    // readable from any thread through read_signals(). Prices in price units, 0 when a side they need is empty
+    struct Signals
+    {
+        int64_t  bid_price;
+        uint64_t bid_size;
+        int64_t  ask_price;
+        uint64_t ask_size;
+        int64_t  spread;            // ask - bid, both sides present only
+        double   mid;
+        double   microprice;        // (bid * ask_size + ask * bid_size) / (bid_size + ask_size), both sides present only
+        double   imbalance;         // (bid_size - ask_size) / (bid_size + ask_size) at the best level, in [-1, 1]
+        uint64_t bid_depth;         // size summed over the top `levels` levels of the side
+        uint64_t ask_depth;
+        double   depth_imbalance;   // (bid_depth - ask_depth) / (bid_depth + ask_depth)
+        double   bid_depth_price;   // size-weighted price of the top `levels` levels of the side
+        double   ask_depth_price;
+        uint32_t levels;
+        uint64_t ts_recv;           // ts_recv of the message that produced these values
+    };
+    using SignalsCallback = std::function<void(const Signals&)>;
+    static constexpr size_t DEFAULT_SIGNAL_LEVELS = 5;
+
+    static constexpr size_t MBP10_LEVELS = 10;
+    using BidAskPairs = std::array<databento::BidAskPair, MBP10_LEVELS>;
+    using Mbp10Callback = std::function<void(const databento::Mbp10Msg&)>;
+    using LevelCallback = std::function<void(bool is_bid, int64_t tick, int64_t size, int64_t count)>;
+    using LevelVisitor = std::function<void(int64_t price, const Level& level)>;
+
+    virtual ~OrderBookBase() = default;
+
+    // Apply thread
+    virtual void apply(const databento::MboMsg& mbo) = 0;
+    virtual void apply_batch(std::span<const databento::MboMsg> msgs) = 0;
+    virtual void clear() = 0;
+    virtual void publish() = 0;
+    virtual bool event_open() const = 0;
+
+    // Configuration, set before applying
+    virtual void set_event_batching(bool enabled) = 0;
+    virtual void set_queue_positions(bool enabled) = 0;
+    virtual bool queue_positions() const = 0;
+    virtual void set_bucket_resolutions(const std::vector<int64_t>& resolutions) = 0;
+    virtual void set_signal_levels(size_t levels) = 0;
+    virtual void set_signals_callback(SignalsCallback callback) = 0;
+    virtual void set_mbp10_callback(Mbp10Callback callback) = 0;
+    virtual void set_level_callback(LevelCallback callback) = 0;
+
+    // Any thread
+    virtual uint64_t read_published(PublishedDepth& out) const = 0;
+    virtual uint64_t read_bbo(Bbo& out) const = 0;
+    virtual uint64_t read_signals(Signals& out) const = 0;
+
+    // Apply thread: reads of the book
+    virtual int64_t tick_to_price(int64_t tick) const = 0;
+    virtual const Level* find_level(bool is_bid, int64_t tick) const = 0;
+    virtual const Level* best_level(bool is_bid, int64_t& tick) const = 0;
+    virtual const Level* next_worse_level(bool is_bid, int64_t tick, int64_t& out_tick) const = 0;
+    virtual void for_each_level(bool is_bid, size_t max_levels, const LevelVisitor& fn) const = 0;
+    virtual std::optional<std::pair<int64_t,uint64_t>> best_bid() const = 0;
+    virtual std::optional<std::pair<int64_t,uint64_t>> best_ask() const = 0;
+    virtual DepthSnapshot get_depth(int levels) const = 0;
+    virtual Json build_snapshot(size_t max_levels = SIZE_MAX) const = 0;
+    virtual Json build_bucket_snapshot(int64_t bucket_ticks, size_t max_buckets) const = 0;
+    virtual std::optional<QueuePosition> queue_position(uint64_t order_id) const = 0;
+    virtual void save_checkpoint(std::vector<char>& out) const = 0;
+    virtual bool load_checkpoint(const char*& pos, const char* end) = 0;
+};
+
+template <class Config>
+class BasicOrderBook final : public OrderBookBase
+{
 private:
     // ===== CONFIG =====
-    int64_t m_price_min;
-    int64_t m_price_max;
     int64_t m_tick_size;
-    size_t  m_num_levels;
+    size_t  m_num_levels;   // size of the dense window
+    int64_t m_base_tick;    // tick of window index 0
+    bool    m_recentering;  // move the window with the mid when the market drifts
 
-    // ===== BOOK ARRAYS =====
+    // ===== BOOK ARRAYS (dense window) =====
     std::vector<Level> m_bids;  // indexed as: higher price → bigger index
     std::vector<Level> m_asks;  // indexed as: lower price  → smaller index
 
-    // ===== ORDER LOOKUP TABLE =====
-    struct Ref
+    // ===== OVERFLOW LEVELS =====
+    // Levels priced outside the dense window, sorted by tick
+    std::map<int64_t, Level> m_bid_overflow;
+    std::map<int64_t, Level> m_ask_overflow;
+
+    // ===== OCCUPIED RANGE PER SIDE =====
+    // [lo, hi] bounds every non-empty level of a side, empty when lo > hi.
+    // Best bid = m_bid_range.hi, best ask = m_ask_range.lo
+    struct LevelRange
+    {
+        int64_t lo;
+        int64_t hi;
+
+        inline bool empty() const { return lo > hi; }
+    };
+    LevelRange m_bid_range;
+    LevelRange m_ask_range;
+
+    // ===== OCCUPANCY BITMAPS =====
+    // One bit per level, set while the level is non-empty
+    HierarchicalBitmap m_bid_bitmap;
+    HierarchicalBitmap m_ask_bitmap;
+
+    // ===== TOP-N DEPTH CACHE =====
+    // Best levels of a side (best → worst), patched in place when a level appears or disappears.
+    // Holds exactly the top min(capacity, number of levels) levels of the side.
+    // Entries point at the levels, so size changes cost nothing here (sizes are read by get_depth).
+    struct CachedLevel
     {
-        bool is_bid;
-        size_t index;
-        std::list<Order>::iterator it;
+        int64_t tick;
         int64_t price;
+        const Level* level;     // stable: window slots and map nodes only move on re-centering, which rebuilds
+    };
+    struct DepthCache
+    {
+        std::vector<CachedLevel> entries;
+        size_t count = 0;
+    };
+    size_t m_depth_cache_levels = DEFAULT_DEPTH_CACHE_LEVELS;
+    DepthCache m_bid_depth;
+    DepthCache m_ask_depth;
+
+    // ===== PUBLISHED DEPTH =====
+    SeqLock<PublishedDepth> m_published;
+    uint64_t m_last_ts_recv = 0;
+
+    // ===== PUBLISHED BBO =====
+    // Sequence and record share one cache line, a reader on another core pays a single miss per update
+    SeqLock<Bbo, true> m_bbo;
+    Bbo m_bbo_last{};     // apply thread copy of the last published record
+
+    // ===== SIGNALS =====
+    // Raw inputs of a side over the top levels, kept up to date from the level changes: size changes inside the top
+    // levels are added in place, a level entering / leaving them rescans that side. Published only when they move
+    struct SignalSide
+    {
+        int64_t  best_tick;
+        uint64_t best_size;
+        uint64_t depth;
+        uint64_t distance;      // sum of size * ticks behind the best level
+
+        bool operator==(const SignalSide&) const = default;
+    };
+    size_t m_signal_levels = 0;         // 0 = no signals
+    SignalSide m_signal_bid{};
+    SignalSide m_signal_ask{};
+    bool m_signal_bid_rescan = true;    // the set of top bid levels changed, recompute the side from the depth cache
+    bool m_signal_ask_rescan = true;
+    bool m_signals_moved = false;       // a size change was added to the inputs since the last publish
+    bool m_signals_stale = true;        // publish on the next update even if the inputs did not move
+    SeqLock<Signals> m_signals;
+    SignalsCallback m_signals_callback; // in-process subscriber, apply thread, empty = none
+
+    // ===== MBP-10 RECORDS =====
+    Mbp10Callback m_mbp10_callback;     // empty = no records are generated
+    databento::Mbp10Msg m_mbp10{};      // record handed to the callback, reused
+    bool m_mbp10_touched = false;       // event batching: a message of the open event touched the top 10
+
+    // ===== QUEUE POSITIONS =====
+    bool m_queue_positions = false;     // maintain a QueueIndex per level
+
+    // ===== BUCKETED AGGREGATES =====
+    // Per maintained resolution (in ticks): size and order count of every non-empty bucket (floor(tick / ticks)) of a side
+    struct BucketTotals
+    {
+        int64_t size = 0;
+        int64_t count = 0;
     };
-    std::unordered_map<uint64_t, Ref> m_orders_ref;
+    struct BucketView
+    {
+        int64_t ticks = 1;
+        FlatHashMap<int64_t, BucketTotals> bids;
+        FlatHashMap<int64_t, BucketTotals> asks;
+    };
+    std::vector<std::unique_ptr<BucketView>> m_bucket_views;    // empty = none maintained
+
+    // ===== LEVEL CHANGES =====
+    LevelCallback m_level_callback;     // size / order count deltas per level (e.g. a consolidated view), empty = none
+    bool m_level_tracking = false;      // bucket views, a level callback or signals: the operations report their level deltas
+
+    // ===== EVENT BATCHING =====
+    bool m_event_batching = false;      // results are only made visible on the last message of an event (F_LAST)
+    bool m_event_open = false;          // messages of an event were applied, its F_LAST message not yet
+
+    // ===== ORDER STORAGE =====
+    SlabPool<Order> m_order_pool;
+
+    // ===== ORDER LOOKUP TABLE =====
+    using Ref = Order*; // points straight at the pooled order node
+    FlatHashMap<uint64_t, Ref> m_orders_ref;
 
     EventBase* event_base = nullptr;
 
 public:
 
-    OrderBook(int64_t price_min, int64_t price_max, int64_t tick, EventBase* event_base)
-        : m_price_min(price_min),
-          m_price_max(price_max),
-          m_tick_size(tick),
+    // Fixed ladder: the dense window covers [price_min, price_max], other prices go to the overflow levels
+    BasicOrderBook(int64_t price_min, int64_t price_max, int64_t tick, EventBase* event_base) requires (!Config::IS_STATIC)
+        : BasicOrderBook(tick, (price_max - price_min) / tick + 1, floor_div(price_min, tick), false, event_base)
+    {}
+
+    // Self-recentering ladder: `window_levels` dense levels kept around the mid, any price (also negative) is accepted
+    BasicOrderBook(size_t window_levels, int64_t tick, EventBase* event_base) requires (!Config::IS_STATIC)
+        : BasicOrderBook(tick, window_levels, 0, true, event_base)
+    {}
+
+    // Everything comes from the compile-time config
+    explicit BasicOrderBook(EventBase* event_base = nullptr) requires (Config::IS_STATIC)
+        : BasicOrderBook(Config::TICK_SIZE, Config::NUM_LEVELS, Config::BASE_TICK, false, event_base)
+    {}
+
+private:
+    BasicOrderBook(int64_t tick, size_t num_levels, int64_t base_tick, bool recentering, EventBase* event_base)
+        : m_tick_size(tick),
+          m_num_levels(num_levels),
+          m_base_tick(base_tick),
+          m_recentering(recentering),
           event_base(event_base)
     {
-        m_num_levels = (m_price_max - m_price_min) / m_tick_size + 1;
         m_bids.resize(m_num_levels);
         m_asks.resize(m_num_levels);
-        m_orders_ref.reserve(10000000); // preallocate for performance
+        m_bid_bitmap.resize(m_num_levels);
+        m_ask_bitmap.resize(m_num_levels);
+        m_orders_ref.reserve(1 << 20); // grows x2 on demand, no need to preallocate for 10M orders
+        m_order_pool.reserve(1 << 16);
+        reset_ranges();
+        rebuild_depth_cache();
     }
 
-    inline size_t price_to_index(int64_t px) const
+    // Config accessors: constants for a static config, so the compiler folds them into the hot path
+    inline int64_t tick_size() const
     {
-        return (px - m_price_min) / m_tick_size;
+        if constexpr (Config::IS_STATIC) return Config::TICK_SIZE;
+        else return m_tick_size;
     }
 
-    inline Level& get_side(bool is_bid, size_t idx)
+    inline size_t num_levels() const
     {
-        return is_bid ? m_bids[idx] : m_asks[idx];
+        if constexpr (Config::IS_STATIC) return Config::NUM_LEVELS;
+        else return m_num_levels;
     }
 
-    inline const Level& get_side(bool is_bid, size_t idx) const
+    inline int64_t base_tick() const
     {
-        return is_bid ? m_bids[idx] : m_asks[idx];
+        if constexpr (Config::IS_STATIC) return Config::BASE_TICK;
+        else return m_base_tick;
+    }
+
+    inline bool recentering() const
+    {
+        if constexpr (Config::IS_STATIC) return false;
+        else return m_recentering;
+    }
+
+public:
+    static inline int64_t floor_div(int64_t a, int64_t b)
+    {
+        int64_t q = a / b;
+        return q - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    inline int64_t price_to_tick(int64_t px) const
+    {
+        return floor_div(px, tick_size());
+    }
+
+    inline int64_t tick_to_price(int64_t tick) const override
+    {
+        return tick * tick_size();
+    }
+
+    // Index inside the dense window (may be out of [0, num_levels) for overflow prices)
+    inline int64_t price_to_index(int64_t px) const
+    {
+        return price_to_tick(px) - base_tick();
+    }
+
+    inline bool in_window(int64_t tick) const
+    {
+        return (uint64_t)(tick - base_tick()) < num_levels();
+    }
+
+    // Level holding `tick`, an overflow level is created on demand
+    inline Level& level_at(bool is_bid, int64_t tick)
+    {
+        uint64_t idx = (uint64_t)(tick - base_tick());
+        if (idx < num_levels()) [[likely]]
+        {
+            return is_bid ? m_bids[idx] : m_asks[idx];
+        }
+        return (is_bid ? m_bid_overflow : m_ask_overflow)[tick];
+    }
+
+    // Non-empty level holding `tick`, nullptr when there is none
+    inline const Level* find_level(bool is_bid, int64_t tick) const override
+    {
+        uint64_t idx = (uint64_t)(tick - base_tick());
+        if (idx < num_levels()) [[likely]]
+        {
+            const Level& level = is_bid ? m_bids[idx] : m_asks[idx];
+            return level.empty() ? nullptr : &level;
+        }
+
+        const std::map<int64_t, Level>& overflow = is_bid ? m_bid_overflow : m_ask_overflow;
+        auto it = overflow.find(tick);
+        return it == overflow.end() ? nullptr : &it->second;
     }
 
     // ============================================
     // APPLY MBO MESSAGE
     // ============================================
-    void apply(const databento::MboMsg& mbo)
+    void apply(const databento::MboMsg& mbo) override
+    {
+        if (m_mbp10_callback) [[unlikely]]
+        {
+            apply_with_mbp10(mbo);
+        }
+        else
+        {
+            apply_event(mbo);
+        }
+
+        if (m_event_batching) [[unlikely]]
+        {
+            m_event_open = !mbo.flags.IsLast();
+        }
+
+        // Stamps the published depth and checkpoints, whichever of apply() / apply_batch() fed the book
+        uint64_t ts_recv = mbo.ts_recv.time_since_epoch().count();
+        m_last_ts_recv = ts_recv;
+
+        // Mid-event tops are never published, the F_LAST message publishes the result of the whole event
+        if (!m_event_open)
+        {
+            publish_bbo(ts_recv);
+            if (m_signal_levels) [[unlikely]] update_signals(ts_recv);
+        }
+    }
+
+    // ============================================
+    // EVENT BATCHING
+    // ============================================
+
+    // One matching event (e.g. a sweep) arrives as several messages, only the last one carries F_LAST.
+    // With event batching every message is still applied immediately, but MBP-10 records are only emitted
+    // and the registry only publishes once the event is complete, so nobody sees an intermediate book.
+    void set_event_batching(bool enabled) override
+    {
+        m_event_batching = enabled;
+        m_event_open = false;
+        m_mbp10_touched = false;
+    }
+
+    inline bool event_batching() const { return m_event_batching; }
+
+    // The book is between two messages of the same event (always false without event batching)
+    inline bool event_open() const override { return m_event_open; }
+
+private:
+    void apply_event(const databento::MboMsg& mbo)
     {
         char action = (char)mbo.action;
         char side   = (char)mbo.side;
@@ -113,16 +593,79 @@ public:
         if (side != 'A' && side != 'B') return;
 
         bool is_bid = (side == 'B');
-        size_t idx = price_to_index(mbo.price);
+        int64_t tick = price_to_tick(mbo.price);
 
         switch (action)
         {
-            case 'T': handle_trade(mbo); break;
-            case 'F': handle_full_fill(mbo); break;
-            case 'N': handle_non_printed(mbo); break;
-            case 'A': add(mbo, is_bid, idx); break;
+            // Compiled out when the config says fills are already reflected by C/M messages
+            case 'T': if constexpr (Config::TRADES_MUTATE) handle_trade(mbo); break;
+            case 'F': if constexpr (Config::TRADES_MUTATE) handle_full_fill(mbo); break;
+            case 'N': if constexpr (Config::TRADES_MUTATE) handle_non_printed(mbo); break;
+            case 'A': add(mbo, is_bid, tick); break;
             case 'C': cancel(mbo); break;
-            case 'M': modify(mbo, is_bid, idx); break;
+            case 'M': modify(mbo, is_bid, tick); break;
+        }
+    }
+
+public:
+    // ============================================
+    // BATCH APPLY
+    // ============================================
+
+    // Messages are applied strictly in order, the prefetches only warm the cache for the ones ahead:
+    // - 2 * PREFETCH_DISTANCE ahead: the order-index slot of the order id
+    // - PREFETCH_DISTANCE ahead: the order node (slot is in cache by now) or the level header for a new price
+    static constexpr size_t PREFETCH_DISTANCE = 8;
+
+    void apply_batch(std::span<const databento::MboMsg> msgs) override
+    {
+        size_t count = msgs.size();
+
+        for (size_t i = 0; i < std::min(count, 2 * PREFETCH_DISTANCE); ++i)
+        {
+            m_orders_ref.prefetch(msgs[i].order_id);
+        }
+        for (size_t i = 0; i < std::min(count, PREFETCH_DISTANCE); ++i)
+        {
+            prefetch_targets(msgs[i]);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (i + 2 * PREFETCH_DISTANCE < count)
+            {
+                m_orders_ref.prefetch(msgs[i + 2 * PREFETCH_DISTANCE].order_id);
+            }
+            if (i + PREFETCH_DISTANCE < count)
+            {
+                prefetch_targets(msgs[i + PREFETCH_DISTANCE]);
+            }
+            apply(msgs[i]);
+        }
+    }
+
+    inline void prefetch_targets(const databento::MboMsg& mbo) const
+    {
+        char action = (char)mbo.action;
+        char side   = (char)mbo.side;
+        if (side != 'A' && side != 'B') return;
+
+        // Existing order: the node holds its level, the level itself is read right after it
+        if (action != 'A')
+        {
+            const Ref* ref = m_orders_ref.find(mbo.order_id);
+            if (ref)
+            {
+                __builtin_prefetch(*ref);
+                return;
+            }
+        }
+
+        // New price (add, or modify of an unknown order): level header in the dense window
+        uint64_t idx = (uint64_t)(price_to_tick(mbo.price) - base_tick());
+        if (idx < num_levels())
+        {
+            __builtin_prefetch(side == 'B' ? &m_bids[idx] : &m_asks[idx]);
         }
     }
 
@@ -130,89 +673,105 @@ public:
     // OPERATIONS
     // ============================================
 
-    void add(const databento::MboMsg& mbo, bool is_bid, size_t idx)
+    void add(const databento::MboMsg& mbo, bool is_bid, int64_t tick)
     {
-        Level& level = get_side(is_bid, idx);
+        Level& level = level_at(is_bid, tick);
+
+        if (level.empty())
+        {
+            on_level_filled(is_bid, tick);
+            depth_cache_insert(is_bid, tick, level);
+        }
 
-        level.queue.push_back({mbo.order_id, mbo.size});
-        auto it = std::prev(level.queue.end());
+        Order* order = m_order_pool.acquire(mbo.order_id, mbo.price, tick, mbo.size, is_bid);
+        level.queue.push_back(order);
         level.total_size += mbo.size;
+        if (m_queue_positions) [[unlikely]] queue_index_push(level, order);
+        if (m_level_tracking) [[unlikely]] level_changed(is_bid, tick, mbo.size, 1);
 
-        m_orders_ref[mbo.order_id] = Ref{is_bid, idx, it, mbo.price};
+        m_orders_ref.insert_or_assign(mbo.order_id, order);
+
+        if (recentering() && !in_window(tick))
+        {
+            maybe_recenter();
+        }
     }
 
     void cancel(const databento::MboMsg& mbo)
     {
-        auto it = m_orders_ref.find(mbo.order_id);
-        if (it == m_orders_ref.end()) return;
+        Ref* ref = m_orders_ref.find(mbo.order_id);
+        if (ref == nullptr) return;
 
-        Ref& ref = it->second;
-        Level& level = get_side(ref.is_bid, ref.index);
+        Order* order = *ref;
+        Level& level = level_at(order->is_bid, order->tick);
 
         uint32_t cancel_sz = mbo.size;
-        uint32_t& ord_sz = ref.it->size;
 
-        if (cancel_sz >= ord_sz)
+        if (cancel_sz >= order->size)
         {
-            level.total_size -= ord_sz;
-            level.queue.erase(ref.it);
-            m_orders_ref.erase(it);
+            level.total_size -= order->size;
+            remove_order(level, order);
+            m_orders_ref.erase(mbo.order_id);
         }
         else
         {
-            ord_sz -= cancel_sz;
+            order->size -= cancel_sz;
             level.total_size -= cancel_sz;
+            if (m_queue_positions) [[unlikely]] queue_index_resize(level, order, -(int64_t)cancel_sz);
+            if (m_level_tracking) [[unlikely]] level_changed(order->is_bid, order->tick, -(int64_t)cancel_sz, 0);
         }
     }
 
-    void modify(const databento::MboMsg& mbo, bool new_is_bid, size_t new_idx)
+    void modify(const databento::MboMsg& mbo, bool new_is_bid, int64_t new_tick)
     {
-        auto it = m_orders_ref.find(mbo.order_id);
+        Ref* ref = m_orders_ref.find(mbo.order_id);
 
         // Treat modify on missing ID as add()
-        if (it == m_orders_ref.end())
+        if (ref == nullptr)
         {
-            add(mbo, new_is_bid, new_idx);
+            add(mbo, new_is_bid, new_tick);
             return;
         }
 
-        Ref ref = it->second; // copy
-        Level& old_level = get_side(ref.is_bid, ref.index);
-        uint32_t old_size = ref.it->size;
+        Order* order = *ref;
+        Level& old_level = level_at(order->is_bid, order->tick);
+        uint32_t old_size = order->size;
 
         // CASE 1: Size becomes zero → delete order
         if (mbo.size == 0)
         {
             old_level.total_size -= old_size;
-            old_level.queue.erase(ref.it);
-            m_orders_ref.erase(it);
+            remove_order(old_level, order);
+            m_orders_ref.erase(mbo.order_id);
             return;
         }
 
         // CASE 2: Price changed → remove and re-add (loses all priority)
-        if (mbo.price != ref.price)
+        if (mbo.price != order->price)
         {
             // remove from old level
             old_level.total_size -= old_size;
-            old_level.queue.erase(ref.it);
-            m_orders_ref.erase(it);
+            remove_order(old_level, order);
+            m_orders_ref.erase(mbo.order_id);
 
             // re-add into new level
-            add(mbo, new_is_bid, new_idx);
+            add(mbo, new_is_bid, new_tick);
             return;
         }
 
         // CASE 3: Same price, size increases → lose priority
         if (mbo.size > old_size)
         {
+            if (m_queue_positions) [[unlikely]] queue_index_erase(old_level, order);
+
             old_level.total_size += (mbo.size - old_size);
-            ref.it->size = mbo.size;
+            order->size = mbo.size;
+            if (m_level_tracking) [[unlikely]] level_changed(order->is_bid, order->tick, mbo.size - old_size, 0);
 
             // move to back (lose priority)
-            old_level.queue.splice(old_level.queue.end(), old_level.queue, ref.it);
+            old_level.queue.move_to_back(order);
 
-            // update ref info
-            it->second.price = mbo.price;
+            if (m_queue_positions) [[unlikely]] queue_index_push(old_level, order);
             return;
         }
 
@@ -220,44 +779,43 @@ public:
         if (mbo.size < old_size)
         {
             old_level.total_size -= (old_size - mbo.size);
-            ref.it->size = mbo.size;
+            order->size = mbo.size;
+            if (m_queue_positions) [[unlikely]] queue_index_resize(old_level, order, -(int64_t)(old_size - mbo.size));
+            if (m_level_tracking) [[unlikely]] level_changed(order->is_bid, order->tick, -(int64_t)(old_size - mbo.size), 0);
         }
-
-        // Update stored price for future comparisons
-        it->second.price = mbo.price;
     }
 
     void handle_trade(const databento::MboMsg& mbo)
     {
-        auto it = m_orders_ref.find(mbo.order_id);
-        if (it == m_orders_ref.end()) return;
-
-        Ref& ref = it->second;
-        Level& level = get_side(ref.is_bid, ref.index);
+        Ref* ref = m_orders_ref.find(mbo.order_id);
+        if (ref == nullptr) return;
 
-        uint32_t& ord_sz = ref.it->size;
+        Order* order = *ref;
+        Level& level = level_at(order->is_bid, order->tick);
 
-        if (mbo.size >= ord_sz) {
-            level.total_size -= ord_sz;
-            level.queue.erase(ref.it);
-            m_orders_ref.erase(it);
+        if (mbo.size >= order->size) {
+            level.total_size -= order->size;
+            remove_order(level, order);
+            m_orders_ref.erase(mbo.order_id);
         } else {
-            ord_sz -= mbo.size;
+            order->size -= mbo.size;
             level.total_size -= mbo.size;
+            if (m_queue_positions) [[unlikely]] queue_index_resize(level, order, -(int64_t)mbo.size);
+            if (m_level_tracking) [[unlikely]] level_changed(order->is_bid, order->tick, -(int64_t)mbo.size, 0);
         }
     }
 
     void handle_full_fill(const databento::MboMsg& mbo)
     {
-        auto it = m_orders_ref.find(mbo.order_id);
-        if (it == m_orders_ref.end()) return;
+        Ref* ref = m_orders_ref.find(mbo.order_id);
+        if (ref == nullptr) return;
 
-        Ref& ref = it->second;
-        Level& level = get_side(ref.is_bid, ref.index);
+        Order* order = *ref;
+        Level& level = level_at(order->is_bid, order->tick);
 
-        level.total_size -= ref.it->size;
-        level.queue.erase(ref.it);
-        m_orders_ref.erase(it);
+        level.total_size -= order->size;
+        remove_order(level, order);
+        m_orders_ref.erase(mbo.order_id);
     }
 
     void handle_non_printed(const databento::MboMsg& mbo)
@@ -265,119 +823,1197 @@ public:
         handle_trade(mbo); // same logic as T
     }
 
+    // Unlink an order from its level and give the node back to the pool
+    inline void remove_order(Level& level, Order* order)
+    {
+        if (m_queue_positions) [[unlikely]] queue_index_erase(level, order);
+        if (m_level_tracking) [[unlikely]] level_changed(order->is_bid, order->tick, -(int64_t)order->size, -1);
+
+        level.queue.erase(order);
+        if (level.empty())
+        {
+            on_level_emptied(order->is_bid, order->tick);
+            depth_cache_remove(order->is_bid, order->tick);
+        }
+        m_order_pool.release(order);
+    }
+
     // ============================================
-    // BEST BID / BEST ASK
+    // OCCUPIED RANGE MAINTENANCE
     // ============================================
 
-    std::optional<std::pair<int64_t,uint64_t>> best_bid() const
+    inline void on_level_filled(bool is_bid, int64_t tick)
+    {
+        if (!in_window(tick)) return; // the overflow map entry itself marks the level as occupied
+
+        size_t idx = tick - base_tick();
+        LevelRange& range = is_bid ? m_bid_range : m_ask_range;
+        (is_bid ? m_bid_bitmap : m_ask_bitmap).set(idx);
+
+        range.lo = std::min(range.lo, (int64_t)idx);
+        range.hi = std::max(range.hi, (int64_t)idx);
+    }
+
+    // Only the edges of the range need work: jump to the next occupied level through the bitmap
+    inline void on_level_emptied(bool is_bid, int64_t tick)
     {
-        for (int i = (int)m_num_levels-1; i >= 0; --i)
+        if (!in_window(tick))
         {
-            if (!m_bids[i].empty())
-            {
-                int64_t price = m_price_min + i * m_tick_size;
-                return std::make_pair(price, m_bids[i].total_size);
-            }
+            (is_bid ? m_bid_overflow : m_ask_overflow).erase(tick);
+            return;
+        }
+
+        size_t idx = tick - base_tick();
+        LevelRange& range = is_bid ? m_bid_range : m_ask_range;
+        HierarchicalBitmap& bitmap = is_bid ? m_bid_bitmap : m_ask_bitmap;
+        bitmap.reset(idx);
+
+        if (range.hi == (int64_t)idx)
+        {
+            size_t hi = bitmap.prev(idx);
+            range.hi = hi == HierarchicalBitmap::npos ? -1 : (int64_t)hi;
+        }
+        else if (range.lo == (int64_t)idx)
+        {
+            size_t lo = bitmap.next(idx);
+            range.lo = lo == HierarchicalBitmap::npos ? (int64_t)num_levels() : (int64_t)lo;
+        }
+
+        if (range.empty())
+        {
+            range = LevelRange{(int64_t)num_levels(), -1};
         }
-        return std::nullopt;
     }
 
-    std::optional<std::pair<int64_t,uint64_t>> best_ask() const
+    // Visit occupied levels from best to worst as fn(price, level), at most `max_levels` of them
+    template <typename F>
+    inline void for_each_level(bool is_bid, size_t max_levels, F&& fn) const
     {
-        for (size_t i = 0; i < m_num_levels; ++i)
+        for_each_level_tick(is_bid, max_levels, [&](int64_t tick, const Level& level)
         {
-            if (!m_asks[i].empty())
-            {
-                int64_t price = m_price_min + i * m_tick_size;
-                return std::make_pair(price, m_asks[i].total_size);
-            }
-        }
-        return std::nullopt;
+            fn(tick_to_price(tick), level);
+        });
     }
 
-    // ============================================
+    void for_each_level(bool is_bid, size_t max_levels, const LevelVisitor& fn) const override
+    {
+        for_each_level_tick(is_bid, max_levels, [&](int64_t tick, const Level& level)
+        {
+            fn(tick_to_price(tick), level);
+        });
+    }
 
-    const Level& get_level(bool is_bid, size_t idx) const
+    // Same walk as fn(tick, level).
+    // Overflow levels beyond the window come first, then the window, then overflow levels behind it.
+    template <typename F>
+    inline void for_each_level_tick(bool is_bid, size_t max_levels, F&& fn) const
     {
-        return is_bid ? m_bids[idx] : m_asks[idx];
+        walk_levels(*this, is_bid, max_levels, fn);
     }
 
-    // ============================================
+    // Apply thread: same walk over mutable levels, e.g. to rebuild an index they hold
+    template <typename F>
+    inline void for_each_level_tick(bool is_bid, size_t max_levels, F&& fn)
+    {
+        walk_levels(*this, is_bid, max_levels, fn);
+    }
 
-    DepthSnapshot get_depth(int levels) const
+private:
+    // Both walks: `Self` is const or not, levels are handed to fn with the same constness
+    template <typename Self, typename F>
+    static inline void walk_levels(Self& self, bool is_bid, size_t max_levels, F& fn)
     {
-        DepthSnapshot out;
-        out.bids.reserve(levels);
-        out.asks.reserve(levels);
+        auto& overflow = is_bid ? self.m_bid_overflow : self.m_ask_overflow;
+        const HierarchicalBitmap& bitmap = is_bid ? self.m_bid_bitmap : self.m_ask_bitmap;
+        auto& levels = is_bid ? self.m_bids : self.m_asks;
+        constexpr size_t npos = HierarchicalBitmap::npos;
+        int64_t base_tick = self.base_tick();
+        size_t num_levels = self.num_levels();
+
+        size_t count = 0;
+        auto visit = [&](int64_t tick, auto& level)
+        {
+            fn(tick, level);
+            return ++count < max_levels;
+        };
 
-        // -------------------- BIDS (descending) --------------------
-        int count = 0;
-        for (int idx = (int)m_num_levels - 1; idx >= 0 && count < levels; --idx)
+        if (max_levels == 0) return;
+
+        if (is_bid)
         {
-            if (!m_bids[idx].empty())
+            int64_t window_end = base_tick + (int64_t)num_levels;
+            auto it = overflow.rbegin();
+            for (; it != overflow.rend() && it->first >= window_end; ++it)
             {
-                int64_t price = m_price_min + idx * m_tick_size;
-                uint64_t size = m_bids[idx].total_size;
-
-                out.bids.push_back({price, size});
-                count++;
+                if (!visit(it->first, it->second)) return;
+            }
+            for (size_t idx = bitmap.prev(num_levels - 1); idx != npos; idx = idx == 0 ? npos : bitmap.prev(idx - 1))
+            {
+                if (!visit(base_tick + (int64_t)idx, levels[idx])) return;
+            }
+            for (; it != overflow.rend(); ++it)
+            {
+                if (!visit(it->first, it->second)) return;
             }
         }
-
-        // -------------------- ASKS (ascending) --------------------
-        count = 0;
-        for (size_t idx = 0; idx < m_num_levels && count < levels; ++idx)
+        else
         {
-            if (!m_asks[idx].empty())
+            auto it = overflow.begin();
+            for (; it != overflow.end() && it->first < base_tick; ++it)
             {
-                int64_t price = m_price_min + idx * m_tick_size;
-                uint64_t size = m_asks[idx].total_size;
-
-                out.asks.push_back({price, size});
-                count++;
+                if (!visit(it->first, it->second)) return;
+            }
+            for (size_t idx = bitmap.next(0); idx != npos; idx = bitmap.next(idx + 1))
+            {
+                if (!visit(base_tick + (int64_t)idx, levels[idx])) return;
+            }
+            for (; it != overflow.end(); ++it)
+            {
+                if (!visit(it->first, it->second)) return;
             }
         }
+    }
 
-        return out;
+public:
+    void reset_ranges()
+    {
+        m_bid_range = LevelRange{(int64_t)num_levels(), -1};
+        m_ask_range = LevelRange{(int64_t)num_levels(), -1};
+    }
+
+    inline int64_t index_to_price(int64_t idx) const
+    {
+        return tick_to_price(base_tick() + idx);
     }
 
     // ============================================
-    // FULL BOOK SNAPSHOT
+    // TOP-N DEPTH CACHE
     // ============================================
 
-    Json build_snapshot() const
+    // Number of levels per side served by get_depth() / build_snapshot() without walking the ladder
+    void set_depth_cache_levels(size_t levels)
     {
-        Json snap;
+        m_depth_cache_levels = levels;
+        rebuild_depth_cache();
+    }
 
-        // ----------- BIDS (high → low) --------------
-        Json bids;
-        for (int i = (int)m_num_levels - 1; i >= 0; --i)
+    inline size_t depth_cache_levels() const { return m_depth_cache_levels; }
+
+    void rebuild_depth_cache()
+    {
+        for (bool is_bid : {true, false})
         {
-            const Level& lvl = m_bids[i];
-            if (!lvl.empty())
+            DepthCache& cache = is_bid ? m_bid_depth : m_ask_depth;
+            cache.entries.resize(m_depth_cache_levels);
+            cache.count = 0;
+
+            for_each_level_tick(is_bid, m_depth_cache_levels, [&](int64_t tick, const Level& level)
             {
-                int64_t price = m_price_min + i * m_tick_size;
-                bids.push_back({
-                    {"price", price},
-                    {"size" , lvl.total_size}
-                });
+                cache.entries[cache.count++] = CachedLevel{tick, tick_to_price(tick), &level};
+            });
+        }
+        m_signal_bid_rescan = true;
+        m_signal_ask_rescan = true;
+    }
+
+    // First cached position whose level is not better than `tick`
+    static inline size_t depth_cache_position(const DepthCache& cache, bool is_bid, int64_t tick)
+    {
+        auto begin = cache.entries.begin();
+        auto end = begin + cache.count;
+        auto it = is_bid
+            ? std::lower_bound(begin, end, tick, [](const CachedLevel& e, int64_t t) { return e.tick > t; })
+            : std::lower_bound(begin, end, tick, [](const CachedLevel& e, int64_t t) { return e.tick < t; });
+        return it - begin;
+    }
+
+    // A level was just created
+    inline void depth_cache_insert(bool is_bid, int64_t tick, const Level& level)
+    {
+        DepthCache& cache = is_bid ? m_bid_depth : m_ask_depth;
+
+        // Behind the worst cached level of a full cache: not in the top N
+        if (cache.count == m_depth_cache_levels)
+        {
+            if (cache.count == 0) return;
+            int64_t worst = cache.entries[cache.count - 1].tick;
+            if (is_bid ? tick < worst : tick > worst) return;
+        }
+
+        size_t pos = depth_cache_position(cache, is_bid, tick);
+
+        // The worst cached level falls out when full
+        size_t last = std::min(cache.count, m_depth_cache_levels - 1);
+        std::copy_backward(cache.entries.begin() + pos, cache.entries.begin() + last, cache.entries.begin() + last + 1);
+        cache.entries[pos] = CachedLevel{tick, tick_to_price(tick), &level};
+        cache.count = last + 1;
+        if (pos < m_signal_levels) [[unlikely]] signals_rescan(is_bid);
+    }
+
+    // A level became empty, it is already gone from the window / overflow levels
+    inline void depth_cache_remove(bool is_bid, int64_t tick)
+    {
+        DepthCache& cache = is_bid ? m_bid_depth : m_ask_depth;
+
+        size_t pos = depth_cache_position(cache, is_bid, tick);
+        if (pos == cache.count || cache.entries[pos].tick != tick) return;
+
+        bool was_full = cache.count == m_depth_cache_levels;
+        if (pos < m_signal_levels) [[unlikely]] signals_rescan(is_bid);
+        std::copy(cache.entries.begin() + pos + 1, cache.entries.begin() + cache.count, cache.entries.begin() + pos);
+        cache.count--;
+
+        // The side may have more levels than the cache holds: pull in the next one behind the worst cached level
+        if (was_full)
+        {
+            int64_t from = cache.count ? cache.entries[cache.count - 1].tick : tick;
+            int64_t next_tick = 0;
+            const Level* next = next_worse_level(is_bid, from, next_tick);
+            if (next)
+            {
+                cache.entries[cache.count++] = CachedLevel{next_tick, tick_to_price(next_tick), next};
+            }
+        }
+    }
+
+    // Best occupied level strictly worse than `tick` (lower for bids, higher for asks), nullptr when none
+    const Level* next_worse_level(bool is_bid, int64_t tick, int64_t& out_tick) const override
+    {
+        const std::map<int64_t, Level>& overflow = is_bid ? m_bid_overflow : m_ask_overflow;
+        const HierarchicalBitmap& bitmap = is_bid ? m_bid_bitmap : m_ask_bitmap;
+        const std::vector<Level>& levels = is_bid ? m_bids : m_asks;
+        const Level* found = nullptr;
+
+        if (is_bid)
+        {
+            int64_t idx = std::min(tick - 1 - base_tick(), (int64_t)num_levels() - 1);
+            size_t window_idx = idx >= 0 ? bitmap.prev(idx) : HierarchicalBitmap::npos;
+            if (window_idx != HierarchicalBitmap::npos)
+            {
+                out_tick = base_tick() + (int64_t)window_idx;
+                found = &levels[window_idx];
+            }
+
+            auto it = overflow.lower_bound(tick);
+            if (it != overflow.begin())
+            {
+                --it;
+                if (!found || it->first > out_tick)
+                {
+                    out_tick = it->first;
+                    found = &it->second;
+                }
+            }
+        }
+        else
+        {
+            int64_t idx = std::max(tick + 1 - base_tick(), (int64_t)0);
+            size_t window_idx = idx < (int64_t)num_levels() ? bitmap.next(idx) : HierarchicalBitmap::npos;
+            if (window_idx != HierarchicalBitmap::npos)
+            {
+                out_tick = base_tick() + (int64_t)window_idx;
+                found = &levels[window_idx];
+            }
+
+            auto it = overflow.upper_bound(tick);
+            if (it != overflow.end() && (!found || it->first < out_tick))
+            {
+                out_tick = it->first;
+                found = &it->second;
+            }
+        }
+        return found;
+    }
+
+    // ============================================
+    // PUBLISHED DEPTH (seqlock)
+    // ============================================
+
+    // Apply thread: copy the top-N cache into the published block (and the BBO if it changed)
+    void publish() override
+    {
+        m_published.write([this](PublishedDepth& block)
+        {
+            block.last_ts_recv = m_last_ts_recv;
+            block.bid_count = (uint32_t)std::min(m_bid_depth.count, PUBLISHED_DEPTH_LEVELS);
+            block.ask_count = (uint32_t)std::min(m_ask_depth.count, PUBLISHED_DEPTH_LEVELS);
+
+            for (uint32_t i = 0; i < block.bid_count; ++i)
+            {
+                block.bids[i] = DepthEntry{m_bid_depth.entries[i].price, m_bid_depth.entries[i].level->total_size};
+            }
+            for (uint32_t i = 0; i < block.ask_count; ++i)
+            {
+                block.asks[i] = DepthEntry{m_ask_depth.entries[i].price, m_ask_depth.entries[i].level->total_size};
+            }
+        });
+
+        // Covers the changes made outside apply() (reset, checkpoint load)
+        publish_bbo(m_last_ts_recv);
+        if (m_signal_levels) update_signals(m_last_ts_recv);
+    }
+
+    // Any thread: last published block, returns its version (0 = never published)
+    inline uint64_t read_published(PublishedDepth& out) const override
+    {
+        return m_published.load(out);
+    }
+
+    // ============================================
+    // PUBLISHED BBO (seqlock, one cache line)
+    // ============================================
+
+    // Apply thread: publish the top of book if it differs from the last published one
+    inline void publish_bbo(uint64_t ts_recv)
+    {
+        Bbo bbo;
+        bbo.ts_recv = ts_recv;
+        top_of_side(true, bbo.bid_price, bbo.bid_size);
+        top_of_side(false, bbo.ask_price, bbo.ask_size);
+
+        if (bbo.same_top(m_bbo_last)) [[likely]] return;
+
+        m_bbo_last = bbo;
+        m_bbo.store(bbo);
+    }
+
+    // Any thread: torn-free best bid / ask, returns its version (number of BBO changes, 0 = never published)
+    inline uint64_t read_bbo(Bbo& out) const override
+    {
+        return m_bbo.load(out);
+    }
+
+private:
+    // Best level of a side from the depth cache (the ladder when the cache is disabled), size 0 when empty
+    inline void top_of_side(bool is_bid, int64_t& price, uint64_t& size) const
+    {
+        const DepthCache& cache = is_bid ? m_bid_depth : m_ask_depth;
+        if (cache.count) [[likely]]
+        {
+            price = cache.entries[0].price;
+            size = cache.entries[0].level->total_size;
+            return;
+        }
+
+        int64_t tick = 0;
+        const Level* level = m_depth_cache_levels ? nullptr : best_level(is_bid, tick);
+        price = level ? tick_to_price(tick) : 0;
+        size = level ? level->total_size : 0;
+    }
+
+public:
+    // ============================================
+    // SIGNALS
+    // ============================================
+
+    // Mid, spread, microprice, imbalances and depth-weighted prices over the top `levels` levels per side (0 = off),
+    // at most depth_cache_levels() levels. Maintained from the level changes: a message only rescans the top levels
+    // of a side when a level enters or leaves them
+    void set_signal_levels(size_t levels) override
+    {
+        m_signal_levels = levels;
+        m_level_tracking = !m_bucket_views.empty() || m_level_callback || m_signal_levels;
+        m_signal_bid_rescan = true;
+        m_signal_ask_rescan = true;
+        m_signals_stale = true;
+    }
+
+    inline size_t signal_levels() const { return m_signal_levels; }
+
+    // `callback(signals)` runs on the apply thread after every publish of new values. nullptr = none
+    void set_signals_callback(SignalsCallback callback) override
+    {
+        m_signals_callback = std::move(callback);
+    }
+
+    // Any thread: torn-free signals, returns their version (number of publishes, 0 = never published)
+    inline uint64_t read_signals(Signals& out) const override
+    {
+        return m_signals.load(out);
+    }
+
+    static Json signals_to_json(const Signals& signals)
+    {
+        return {
+            {"levels", signals.levels},
+            {"bid_price", signals.bid_price},
+            {"bid_size", signals.bid_size},
+            {"ask_price", signals.ask_price},
+            {"ask_size", signals.ask_size},
+            {"spread", signals.spread},
+            {"mid", signals.mid},
+            {"microprice", signals.microprice},
+            {"imbalance", signals.imbalance},
+            {"bid_depth", signals.bid_depth},
+            {"ask_depth", signals.ask_depth},
+            {"depth_imbalance", signals.depth_imbalance},
+            {"bid_depth_price", signals.bid_depth_price},
+            {"ask_depth_price", signals.ask_depth_price},
+            {"ts_recv", signals.ts_recv}
+        };
+    }
+
+private:
+    // Apply thread: recompute and publish the signals if their inputs moved
+    void update_signals(uint64_t ts_recv)
+    {
+        size_t levels = signal_depth();
+        for (bool is_bid : {true, false})
+        {
+            bool& rescan = is_bid ? m_signal_bid_rescan : m_signal_ask_rescan;
+            if (!rescan) [[likely]] continue;
+
+            SignalSide& current = is_bid ? m_signal_bid : m_signal_ask;
+            SignalSide side = signal_side(is_bid, levels);
+            m_signals_moved |= side != current;
+            current = side;
+            rescan = false;
+        }
+
+        if (!m_signals_stale && !m_signals_moved) [[likely]] return;
+
+        const SignalSide& bid = m_signal_bid;
+        const SignalSide& ask = m_signal_ask;
+        m_signals_moved = false;
+        m_signals_stale = false;
+
+        Signals signals{};
+        signals.levels = (uint32_t)levels;
+        signals.ts_recv = ts_recv;
+        signals.bid_size = bid.best_size;
+        signals.ask_size = ask.best_size;
+        signals.bid_depth = bid.depth;
+        signals.ask_depth = ask.depth;
+
+        if (bid.depth)
+        {
+            signals.bid_price = tick_to_price(bid.best_tick);
+            signals.bid_depth_price = signals.bid_price - (double)tick_size() * bid.distance / bid.depth;
+        }
+        if (ask.depth)
+        {
+            signals.ask_price = tick_to_price(ask.best_tick);
+            signals.ask_depth_price = signals.ask_price + (double)tick_size() * ask.distance / ask.depth;
+        }
+        uint64_t top = bid.best_size + ask.best_size;
+        if (bid.depth && ask.depth)
+        {
+            signals.spread = signals.ask_price - signals.bid_price;
+            signals.mid = (signals.bid_price + signals.ask_price) / 2.0;
+            signals.microprice = top ? ((double)signals.bid_price * ask.best_size + (double)signals.ask_price * bid.best_size) / top : signals.mid;
+        }
+
+        signals.imbalance = top ? ((double)bid.best_size - (double)ask.best_size) / top : 0;
+
+        uint64_t depth = bid.depth + ask.depth;
+        signals.depth_imbalance = depth ? ((double)bid.depth - (double)ask.depth) / depth : 0;
+
+        m_signals.store(signals);
+        if (m_signals_callback) m_signals_callback(signals);
+    }
+
+    // Levels per side the signals cover
+    inline size_t signal_depth() const { return std::min(m_signal_levels, m_depth_cache_levels); }
+
+    inline void signals_rescan(bool is_bid)
+    {
+        (is_bid ? m_signal_bid_rescan : m_signal_ask_rescan) = true;
+    }
+
+    // Size change of an existing level: added to the inputs when the level is one of the top levels of its side
+    inline void signals_level_changed(bool is_bid, int64_t tick, int64_t size)
+    {
+        if (is_bid ? m_signal_bid_rescan : m_signal_ask_rescan) return;
+
+        const DepthCache& cache = is_bid ? m_bid_depth : m_ask_depth;
+        size_t levels = signal_depth();
+        size_t count = std::min(cache.count, levels);
+        if (count == 0) return;
+
+        // A full top: the level must not be behind the worst of them (a shorter side has all its levels in it)
+        if (count == levels)
+        {
+            int64_t worst = cache.entries[count - 1].tick;
+            if (is_bid ? tick < worst : tick > worst) return;
+        }
+
+        SignalSide& side = is_bid ? m_signal_bid : m_signal_ask;
+        int64_t behind = is_bid ? side.best_tick - tick : tick - side.best_tick;
+        side.depth += (uint64_t)size;
+        side.distance += (uint64_t)(size * behind);
+        if (tick == side.best_tick) side.best_size += (uint64_t)size;
+        m_signals_moved = true;
+    }
+
+    // Best tick, best size, summed size and size-weighted distance to the best tick of the first `levels` cached levels
+    inline SignalSide signal_side(bool is_bid, size_t levels) const
+    {
+        const DepthCache& cache = is_bid ? m_bid_depth : m_ask_depth;
+        SignalSide side{};
+        size_t count = std::min(cache.count, levels);
+        if (count == 0) return side;
+
+        side.best_tick = cache.entries[0].tick;
+        side.best_size = cache.entries[0].level->total_size;
+        for (size_t i = 0; i < count; ++i)
+        {
+            uint64_t size = cache.entries[i].level->total_size;
+            side.depth += size;
+            int64_t behind = is_bid ? side.best_tick - cache.entries[i].tick : cache.entries[i].tick - side.best_tick;
+            side.distance += size * (uint64_t)behind;
+        }
+        return side;
+    }
+
+public:
+
+    // Any thread: Json in the build_snapshot() layout, at most `max_levels` per side
+    static Json published_to_json(const PublishedDepth& block, size_t max_levels)
+    {
+        Json bids;
+        Json asks;
+
+        for (size_t i = 0; i < std::min<size_t>(max_levels, block.bid_count); ++i)
+        {
+            bids.push_back({
+                {"price", block.bids[i].price},
+                {"size" , block.bids[i].size}
+            });
+        }
+        for (size_t i = 0; i < std::min<size_t>(max_levels, block.ask_count); ++i)
+        {
+            asks.push_back({
+                {"price", block.asks[i].price},
+                {"size" , block.asks[i].size}
+            });
+        }
+
+        Json snap;
+        snap["bids"] = bids;
+        snap["asks"] = asks;
+        return snap;
+    }
+
+    // ============================================
+    // QUEUE POSITIONS
+    // ============================================
+
+    // Turning it on indexes the orders already resting, turning it off drops every index
+    void set_queue_positions(bool enabled) override
+    {
+        if (enabled == m_queue_positions) return;
+        m_queue_positions = enabled;
+
+        for (bool is_bid : {true, false})
+        {
+            for_each_level_tick(is_bid, SIZE_MAX, [&](int64_t, Level& level)
+            {
+                if (enabled) queue_index_rebuild(level, 0);
+                else         level.queue_index.reset();
+            });
+        }
+    }
+
+    inline bool queue_positions() const override { return m_queue_positions; }
+
+    // O(log n) with queue positions on, otherwise a walk from the front of the queue
+    std::optional<QueuePosition> queue_position(uint64_t order_id) const override
+    {
+        const Ref* ref = m_orders_ref.find(order_id);
+        if (ref == nullptr) return std::nullopt;
+
+        const Order* order = *ref;
+        const Level& level = level_ref(order->is_bid, order->tick);
+
+        QueueAmount ahead;
+        if (level.queue_index)
+        {
+            ahead = level.queue_index->tree.prefix_sum(order->slot);
+        }
+        else
+        {
+            for (const Order& other : level.queue)
+            {
+                if (&other == order) break;
+                ahead += QueueAmount{other.size, 1};
+            }
+        }
+
+        return QueuePosition{order->price, order->is_bid, order->size, (uint64_t)ahead.size, (uint64_t)ahead.count,
+                             level.total_size, level.queue.size()};
+    }
+
+private:
+    // Existing level of `tick` (the order index guarantees it exists)
+    inline const Level& level_ref(bool is_bid, int64_t tick) const
+    {
+        if (in_window(tick))
+        {
+            return is_bid ? m_bids[tick - base_tick()] : m_asks[tick - base_tick()];
+        }
+        return (is_bid ? m_bid_overflow : m_ask_overflow).at(tick);
+    }
+
+    // `order` was just pushed to the back of the level queue
+    inline void queue_index_push(Level& level, Order* order)
+    {
+        QueueIndex* index = level.queue_index.get();
+        if (index == nullptr || index->next_slot == index->tree.size())
+        {
+            // Renumbers the live orders (this one included) and makes room
+            queue_index_rebuild(level, 1);
+            return;
+        }
+
+        order->slot = index->next_slot++;
+        index->tree.add(order->slot, QueueAmount{order->size, 1});
+    }
+
+    // Before `order` leaves the level queue (or moves to its back)
+    inline void queue_index_erase(Level& level, Order* order)
+    {
+        QueueIndex* index = level.queue_index.get();
+        index->tree.add(order->slot, QueueAmount{-(int64_t)order->size, -1});
+
+        // Last order gone: every slot is back to zero, numbering restarts
+        if (level.queue.size() == 1)
+        {
+            index->next_slot = 0;
+        }
+    }
+
+    inline void queue_index_resize(Level& level, Order* order, int64_t delta)
+    {
+        level.queue_index->tree.add(order->slot, QueueAmount{delta, 0});
+    }
+
+    // Live orders get slots 0..n-1 in FIFO order, in a tree with at least `spare` free slots behind them (O(n))
+    void queue_index_rebuild(Level& level, size_t spare)
+    {
+        if (!level.queue_index)
+        {
+            level.queue_index = std::make_unique<QueueIndex>();
+        }
+
+        size_t live = level.queue.size();
+        size_t capacity = std::max<size_t>(level.queue_index->tree.size(), 16);
+        while (capacity < 2 * live + spare) capacity *= 2;
+
+        std::vector<QueueAmount> slots(capacity);
+        uint32_t slot = 0;
+        for (Order& order : level.queue)
+        {
+            order.slot = slot;
+            slots[slot++] = QueueAmount{order.size, 1};
+        }
+
+        level.queue_index->tree.build(slots);
+        level.queue_index->next_slot = slot;
+    }
+
+public:
+    // ============================================
+    // BUCKETED AGGREGATES
+    // ============================================
+
+    // Maintain aggregates at these resolutions (in ticks, e.g. {5, 10, 50}) from now on, built from the resting levels
+    void set_bucket_resolutions(const std::vector<int64_t>& resolutions) override
+    {
+        m_bucket_views.clear();
+        for (int64_t ticks : resolutions)
+        {
+            if (ticks <= 0 || bucket_view(ticks)) continue;
+
+            m_bucket_views.push_back(std::make_unique<BucketView>());
+            m_bucket_views.back()->ticks = ticks;
+        }
+        m_level_tracking = !m_bucket_views.empty() || m_level_callback || m_signal_levels;
+
+        for (bool is_bid : {true, false})
+        {
+            for_each_level_tick(is_bid, SIZE_MAX, [&](int64_t tick, const Level& level)
+            {
+                buckets_add(is_bid, tick, level.total_size, level.queue.size());
+            });
+        }
+    }
+
+    inline bool has_bucket_resolution(int64_t bucket_ticks) const { return bucket_view(bucket_ticks) != nullptr; }
+
+    // Best `max_buckets` non-empty buckets of a side (best → worst). A maintained resolution costs one lookup and one
+    // jump to the next occupied level per bucket, whatever the bucket holds; any other one sums the levels on the way.
+    // False (and an empty side) when a maintained resolution has no bucket for an occupied level
+    bool get_buckets(bool is_bid, int64_t bucket_ticks, size_t max_buckets, std::vector<BucketEntry>& out) const
+    {
+        out.clear();
+        if (bucket_ticks <= 0) return true;
+
+        const BucketView* view = bucket_view(bucket_ticks);
+        const FlatHashMap<int64_t, BucketTotals>* totals = view ? (is_bid ? &view->bids : &view->asks) : nullptr;
+
+        int64_t tick = 0;
+        const Level* level = best_level(is_bid, tick);
+        while (level)
+        {
+            int64_t first_tick = floor_div(tick, bucket_ticks) * bucket_ticks;
+            int64_t price = tick_to_price(first_tick);
+
+            if (totals)
+            {
+                if (out.size() == max_buckets) break;
+
+                const BucketTotals* bucket = totals->find(first_tick / bucket_ticks);
+                if (bucket == nullptr) [[unlikely]]
+                {
+                    out.clear();
+                    return false;
+                }
+                out.push_back(BucketEntry{price, (uint64_t)bucket->size, (uint64_t)bucket->count});
+
+                // Skip the other levels of the bucket
+                tick = is_bid ? first_tick : first_tick + bucket_ticks - 1;
+            }
+            else
+            {
+                if (out.empty() || out.back().price != price)
+                {
+                    if (out.size() == max_buckets) break;
+                    out.push_back(BucketEntry{price, 0, 0});
+                }
+                out.back().size += level->total_size;
+                out.back().count += level->queue.size();
+            }
+
+            level = next_worse_level(is_bid, tick, tick);
+        }
+        return true;
+    }
+
+    // build_snapshot() layout with `max_buckets` buckets per side, plus their order count
+    Json build_bucket_snapshot(int64_t bucket_ticks, size_t max_buckets) const override
+    {
+        Json snap;
+        std::vector<BucketEntry> entries;
+
+        for (bool is_bid : {true, false})
+        {
+            Json side;
+            if (!get_buckets(is_bid, bucket_ticks, max_buckets, entries))
+            {
+                snap["error"] = "Bucketed aggregates out of step with the book";
+            }
+            for (const BucketEntry& entry : entries)
+            {
+                side.push_back({
+                    {"price", entry.price},
+                    {"size" , entry.size},
+                    {"count", entry.count}
+                });
+            }
+            snap[is_bid ? "bids" : "asks"] = side;
+        }
+
+        snap["bucket"] = bucket_ticks;
+        snap["indexed"] = has_bucket_resolution(bucket_ticks);
+        return snap;
+    }
+
+private:
+    inline const BucketView* bucket_view(int64_t bucket_ticks) const
+    {
+        for (const auto& view : m_bucket_views)
+        {
+            if (view->ticks == bucket_ticks) return view.get();
+        }
+        return nullptr;
+    }
+
+    // A level of `tick` changed by `size` / `count` orders, empty buckets are erased
+    inline void buckets_add(bool is_bid, int64_t tick, int64_t size, int64_t count)
+    {
+        for (auto& view : m_bucket_views)
+        {
+            FlatHashMap<int64_t, BucketTotals>& totals = is_bid ? view->bids : view->asks;
+            int64_t bucket = floor_div(tick, view->ticks);
+
+            BucketTotals& entry = totals[bucket];
+            entry.size += size;
+            entry.count += count;
+            if (entry.count == 0)
+            {
+                totals.erase(bucket);
+            }
+        }
+    }
+
+    // Every change of a level's size / order count goes through here
+    inline void level_changed(bool is_bid, int64_t tick, int64_t size, int64_t count)
+    {
+        buckets_add(is_bid, tick, size, count);
+        if (m_signal_levels) signals_level_changed(is_bid, tick, size);
+        if (m_level_callback)
+        {
+            m_level_callback(is_bid, tick, size, count);
+        }
+    }
+
+public:
+    // ============================================
+    // LEVEL CHANGES
+    // ============================================
+
+    // `callback(is_bid, tick, size, count)` receives every resting level right away, then the size / order count
+    // delta of each level change (a level is gone once its count is back to 0). nullptr = none
+    void set_level_callback(LevelCallback callback) override
+    {
+        m_level_callback = std::move(callback);
+        m_level_tracking = !m_bucket_views.empty() || m_level_callback || m_signal_levels;
+        if (!m_level_callback) return;
+
+        for (bool is_bid : {true, false})
+        {
+            for_each_level_tick(is_bid, SIZE_MAX, [&](int64_t tick, const Level& level)
+            {
+                m_level_callback(is_bid, tick, level.total_size, level.queue.size());
+            });
+        }
+    }
+
+public:
+    // ============================================
+    // CHECKPOINT
+    // ============================================
+
+    // Fixed-size header followed by `order_count` CheckpointOrder entries: levels best → worst per side (bids first),
+    // the orders of a level in FIFO order. Loading links them back in the same order, so queue priority is kept.
+    struct CheckpointHeader
+    {
+        uint64_t magic;
+        int64_t  tick_size;
+        uint64_t num_levels;
+        int64_t  base_tick;
+        uint64_t last_ts_recv;
+        uint64_t order_count;
+    };
+
+    struct CheckpointOrder
+    {
+        uint64_t order_id;
+        int64_t  price;
+        uint32_t size;
+        uint32_t is_bid;
+    };
+
+    static constexpr uint64_t CHECKPOINT_MAGIC = 0x314b4f4f424f424dULL;    // "MBOBOOK1"
+
+    // Appends the full book state to `out`
+    void save_checkpoint(std::vector<char>& out) const override
+    {
+        size_t header_pos = out.size();
+        out.resize(header_pos + sizeof(CheckpointHeader) + m_orders_ref.size() * sizeof(CheckpointOrder));
+
+        uint64_t order_count = 0;
+        char* entries = out.data() + header_pos + sizeof(CheckpointHeader);
+        for (bool is_bid : {true, false})
+        {
+            for_each_level_tick(is_bid, SIZE_MAX, [&](int64_t, const Level& level)
+            {
+                for (const Order& order : level.queue)
+                {
+                    CheckpointOrder entry{order.order_id, order.price, order.size, order.is_bid};
+                    std::memcpy(entries + order_count * sizeof(CheckpointOrder), &entry, sizeof(entry));
+                    ++order_count;
+                }
+            });
+        }
+
+        out.resize(header_pos + sizeof(CheckpointHeader) + order_count * sizeof(CheckpointOrder));
+
+        CheckpointHeader header{CHECKPOINT_MAGIC, tick_size(), num_levels(), base_tick(), m_last_ts_recv, order_count};
+        std::memcpy(out.data() + header_pos, &header, sizeof(header));
+    }
+
+    // Replaces the book with a checkpoint of a book with the same tick size and window, and moves `pos` past it.
+    // False (book left empty) when the data is truncated or was written by a different book layout.
+    bool load_checkpoint(const char*& pos, const char* end) override
+    {
+        clear();
+
+        CheckpointHeader header;
+        if ((size_t)(end - pos) < sizeof(header)) return false;
+        std::memcpy(&header, pos, sizeof(header));
+
+        if (header.magic != CHECKPOINT_MAGIC || header.tick_size != tick_size() || header.num_levels != num_levels()) return false;
+        if ((size_t)(end - pos) - sizeof(header) < header.order_count * sizeof(CheckpointOrder)) return false;
+        if (header.base_tick != base_tick())
+        {
+            if (!recentering()) return false;
+            m_base_tick = header.base_tick;     // a re-centering window resumes where it was
+        }
+
+        // One bulk copy into an aligned array, then the nodes are linked in file order
+        std::vector<CheckpointOrder> orders(header.order_count);
+        std::memcpy(orders.data(), pos + sizeof(header), orders.size() * sizeof(CheckpointOrder));
+        pos += sizeof(header) + orders.size() * sizeof(CheckpointOrder);
+
+        m_orders_ref.reserve(orders.size());
+        m_order_pool.reserve(orders.size());
+        for (const CheckpointOrder& entry : orders)
+        {
+            restore_order(entry);
+        }
+
+        m_last_ts_recv = header.last_ts_recv;
+        rebuild_depth_cache();
+        return true;
+    }
+
+    // add() without the depth cache (rebuilt once at the end) and without re-centering (the window was saved)
+    inline void restore_order(const CheckpointOrder& entry)
+    {
+        bool is_bid = entry.is_bid != 0;
+        int64_t tick = price_to_tick(entry.price);
+        Level& level = level_at(is_bid, tick);
+
+        if (level.empty())
+        {
+            on_level_filled(is_bid, tick);
+        }
+
+        Order* order = m_order_pool.acquire(entry.order_id, entry.price, tick, entry.size, is_bid);
+        level.queue.push_back(order);
+        level.total_size += entry.size;
+        if (m_queue_positions) [[unlikely]] queue_index_push(level, order);
+        if (m_level_tracking) [[unlikely]] level_changed(is_bid, tick, entry.size, 1);
+
+        m_orders_ref.insert_or_assign(entry.order_id, order);
+    }
+
+    // ============================================
+    // LADDER RE-CENTERING
+    // ============================================
+
+    // Re-center once the mid leaves the middle half of the window.
+    // Only called when an order lands in the overflow levels, so the in-window hot path pays nothing.
+    void maybe_recenter()
+    {
+        int64_t bid_tick = 0, ask_tick = 0;
+        const Level* bid = best_level(true, bid_tick);
+        const Level* ask = best_level(false, ask_tick);
+        if (!bid && !ask) return;
+
+        int64_t mid = (bid && ask) ? floor_div(bid_tick + ask_tick, 2) : (bid ? bid_tick : ask_tick);
+        int64_t offset = mid - base_tick();
+        int64_t quarter = (int64_t)num_levels() / 4;
+        if (offset >= quarter && offset < (int64_t)num_levels() - quarter) return;
+
+        recenter(mid - (int64_t)num_levels() / 2);
+    }
+
+    void recenter(int64_t new_base_tick)
+    {
+        recenter_side(m_bids, m_bid_overflow, m_bid_bitmap, new_base_tick);
+        recenter_side(m_asks, m_ask_overflow, m_ask_bitmap, new_base_tick);
+        m_base_tick = new_base_tick;
+
+        size_t npos = HierarchicalBitmap::npos;
+        size_t bid_lo = m_bid_bitmap.next(0), bid_hi = m_bid_bitmap.prev(num_levels() - 1);
+        size_t ask_lo = m_ask_bitmap.next(0), ask_hi = m_ask_bitmap.prev(num_levels() - 1);
+
+        reset_ranges();
+        if (bid_lo != npos) m_bid_range = LevelRange{(int64_t)bid_lo, (int64_t)bid_hi};
+        if (ask_lo != npos) m_ask_range = LevelRange{(int64_t)ask_lo, (int64_t)ask_hi};
+
+        // Levels moved between the window and the overflow maps
+        rebuild_depth_cache();
+    }
+
+    // Park every occupied window level in the overflow map, then pull back the ones inside the new window.
+    // Levels are moved as a whole (queue head/tail), orders keep their absolute tick so nothing else changes.
+    void recenter_side(std::vector<Level>& levels, std::map<int64_t, Level>& overflow, HierarchicalBitmap& bitmap, int64_t new_base_tick)
+    {
+        for (size_t idx = bitmap.next(0); idx != HierarchicalBitmap::npos; idx = bitmap.next(idx + 1))
+        {
+            overflow.emplace(base_tick() + (int64_t)idx, std::move(levels[idx]));
+            levels[idx] = Level{};
+        }
+        bitmap.clear();
+
+        int64_t new_end = new_base_tick + (int64_t)num_levels();
+        for (auto it = overflow.lower_bound(new_base_tick); it != overflow.end() && it->first < new_end; )
+        {
+            size_t idx = it->first - new_base_tick;
+            levels[idx] = std::move(it->second);
+            bitmap.set(idx);
+            it = overflow.erase(it);
+        }
+    }
+
+    // ============================================
+    // BEST BID / BEST ASK
+    // ============================================
+
+    // Best level of a side across window and overflow, nullptr when the side is empty
+    const Level* best_level(bool is_bid, int64_t& tick) const override
+    {
+        const std::map<int64_t, Level>& overflow = is_bid ? m_bid_overflow : m_ask_overflow;
+        const LevelRange& range = is_bid ? m_bid_range : m_ask_range;
+
+        if (is_bid)
+        {
+            // Overflow above the window beats anything inside it
+            if (!overflow.empty() && overflow.rbegin()->first >= base_tick() + (int64_t)num_levels())
+            {
+                tick = overflow.rbegin()->first;
+                return &overflow.rbegin()->second;
+            }
+            if (!range.empty())
+            {
+                tick = base_tick() + range.hi;
+                return &m_bids[range.hi];
+            }
+            if (!overflow.empty())
+            {
+                tick = overflow.rbegin()->first;
+                return &overflow.rbegin()->second;
+            }
+        }
+        else
+        {
+            // Overflow below the window beats anything inside it
+            if (!overflow.empty() && overflow.begin()->first < base_tick())
+            {
+                tick = overflow.begin()->first;
+                return &overflow.begin()->second;
+            }
+            if (!range.empty())
+            {
+                tick = base_tick() + range.lo;
+                return &m_asks[range.lo];
+            }
+            if (!overflow.empty())
+            {
+                tick = overflow.begin()->first;
+                return &overflow.begin()->second;
             }
         }
+        return nullptr;
+    }
+
+    std::optional<std::pair<int64_t,uint64_t>> best_bid() const override
+    {
+        int64_t tick = 0;
+        const Level* level = best_level(true, tick);
+        if (level == nullptr) return std::nullopt;
+
+        return std::make_pair(tick_to_price(tick), level->total_size);
+    }
+
+    std::optional<std::pair<int64_t,uint64_t>> best_ask() const override
+    {
+        int64_t tick = 0;
+        const Level* level = best_level(false, tick);
+        if (level == nullptr) return std::nullopt;
+
+        return std::make_pair(tick_to_price(tick), level->total_size);
+    }
+
+    // ============================================
+
+    const Level& get_level(bool is_bid, size_t idx) const
+    {
+        return is_bid ? m_bids[idx] : m_asks[idx];
+    }
+
+    // ============================================
+
+    static inline void copy_cached_depth(const DepthCache& cache, size_t levels, std::vector<DepthEntry>& out)
+    {
+        size_t count = std::min(levels, cache.count);
+        out.resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            out[i] = DepthEntry{cache.entries[i].price, cache.entries[i].level->total_size};
+        }
+    }
+
+    DepthSnapshot get_depth(int levels) const override
+    {
+        DepthSnapshot out;
+
+        // Served straight from the top-N cache
+        if (levels >= 0 && (size_t)levels <= m_depth_cache_levels)
+        {
+            copy_cached_depth(m_bid_depth, levels, out.bids);
+            copy_cached_depth(m_ask_depth, levels, out.asks);
+            return out;
+        }
+
+        out.bids.reserve(levels);
+        out.asks.reserve(levels);
 
-        // ----------- ASKS (low → high) --------------
+        // -------------------- BIDS (descending) --------------------
+        for_each_level(true, levels, [&](int64_t price, const Level& level)
+        {
+            out.bids.push_back({price, level.total_size});
+        });
+
+        // -------------------- ASKS (ascending) --------------------
+        for_each_level(false, levels, [&](int64_t price, const Level& level)
+        {
+            out.asks.push_back({price, level.total_size});
+        });
+
+        return out;
+    }
+
+    // ============================================
+    // FULL BOOK SNAPSHOT
+    // ============================================
+
+    // Up to `max_levels` per side, from the top-N cache when it holds that many
+    Json build_snapshot(size_t max_levels = SIZE_MAX) const override
+    {
+        Json snap;
+        Json bids;
         Json asks;
-        for (size_t i = 0; i < m_num_levels; ++i)
+
+        auto push_level = [](Json& side, int64_t price, uint64_t size)
+        {
+            side.push_back({
+                {"price", price},
+                {"size" , size}
+            });
+        };
+
+        if (max_levels <= m_depth_cache_levels)
         {
-            const Level& lvl = m_asks[i];
-            if (!lvl.empty())
+            // ----------- BIDS (high → low) --------------
+            for (size_t i = 0; i < std::min(max_levels, m_bid_depth.count); ++i)
             {
-                int64_t price = m_price_min + i * m_tick_size;
-                asks.push_back({
-                    {"price", price},
-                    {"size" , lvl.total_size}
-                });
+                push_level(bids, m_bid_depth.entries[i].price, m_bid_depth.entries[i].level->total_size);
+            }
+
+            // ----------- ASKS (low → high) --------------
+            for (size_t i = 0; i < std::min(max_levels, m_ask_depth.count); ++i)
+            {
+                push_level(asks, m_ask_depth.entries[i].price, m_ask_depth.entries[i].level->total_size);
             }
         }
+        else
+        {
+            // ----------- BIDS (high → low) --------------
+            for_each_level(true, max_levels, [&](int64_t price, const Level& lvl)
+            {
+                push_level(bids, price, lvl.total_size);
+            });
+
+            // ----------- ASKS (low → high) --------------
+            for_each_level(false, max_levels, [&](int64_t price, const Level& lvl)
+            {
+                push_level(asks, price, lvl.total_size);
+            });
+        }
 
         snap["bids"] = bids;
         snap["asks"] = asks;
@@ -403,116 +2039,218 @@ public:
     }
 
     // ===========================================
-    // Builld MbpMsg10
+    // MBP-10 RECORDS
     // ===========================================
-    Json build_mbp_msg10_from_mbo_msg(const databento::MboMsg& mbo_msg) const
+
+    // `callback` gets a binary MBP-10 record after every event that touched one of the top 10 levels of a side
+    // (so every event that changed them), and after every trade. With event batching: at most one per event, on its F_LAST message
+    void set_mbp10_callback(Mbp10Callback callback) override
+    {
+        m_mbp10_callback = std::move(callback);
+    }
+
+    // Top 10 levels per side (best → worst), missing levels have an undefined price and zero size/count
+    void fill_bid_ask_pairs(BidAskPairs& levels) const
+    {
+        if (m_depth_cache_levels >= MBP10_LEVELS) [[likely]]
+        {
+            size_t bid_count = std::min(MBP10_LEVELS, m_bid_depth.count);
+            size_t ask_count = std::min(MBP10_LEVELS, m_ask_depth.count);
+            for (size_t i = 0; i < MBP10_LEVELS; ++i)
+            {
+                if (i < bid_count) set_bid(levels[i], m_bid_depth.entries[i].price, *m_bid_depth.entries[i].level);
+                else               clear_bid(levels[i]);
+
+                if (i < ask_count) set_ask(levels[i], m_ask_depth.entries[i].price, *m_ask_depth.entries[i].level);
+                else               clear_ask(levels[i]);
+            }
+            return;
+        }
+
+        // Depth cache configured below 10 levels: walk the ladder
+        size_t bid_count = 0;
+        for_each_level(true, MBP10_LEVELS, [&](int64_t price, const Level& level)
+        {
+            set_bid(levels[bid_count++], price, level);
+        });
+        size_t ask_count = 0;
+        for_each_level(false, MBP10_LEVELS, [&](int64_t price, const Level& level)
+        {
+            set_ask(levels[ask_count++], price, level);
+        });
+
+        for (size_t i = bid_count; i < MBP10_LEVELS; ++i) clear_bid(levels[i]);
+        for (size_t i = ask_count; i < MBP10_LEVELS; ++i) clear_ask(levels[i]);
+    }
+
+    // MBP-10 record for `mbo` against the current book (call it after applying `mbo`)
+    void fill_mbp10(const databento::MboMsg& mbo, databento::Mbp10Msg& out) const
+    {
+        fill_bid_ask_pairs(out.levels);
+        fill_mbp10_header(mbo, out);
+    }
+
+    // Json view of a record, only built on demand
+    static Json mbp10_to_json(const databento::Mbp10Msg& msg)
     {
-        Json bid_ask_pairs = build_bid_ask_pairs();
+        Json levels;
+        for (const databento::BidAskPair& pair : msg.levels)
+        {
+            levels.push_back({
+                {"bid_px", pair.bid_px},
+                {"bid_sz", pair.bid_sz},
+                {"bid_ct", pair.bid_ct},
+                {"ask_px", pair.ask_px},
+                {"ask_sz", pair.ask_sz},
+                {"ask_ct", pair.ask_ct}
+            });
+        }
 
         Json mbp10_msg = {
             {"hd", {
-                {"rtype", mbo_msg.hd.rtype},
-                {"ts_event", mbo_msg.hd.ts_event.time_since_epoch().count()},
-                {"instrument_id", mbo_msg.hd.instrument_id},
-                {"publisher_id", mbo_msg.hd.publisher_id},
-                {"length", mbo_msg.hd.length}
+                {"rtype", msg.hd.rtype},
+                {"ts_event", msg.hd.ts_event.time_since_epoch().count()},
+                {"instrument_id", msg.hd.instrument_id},
+                {"publisher_id", msg.hd.publisher_id},
+                {"length", msg.hd.length}
             }},
-            {"price", mbo_msg.price},
-            {"size", mbo_msg.size},
-            {"action", mbo_msg.action},
-            {"side", mbo_msg.side},
-            {"flags", mbo_msg.flags.Raw()},
-            {"depth", bid_ask_pairs["num_levels"]},
-            {"ts_recv", mbo_msg.ts_recv.time_since_epoch().count()},
-            {"ts_in_delta", mbo_msg.ts_in_delta.count()},
-            {"sequence", mbo_msg.sequence},
-            {"levels", bid_ask_pairs["bid_ask_pairs"]}
+            {"price", msg.price},
+            {"size", msg.size},
+            {"action", msg.action},
+            {"side", msg.side},
+            {"flags", msg.flags.Raw()},
+            {"depth", msg.depth},
+            {"ts_recv", msg.ts_recv.time_since_epoch().count()},
+            {"ts_in_delta", msg.ts_in_delta.count()},
+            {"sequence", msg.sequence},
+            {"levels", levels}
         };
 
         return mbp10_msg;
     }
 
-    Json build_bid_ask_pairs() const
+    Json build_mbp_msg10_from_mbo_msg(const databento::MboMsg& mbo_msg) const
     {
-        static int count = 0;
-        LevelByPrice bid_levels[2000];
-        LevelByPrice ask_levels[2000];
-        size_t bid_count = 0;
-        size_t ask_count = 0;
+        databento::Mbp10Msg msg;
+        fill_mbp10(mbo_msg, msg);
+        return mbp10_to_json(msg);
+    }
 
-        // ----------- BIDS (high → low) --------------
-        for (int i = (int)m_num_levels - 1; i >= 0; --i)
-        {
-            const Level& lvl = m_bids[i];
-            if (!lvl.empty() && lvl.total_size > 0)
-            {
-                int64_t price = m_price_min + i * m_tick_size;
-                bid_levels[bid_count++] = LevelByPrice{price, (Level*)&lvl};
-            }
-        }
+private:
+    static inline void set_bid(databento::BidAskPair& pair, int64_t price, const Level& level)
+    {
+        pair.bid_px = price;
+        pair.bid_sz = (uint32_t)level.total_size;
+        pair.bid_ct = (uint32_t)level.queue.size();
+    }
+
+    static inline void set_ask(databento::BidAskPair& pair, int64_t price, const Level& level)
+    {
+        pair.ask_px = price;
+        pair.ask_sz = (uint32_t)level.total_size;
+        pair.ask_ct = (uint32_t)level.queue.size();
+    }
+
+    // Missing level: undefined price, zero size and count
+    static inline void clear_bid(databento::BidAskPair& pair)
+    {
+        pair.bid_px = databento::kUndefPrice;
+        pair.bid_sz = 0;
+        pair.bid_ct = 0;
+    }
+
+    static inline void clear_ask(databento::BidAskPair& pair)
+    {
+        pair.ask_px = databento::kUndefPrice;
+        pair.ask_sz = 0;
+        pair.ask_ct = 0;
+    }
+
+    // Everything but the levels, which must already be filled (depth is read from them)
+    static inline void fill_mbp10_header(const databento::MboMsg& mbo, databento::Mbp10Msg& out)
+    {
+        out.hd = mbo.hd;
+        out.hd.rtype = databento::RType::Mbp10;
+        out.hd.length = (uint8_t)(sizeof(databento::Mbp10Msg) / databento::RecordHeader::kLengthMultiplier);
+        out.price = mbo.price;
+        out.size = mbo.size;
+        out.action = mbo.action;
+        out.side = mbo.side;
+        out.flags = mbo.flags;
+        out.depth = mbp10_depth(out.levels, mbo);
+        out.ts_recv = mbo.ts_recv;
+        out.ts_in_delta = mbo.ts_in_delta;
+        out.sequence = mbo.sequence;
+    }
+
+    // Book level of the event: where its price is, or would be, among the top 10 of its side
+    static inline uint8_t mbp10_depth(const BidAskPairs& levels, const databento::MboMsg& mbo)
+    {
+        char side = (char)mbo.side;
+        if (side != 'A' && side != 'B') return 0;
 
-        // ----------- ASKS (low → high) --------------
-        for (size_t i = 0; i < m_num_levels; ++i)
+        bool is_bid = (side == 'B');
+        for (uint8_t i = 0; i < MBP10_LEVELS; ++i)
         {
-            const Level& lvl = m_asks[i];
-            if (!lvl.empty() && lvl.total_size > 0)
+            int64_t px = is_bid ? levels[i].bid_px : levels[i].ask_px;
+            if (px == databento::kUndefPrice || (is_bid ? px <= mbo.price : px >= mbo.price))
             {
-                int64_t price = m_price_min + i * m_tick_size;
-                ask_levels[ask_count++] = LevelByPrice{price, (Level*)&lvl};
+                return i;
             }
         }
+        return MBP10_LEVELS - 1;
+    }
 
-        int max_count = std::max(bid_count, ask_count);
+    // An event can only change the top 10 of a side through a level that is among them before or after it:
+    // the resting order's level is checked against the top 10 before applying, the added level after.
+    // Only then the record is built (10 pairs read through the depth cache pointers). Trades always produce a record.
+    void apply_with_mbp10(const databento::MboMsg& mbo)
+    {
+        char action = (char)mbo.action;
+        char side   = (char)mbo.side;
+        bool touched = (action == 'T' || action == 'R');
 
-        // Build bid-ask pairs
-        Json bid_ask_pairs;
-        for (size_t i = 0; i < max_count; ++i)
+        if (!touched && action != 'A')
         {
-            Json pair;
+            const Ref* ref = m_orders_ref.find(mbo.order_id);
+            touched = ref && in_mbp10_levels((*ref)->is_bid, (*ref)->price);
+        }
 
-            // Bid
-            if (i < bid_count)
-            {
-                pair["bid_px"] = bid_levels[i].price;
-                pair["bid_sz"] = bid_levels[i].level->total_size;
-                pair["bid_ct"] = bid_levels[i].level->queue.size();
-            }
-            else
-            {
-                pair["bid_px"] = 0;
-                pair["bid_sz"] = 0;
-                pair["bid_ct"] = 0;
-            }
+        apply_event(mbo);
 
-            // Ask
-            if (i < ask_count)
-            {
-                pair["ask_px"] = ask_levels[i].price;
-                pair["ask_sz"] = ask_levels[i].level->total_size;
-                pair["ask_ct"] = ask_levels[i].level->queue.size();
-            }
-            else
-            {
-                pair["ask_px"] = 0;
-                pair["ask_sz"] = 0;
-                pair["ask_ct"] = 0;
-            }
+        if (!touched && (action == 'A' || action == 'M') && (side == 'A' || side == 'B'))
+        {
+            touched = in_mbp10_levels(side == 'B', mbo.price);
+        }
 
-            if (i >= max_count)
-            {
-                break;
-            }
+        // Event batching: one record for the whole event, on its last message
+        if (m_event_batching)
+        {
+            m_mbp10_touched |= touched;
+            if (!mbo.flags.IsLast()) return;
 
-            bid_ask_pairs.push_back(pair);
+            touched = m_mbp10_touched;
+            m_mbp10_touched = false;
+        }
 
+        if (touched)
+        {
+            fill_mbp10(mbo, m_mbp10);
+            m_mbp10_callback(m_mbp10);
         }
+    }
 
-        return {
-            {"bid_ask_pairs", bid_ask_pairs},
-            {"num_levels", std::max(bid_count, ask_count)}
-        };
+    // Whether a level at `price` is (or would be) one of the top 10 of its side
+    inline bool in_mbp10_levels(bool is_bid, int64_t price) const
+    {
+        const DepthCache& cache = is_bid ? m_bid_depth : m_ask_depth;
+        if (m_depth_cache_levels < MBP10_LEVELS || cache.count < MBP10_LEVELS) return true;
+
+        int64_t last = cache.entries[MBP10_LEVELS - 1].price;
+        return is_bid ? price >= last : price <= last;
     }
 
+public:
     Task<void> get_mbp_msg_from_mbo_msg_async(Future<Json>::FutureValue* future_value, const databento::MboMsg& mbo_msg)
     {
         Json data = build_mbp_msg10_from_mbo_msg(mbo_msg);
@@ -532,10 +2270,56 @@ public:
 
     // ============================================
 
-    void clear()
+    // Cost follows the occupied levels, not the ladder: only levels flagged in the bitmaps hold orders,
+    // the order index and the pool are dropped in O(1) and keep their memory
+    void clear() override
     {
-        for (auto& lvl : m_bids) lvl = Level{};
-        for (auto& lvl : m_asks) lvl = Level{};
+        if (m_level_callback) [[unlikely]]
+        {
+            for (bool is_bid : {true, false})
+            {
+                for_each_level_tick(is_bid, SIZE_MAX, [&](int64_t tick, const Level& level)
+                {
+                    m_level_callback(is_bid, tick, -(int64_t)level.total_size, -(int64_t)level.queue.size());
+                });
+            }
+        }
+
+        m_bid_bitmap.for_each_set([&](size_t idx) { reset_level(m_bids[idx]); });
+        m_ask_bitmap.for_each_set([&](size_t idx) { reset_level(m_asks[idx]); });
+        m_bid_overflow.clear();
+        m_ask_overflow.clear();
+        m_bid_bitmap.clear();
+        m_ask_bitmap.clear();
         m_orders_ref.clear();
+        m_order_pool.reset();
+        for (auto& view : m_bucket_views)
+        {
+            view->bids.clear();
+            view->asks.clear();
+        }
+        reset_ranges();
+        m_bid_depth.count = 0;
+        m_ask_depth.count = 0;
+        m_signal_bid_rescan = true;
+        m_signal_ask_rescan = true;
+        m_last_ts_recv = 0;
+        m_event_open = false;
+        m_mbp10_touched = false;
+    }
+
+private:
+    // Empty the level, its queue-position index is kept for reuse
+    static inline void reset_level(Level& level)
+    {
+        level.queue = OrderQueue{};
+        level.total_size = 0;
+        if (level.queue_index)
+        {
+            level.queue_index->tree.reset(level.queue_index->tree.size());
+            level.queue_index->next_slot = 0;
+        }
     }
 };
+
+using OrderBook = BasicOrderBook<RuntimeBookConfig>;
\ No newline at end of file
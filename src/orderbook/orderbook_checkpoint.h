@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <spdlog/spdlog.h>
+
+#include <orderbook/orderbook_registry.h>
+
+// Checkpoint file: position of the replay in the DBN file, then the registry (every book, orders in FIFO order).
+// Resuming loads the books and skips the MBO records already applied, instead of replaying them.
+class OrderBookCheckpoint
+{
+public:
+    struct StreamPosition
+    {
+        uint64_t record_index = 0;      // MBO records of the DBN file already applied
+        uint64_t last_ts_recv = 0;      // ts_recv and sequence of the last of them, checked when skipping
+        uint32_t last_sequence = 0;
+        uint64_t last_offset = NO_OFFSET;   // DBN stream offset of that last record (single file), resuming seeks there
+    };
+
+    static constexpr uint64_t NO_OFFSET = UINT64_MAX;
+    static constexpr uint64_t FILE_MAGIC = 0x3354504b43424f4dULL;   // "MOBCKPT3" (books keyed by instrument and publisher
+                                                                    // since v2, offset of the last record since v3)
+
+    // Written to "<path>.tmp" then renamed, a crash never leaves a half written checkpoint behind
+    static bool save(const std::string& path, const OrderBookRegistry& books, const StreamPosition& position)
+    {
+        std::vector<char> data;
+        data.reserve(1 << 20);
+
+        FileHeader header{FILE_MAGIC, position.record_index, position.last_ts_recv, position.last_sequence, 0, position.last_offset};
+        data.resize(sizeof(header));
+        std::memcpy(data.data(), &header, sizeof(header));
+        books.save_checkpoint(data);
+
+        std::string tmp_path = path + ".tmp";
+        FILE* file = std::fopen(tmp_path.c_str(), "wb");
+        if (file == nullptr)
+        {
+            spdlog::error("Cannot open checkpoint file: {}", tmp_path);
+            return false;
+        }
+
+        bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+        ok = (std::fclose(file) == 0) && ok;
+        if (!ok || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+        {
+            spdlog::error("Cannot write checkpoint file: {}", path);
+            return false;
+        }
+        return true;
+    }
+
+    // Into an empty registry. False when the file is missing, truncated or does not fit the books of the registry
+    static bool load(const std::string& path, OrderBookRegistry& books, StreamPosition& position)
+    {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (file == nullptr)
+        {
+            spdlog::error("Cannot open checkpoint file: {}", path);
+            return false;
+        }
+
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
+
+        std::vector<char> data(size > 0 ? size : 0);
+        bool ok = std::fread(data.data(), 1, data.size(), file) == data.size();
+        std::fclose(file);
+
+        FileHeader header;
+        if (!ok || data.size() < sizeof(header))
+        {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        if (header.magic != FILE_MAGIC)
+        {
+            return false;
+        }
+
+        const char* pos = data.data() + sizeof(header);
+        if (!books.load_checkpoint(pos, data.data() + data.size()))
+        {
+            return false;
+        }
+
+        position = StreamPosition{header.record_index, header.last_ts_recv, header.last_sequence, header.last_offset};
+        return true;
+    }
+
+private:
+    struct FileHeader
+    {
+        uint64_t magic;
+        uint64_t record_index;
+        uint64_t last_ts_recv;
+        uint32_t last_sequence;
+        uint32_t reserved;
+        uint64_t last_offset;
+    };
+};
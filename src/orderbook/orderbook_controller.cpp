@@ -1,22 +1,347 @@
 #include <orderbook/orderbook_controller.h>
 
-void OrderBookController::initialize(const std::string& dbn_file_path)
+OrderBookRegistry::BookFactory OrderBookController::make_book_factory(EventBase* book_event_base, const std::string& product)
 {
-    // For now hardcode order book parameters and DBN file path (but in reality should be from args)
-    m_order_book = std::make_unique<OrderBook>(
-        20000000LL,    // min price
-        120000000000LL,   // max price
-        10000000LL,        // tick = 10e6
-        event_base
-    );
-    m_dbn_wrapper = std::make_unique<DbnWrapper>(dbn_file_path);
+    // A known product gets its compile-time configured book, anything else a runtime book
+    return [book_event_base, product](uint32_t) -> std::unique_ptr<OrderBookBase>
+    {
+        if (std::unique_ptr<OrderBookBase> book = make_product_book(product, book_event_base))
+        {
+            return book;
+        }
+
+        // For now hardcode order book parameters (but in reality should be from args)
+        return std::make_unique<OrderBook>(
+            4096,               // dense levels kept around the mid, re-centered when the market drifts
+            10000000LL,         // tick = 10e6
+            book_event_base
+        );
+    };
+}
+
+Mbp10Writer* OrderBookController::make_mbp10_writer(const std::string& path)
+{
+    if (path.empty()) return nullptr;
+
+    m_mbp10_writers.push_back(std::make_unique<Mbp10Writer>(path));
+    return m_mbp10_writers.back().get();
+}
+
+void OrderBookController::configure_registry(OrderBookRegistry& books, Mbp10Writer* mbp10_writer) const
+{
+    books.set_event_batching(m_options.event_batching);
+    books.set_queue_positions(m_options.queue_positions);
+    books.set_bucket_resolutions(m_options.bucket_resolutions);
+    books.set_venue_books(m_options.venue_books);
+    books.set_mbp10_writer(mbp10_writer);
+    books.set_signal_levels(m_options.signal_levels);
+    books.set_signals_callback(make_signals_callback());
+}
+
+OrderBookRegistry::SignalsCallback OrderBookController::make_signals_callback() const
+{
+    if (m_options.signal_levels == 0 || m_signals_subscribers.empty())
+    {
+        return nullptr;
+    }
+
+    return [this](uint32_t instrument_id, uint16_t publisher_id, const OrderBook::Signals& signals)
+    {
+        for (const SignalsSubscriber& subscriber : m_signals_subscribers)
+        {
+            subscriber(instrument_id, publisher_id, signals);
+        }
+    };
+}
+
+void OrderBookController::subscribe_signals(SignalsSubscriber subscriber)
+{
+    m_signals_subscribers.push_back(std::move(subscriber));
+}
+
+void OrderBookController::add_signals(Json& snapshot, const OrderBookBase& order_book) const
+{
+    if (m_options.signal_levels == 0) return;
+
+    OrderBook::Signals signals;
+    if (order_book.read_signals(signals))
+    {
+        snapshot["signals"] = OrderBook::signals_to_json(signals);
+    }
+}
+
+void OrderBookController::resume_from_checkpoint()
+{
+    const std::string& checkpoint_path = m_options.checkpoint_path;
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    // An index built earlier (e.g. by a seek) saves the scan up to the checkpoint position
+    DbnSeekIndex index;
+    bool indexed = m_dbn_file_paths.size() == 1 && index.load(DbnSeekIndex::path_for(m_dbn_file_paths.front()), m_dbn_file_paths.front());
+
+    OrderBookCheckpoint::StreamPosition position;
+    if (OrderBookCheckpoint::load(checkpoint_path, *m_books, position) && skip_to(position, indexed ? &index : nullptr))
+    {
+        m_stream_position = position;
+        if (!m_books->empty())
+        {
+            m_first_instrument_id.store(m_books->instrument_id_of(0), std::memory_order_release);
+        }
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        spdlog::info("Resumed from checkpoint {}: {} books, {} records skipped, in {:.2f} ms", checkpoint_path, m_books->size(), position.record_index, ms);
+        return;
+    }
+
+    // Partially loaded books and a partially read file: start over
+    spdlog::error("Cannot resume from checkpoint {}, replaying from the start", checkpoint_path);
+    m_books->reset();
+    m_dbn_wrapper = std::make_unique<DbnWrapper>(m_dbn_file_paths);
+}
+
+bool OrderBookController::skip_to(const OrderBookCheckpoint::StreamPosition& position, const DbnSeekIndex* index)
+{
+    // Straight to the last applied record, which is still checked
+    if (position.last_offset != OrderBookCheckpoint::NO_OFFSET && position.record_index > 0 && m_dbn_file_paths.size() == 1)
+    {
+        return m_dbn_wrapper->seek(position.last_offset)
+            && m_dbn_wrapper->skip_records(1, position.last_ts_recv, position.last_sequence);
+    }
+
+    // Otherwise from the last indexed record before the position, so that the skipped ones are still checked
+    const DbnSeekIndex::Entry* entry = index && position.record_index > 0 ? index->find_record(position.record_index - 1) : nullptr;
+    if (entry == nullptr)
+    {
+        return m_dbn_wrapper->skip_records(position.record_index, position.last_ts_recv, position.last_sequence);
+    }
+
+    return m_dbn_wrapper->seek(entry->offset)
+        && m_dbn_wrapper->skip_records(position.record_index - entry->record_index, position.last_ts_recv, position.last_sequence);
+}
+
+Future<bool> OrderBookController::seek_to_start_ts()
+{
+    return Future<bool>([this](Future<bool>::FutureValue* future_value)
+    {
+        auto task = this->seek_to_start_ts_async(future_value);
+        task.start_running_on(event_base);
+    });
+}
+
+Future<bool> OrderBookController::load_seek_index(DbnSeekIndex& index)
+{
+    return Future<bool>([this, &index](Future<bool>::FutureValue* future_value)
+    {
+        auto task = this->load_seek_index_async(future_value, index);
+        task.start_running_on(EventBaseManager::get_event_base_by_id(EventBaseID::DBN_READER));
+    });
+}
+
+Task<void> OrderBookController::load_seek_index_async(Future<bool>::FutureValue* future_value, DbnSeekIndex& index)
+{
+    future_value->set_value(index.load_or_build(m_dbn_file_paths.front()));
+    co_return;
+}
+
+Future<bool> OrderBookController::yield()
+{
+    return Future<bool>([](Future<bool>::FutureValue* future_value)
+    {
+        future_value->set_value(true);
+    });
+}
+
+Task<void> OrderBookController::seek_to_start_ts_async(Future<bool>::FutureValue* future_value)
+{
+    const std::string& dbn_file_path = m_dbn_file_paths.front();
+    uint64_t start_ts_recv = m_options.start_ts_recv;
+
+    auto t0 = std::chrono::steady_clock::now();
+
+    // Nearest reset before the start (none: the start is at or before the first record)
+    DbnSeekIndex index;
+    bool indexed = co_await load_seek_index(index);
+    if (!indexed)
+    {
+        spdlog::error("No seek index for {}, rebuilding the books from the start of the file", dbn_file_path);
+    }
+    const DbnSeekIndex::Entry* entry = indexed ? index.find_before(start_ts_recv) : nullptr;
+
+    OrderBookCheckpoint::StreamPosition from;
+    bool from_checkpoint = false;
+    if (entry)
+    {
+        from.record_index = entry->reset_record_index;
+    }
+
+    // A checkpoint taken between that reset and the start is closer
+    if (!m_options.checkpoint_path.empty())
+    {
+        OrderBookCheckpoint::StreamPosition position;
+        if (OrderBookCheckpoint::load(m_options.checkpoint_path, *m_books, position)
+            && position.record_index >= from.record_index
+            && position.last_ts_recv < start_ts_recv
+            && skip_to(position, indexed ? &index : nullptr))
+        {
+            from = position;
+            from_checkpoint = true;
+        }
+        else
+        {
+            spdlog::warn("Checkpoint {} does not precede ts_recv {}, rebuilding the books from the nearest reset", m_options.checkpoint_path, start_ts_recv);
+            m_books->reset();
+            m_dbn_wrapper = std::make_unique<DbnWrapper>(m_dbn_file_paths);
+        }
+    }
+
+    if (!from_checkpoint && entry && !m_dbn_wrapper->seek(entry->reset_offset))
+    {
+        spdlog::error("Cannot seek in {}, rebuilding the books from the start of the file", dbn_file_path);
+        m_dbn_wrapper = std::make_unique<DbnWrapper>(m_dbn_file_paths);
+        from = OrderBookCheckpoint::StreamPosition{};
+    }
+    m_stream_position = from;
+
+    // Up to the start: applied without pacing, MBP-10 output or signal callbacks, in chunks between which the
+    // snapshot and checkpoint tasks queued on GATEWAY run
+    m_books->set_mbp10_writer(nullptr);
+    m_books->set_signals_callback(nullptr);
+    auto apply_batch = [this](std::span<const databento::MboMsg> mbo_msgs)
+    {
+        m_books->apply_batch(mbo_msgs);
+        m_stream_position.record_index += mbo_msgs.size();
+        m_stream_position.last_ts_recv = mbo_msgs.back().ts_recv.time_since_epoch().count();
+        m_stream_position.last_sequence = mbo_msgs.back().sequence;
+    };
+    uint64_t replayed = 0;
+    uint64_t count;
+    while ((count = m_dbn_wrapper->fast_forward(start_ts_recv, apply_batch, SEEK_CHUNK_RECORDS)) == SEEK_CHUNK_RECORDS)
+    {
+        replayed += count;
+        co_await yield();
+    }
+    replayed += count;
+    m_books->set_mbp10_writer(m_mbp10_writers.empty() ? nullptr : m_mbp10_writers.front().get());
+    m_books->set_signals_callback(make_signals_callback());
 
-    m_dbn_file_path = dbn_file_path;
+    if (!m_books->empty())
+    {
+        m_first_instrument_id.store(m_books->instrument_id_of(0), std::memory_order_release);
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    spdlog::info("Seeked to ts_recv {}: books rebuilt from {} at record {}, {} records replayed, starting at record {}, in {:.2f} ms",
+        start_ts_recv, from_checkpoint ? "checkpoint" : "reset", m_stream_position.record_index - replayed, replayed, m_stream_position.record_index, ms);
+
+    future_value->set_value(true);
+    co_return;
+}
+
+Task<void> OrderBookController::initialize(const std::vector<std::string>& dbn_file_paths, const StreamingOptions& options)
+{
+    // Shards of a previous run must leave their drain loop before their books are reset or go away
+    for (auto& shard : m_shards)
+    {
+        co_await shard->stop();
+    }
+
+    // The books of the previous run are reset and reused when the layout and the product are the same
+    // (O(occupied levels) per book, no reallocation of the ladders and order indexes), otherwise they are dropped
+    size_t num_shards = std::min<size_t>(options.num_shards, OrderBookShard::MAX_SHARDS);
+    bool same_product = options.product == m_options.product;
+    // Dropped ones are retired, not destroyed: readers on other threads may still hold them (see PublishedDirectory)
+    if (num_shards != m_shards.size() || !same_product)
+    {
+        std::move(m_shards.begin(), m_shards.end(), std::back_inserter(m_retired_shards));
+        m_shards.clear();
+    }
+    if ((num_shards != 0 || !same_product) && m_books)
+    {
+        m_retired_books.push_back(std::move(m_books));
+    }
+
+    // Old writers are flushed and closed before a new one may open the same path
+    // (books of stopped shards still point at theirs, but apply nothing before reset() installs the new one)
+    if (m_books)
+    {
+        m_books->set_mbp10_writer(nullptr);
+    }
+    m_mbp10_writers.clear();
+    m_first_instrument_id.store(NO_INSTRUMENT, std::memory_order_relaxed);
+
+    m_options = options;
+    m_options.num_shards = num_shards;
+    if (m_options.num_shards == 0)
+    {
+        if (m_books)
+        {
+            m_books->reset();
+        }
+        else
+        {
+            m_books = std::make_unique<OrderBookRegistry>(make_book_factory(event_base, m_options.product));
+        }
+        configure_registry(*m_books, make_mbp10_writer(m_options.mbp10_output_path));
+    }
+    else
+    {
+        for (size_t i = 0; i < m_options.num_shards; ++i)
+        {
+            if (i == m_shards.size())
+            {
+                EventBase* shard_event_base = OrderBookShard::get_shard_event_base(i);
+                m_shards.push_back(std::make_unique<OrderBookShard>(shard_event_base, make_book_factory(shard_event_base, m_options.product)));
+            }
+
+            Mbp10Writer* mbp10_writer = make_mbp10_writer(m_options.mbp10_output_path.empty() ? "" : m_options.mbp10_output_path + "." + std::to_string(i));
+            co_await m_shards[i]->reset([this, mbp10_writer](OrderBookRegistry& books)
+            {
+                configure_registry(books, mbp10_writer);
+            });
+            m_shards[i]->start();
+        }
+    }
+    publish_directory();
+
+    m_dbn_wrapper = std::make_unique<DbnWrapper>(dbn_file_paths);
+
+    m_dbn_file_paths = dbn_file_paths;
+    m_stream_position = OrderBookCheckpoint::StreamPosition{};
+
+    if (m_options.start_ts_recv != 0)
+    {
+        if (!m_books)
+        {
+            spdlog::error("Seeking needs unsharded streaming, replaying from the start");
+        }
+        else if (m_dbn_file_paths.size() != 1)
+        {
+            spdlog::error("Seeking needs a single DBN file, replaying from the start");
+        }
+        else
+        {
+            co_await seek_to_start_ts();
+        }
+    }
+    else if (!m_options.checkpoint_path.empty())
+    {
+        if (m_books)
+        {
+            resume_from_checkpoint();
+        }
+        else
+        {
+            spdlog::error("Checkpoints need unsharded streaming, ignoring {}", m_options.checkpoint_path);
+        }
+    }
+
+    co_return;
 }
 
 Task<void> OrderBookController::start_streaming(double speed)
 {
-    spdlog::info("Start streaming DBN file: {}, with speed={}", m_dbn_file_path, speed);
+    spdlog::info("Start streaming {} DBN file(s) from {}, with speed={}", m_dbn_file_paths.size(), m_dbn_file_paths.front(), speed);
 
     m_dbn_wrapper->set_speed(speed);
 
@@ -24,22 +349,65 @@ Task<void> OrderBookController::start_streaming(double speed)
     apply_stats.clear();
     count_mbo_msgs = 0;
 
-    auto task = m_dbn_wrapper->start_stream_data([this, m_order_book = m_order_book.get()](const databento::MboMsg& mbo_msg, Json& feed_snapshots)
+    auto apply_batch = [this, books = m_books.get(), last_instrument_id = UINT32_MAX, last_shard = (OrderBookShard*)nullptr](std::span<const databento::MboMsg> mbo_msgs) mutable
     {
         auto start = std::chrono::high_resolution_clock::now();
 
-        m_order_book->apply(mbo_msg);
+        if (m_shards.empty())
+        {
+            books->apply_batch(mbo_msgs);
+        }
+        else
+        {
+            // Sharded mode: only the hand-off to the owning shards is measured here, each shard times its apply
+            for (const databento::MboMsg& mbo_msg : mbo_msgs)
+            {
+                if (mbo_msg.hd.instrument_id != last_instrument_id)
+                {
+                    last_instrument_id = mbo_msg.hd.instrument_id;
+                    last_shard = m_shards[OrderBookShard::shard_of(last_instrument_id, m_shards.size())].get();
+                }
+                last_shard->push(mbo_msg);
+            }
+        }
 
-        // Json feed_snapshot = m_order_book->build_mbp_msg10_from_mbo_msg(mbo_msg);
-        // feed_snapshots.push_back(feed_snapshot);
+        if (m_first_instrument_id.load(std::memory_order_relaxed) == NO_INSTRUMENT)
+        {
+            m_first_instrument_id.store(mbo_msgs.front().hd.instrument_id, std::memory_order_release);
+        }
 
+        // Per-message apply latency, averaged over the batch
         auto end = std::chrono::high_resolution_clock::now();
         double us = std::chrono::duration<double, std::micro>(end - start).count();
-        apply_stats.add_sample(us);
+        apply_stats.add_sample(us / mbo_msgs.size());
 
-        count_mbo_msgs++;
-    });
-    task.start_running_on(event_base);
+        count_mbo_msgs += mbo_msgs.size();
+
+        m_stream_position.record_index += mbo_msgs.size();
+        m_stream_position.last_ts_recv = mbo_msgs.back().ts_recv.time_since_epoch().count();
+        m_stream_position.last_sequence = mbo_msgs.back().sequence;
+
+        // Percentiles sort every sample: only while snapshots are being read, at most once per interval
+        if (m_apply_latency_wanted.load(std::memory_order_relaxed) && end - m_apply_latency_time >= APPLY_LATENCY_PUBLISH_INTERVAL)
+        {
+            m_apply_latency_time = end;
+            m_apply_latency_wanted.store(false, std::memory_order_relaxed);
+            m_apply_latency.store(ApplyLatency{apply_stats.p50(), apply_stats.p90(), apply_stats.p99()});
+        }
+    };
+
+    // Event batching: chunks end on F_LAST, so gateway snapshots see complete events
+    if (m_options.pipelined_reader)
+    {
+        EventBase* reader_event_base = EventBaseManager::get_event_base_by_id(EventBaseID::DBN_READER);
+        auto task = m_dbn_wrapper->start_stream_data_pipelined(apply_batch, *m_record_ring, reader_event_base, DbnWrapper::APPLY_BATCH, m_options.event_batching);
+        task.start_running_on(event_base);
+    }
+    else
+    {
+        auto task = m_dbn_wrapper->start_stream_data_batched(apply_batch, DbnWrapper::APPLY_BATCH, m_options.event_batching);
+        task.start_running_on(event_base);
+    }
 
     co_return;
 }
@@ -53,19 +421,228 @@ Task<void> OrderBookController::stop_streaming()
     co_return;
 }
 
-Task<void> OrderBookController::get_orderbook_snapshot_async(Future<Json>::FutureValue* future_value)
+void OrderBookController::add_apply_latency(Json& snapshot)
 {
+    ApplyLatency apply_latency;
+    m_apply_latency.load(apply_latency);
+    m_apply_latency_wanted.store(true, std::memory_order_relaxed);
+
+    auto latency_json = [](const ApplyLatency& latency) -> Json
+    {
+        return {
+            {"p50", latency.p50},
+            {"p90", latency.p90},
+            {"p99", latency.p99},
+            {"throughput_p50", 1000000.0 / latency.p50},
+            {"throughput_p90", 1000000.0 / latency.p90},
+            {"throughput_p99", 1000000.0 / latency.p99}
+        };
+    };
+
+    if (m_shards.empty())
+    {
+        snapshot["latency_apply_mbo_msg"] = latency_json(apply_latency);
+    }
+    else
+    {
+        // Sharded: the apply is timed on each shard thread, the slowest shard bounds the replay
+        ApplyLatency slowest;
+        Json shards;
+        for (auto& shard : m_shards)
+        {
+            ApplyLatency shard_latency = shard->apply_latency();
+            slowest.p50 = std::max(slowest.p50, shard_latency.p50);
+            slowest.p90 = std::max(slowest.p90, shard_latency.p90);
+            slowest.p99 = std::max(slowest.p99, shard_latency.p99);
+            shards.push_back(latency_json(shard_latency));
+        }
+        snapshot["latency_apply_mbo_msg"] = latency_json(slowest);
+        snapshot["latency_apply_mbo_msg_shards"] = shards;
+        snapshot["latency_shard_handoff"] = latency_json(apply_latency);
+    }
+
+    if (m_options.pipelined_reader)
+    {
+        snapshot["replay_pipeline"] = m_record_ring->stats_json();
+    }
+}
+
+uint16_t OrderBookController::venue_of(std::optional<uint16_t> publisher_id) const
+{
+    return m_options.venue_books && publisher_id ? *publisher_id : OrderBookRegistry::ALL_VENUES;
+}
+
+void OrderBookController::publish_directory()
+{
+    auto directory = std::make_unique<PublishedDirectory>();
+    if (m_books)
+    {
+        directory->registries.push_back(m_books.get());
+    }
+    for (auto& shard : m_shards)
+    {
+        directory->registries.push_back(&shard->get_books());
+    }
+    directory->sharded = !m_shards.empty();
+    directory->venue_books = m_options.venue_books;
+
+    const PublishedDirectory* current = m_published_directory.load(std::memory_order_relaxed);
+    if (current && current->registries == directory->registries && current->sharded == directory->sharded && current->venue_books == directory->venue_books)
+    {
+        return;
+    }
+
+    m_published_directory.store(directory.get(), std::memory_order_release);
+    m_published_directories.push_back(std::move(directory));
+}
+
+const OrderBookBase* OrderBookController::find_published_book(uint32_t instrument_id, uint16_t publisher_id, size_t& shard_index) const
+{
+    // Registries of the directory are never destroyed, and only hand out books that are never destroyed either
+    const PublishedDirectory* directory = m_published_directory.load(std::memory_order_acquire);
+    shard_index = 0;
+    if (directory == nullptr || directory->registries.empty())
+    {
+        return nullptr;
+    }
+
+    if (directory->sharded)
+    {
+        shard_index = OrderBookShard::shard_of(instrument_id, directory->registries.size());
+    }
+    return directory->registries[shard_index]->find_published(instrument_id, publisher_id);
+}
+
+uint64_t OrderBookController::read_bbo(uint32_t instrument_id, OrderBook::Bbo& out, std::optional<uint16_t> publisher_id) const
+{
+    // Not venue_of(): m_options belongs to the thread running initialize()
+    const PublishedDirectory* directory = m_published_directory.load(std::memory_order_acquire);
+    uint16_t venue = directory && directory->venue_books && publisher_id ? *publisher_id : OrderBookRegistry::ALL_VENUES;
+
+    size_t shard_index = 0;
+    const OrderBookBase* order_book = find_published_book(instrument_id, venue, shard_index);
+    if (order_book == nullptr)
+    {
+        out = OrderBook::Bbo{};
+        return 0;
+    }
+
+    return order_book->read_bbo(out);
+}
+
+Json OrderBookController::read_published_snapshot(std::optional<uint32_t> instrument_id, size_t levels, uint16_t publisher_id)
+{
+    // Only touched on the calling (HTTP) thread
     static LatencyTracker latency;
+    static Json latency_json;
+    static std::chrono::steady_clock::time_point latency_json_time;
 
     // Start latency tracking
     auto t0 = std::chrono::steady_clock::now();
 
-    if (m_order_book == nullptr)
+    uint32_t id = instrument_id.value_or(m_first_instrument_id.load(std::memory_order_acquire));
+    if (id == NO_INSTRUMENT)
+    {
+        return Json{};
+    }
+
+    size_t shard_index = 0;
+    const OrderBookBase* order_book = find_published_book(id, publisher_id, shard_index);
+    if (order_book == nullptr)
+    {
+        return Json{};
+    }
+
+    OrderBook::PublishedDepth depth;
+    uint64_t version = order_book->read_published(depth);
+
+    Json snapshot = OrderBook::published_to_json(depth, levels);
+    snapshot["instrument_id"] = id;
+    if (publisher_id != OrderBookRegistry::ALL_VENUES)
+    {
+        snapshot["publisher_id"] = publisher_id;
+    }
+    snapshot["version"] = version;
+    snapshot["ts_recv"] = depth.last_ts_recv;
+    add_signals(snapshot, *order_book);
+    if (!m_shards.empty())
+    {
+        snapshot["shard"] = shard_index;
+    }
+
+    // End latency tracking
+    auto t1 = std::chrono::steady_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    latency.add_sample(ms);
+
+    if (t1 - latency_json_time >= APPLY_LATENCY_PUBLISH_INTERVAL)
+    {
+        latency_json_time = t1;
+        latency_json = {
+            {"p50", latency.p50()},
+            {"p90", latency.p90()},
+            {"p99", latency.p99()}
+        };
+    }
+    snapshot["latency_get_snapshot"] = latency_json;
+    add_apply_latency(snapshot);
+
+    return snapshot;
+}
+
+Task<void> OrderBookController::get_orderbook_snapshot_async(Future<Json>::FutureValue* future_value, std::optional<uint32_t> instrument_id, size_t levels, std::optional<int64_t> bucket_ticks, std::optional<uint16_t> publisher_id)
+{
+    static LatencyTracker latency;
+
+    // Start latency tracking
+    auto t0 = std::chrono::steady_clock::now();
+
+    uint32_t id = instrument_id.value_or(m_first_instrument_id.load(std::memory_order_acquire));
+    if (id == NO_INSTRUMENT)
     {
         future_value->set_value(Json{});
         co_return;
     }
-    Json snapshot = m_order_book->build_snapshot();
+
+    bool consolidated = m_options.venue_books && !publisher_id;
+    uint16_t venue = venue_of(publisher_id);
+
+    auto build_snapshot = [this, id, levels, bucket_ticks, consolidated, venue](OrderBookRegistry& books) -> Json
+    {
+        if (consolidated)
+        {
+            // Bucket views are kept per venue book only
+            ConsolidatedBook* consolidated_book = books.find_consolidated(id);
+            if (consolidated_book == nullptr || bucket_ticks) return Json{};
+
+            return consolidated_book->build_snapshot(levels);
+        }
+
+        OrderBookBase* order_book = books.find(id, venue);
+        if (order_book == nullptr) return Json{};
+
+        Json snapshot = bucket_ticks ? order_book->build_bucket_snapshot(*bucket_ticks, levels) : order_book->build_snapshot(levels);
+        add_signals(snapshot, *order_book);
+        return snapshot;
+    };
+
+    Json snapshot;
+    if (m_shards.empty())
+    {
+        snapshot = build_snapshot(*m_books);
+    }
+    else
+    {
+        // The owning shard builds it on its own thread
+        size_t shard_index = OrderBookShard::shard_of(id, m_shards.size());
+        snapshot = co_await m_shards[shard_index]->run_on_shard(build_snapshot);
+        snapshot["shard"] = shard_index;
+    }
+    snapshot["instrument_id"] = id;
+    if (venue != OrderBookRegistry::ALL_VENUES)
+    {
+        snapshot["publisher_id"] = venue;
+    }
 
     // End latency tracking
     auto t1 = std::chrono::steady_clock::now();
@@ -77,25 +654,162 @@ Task<void> OrderBookController::get_orderbook_snapshot_async(Future<Json>::Futur
         {"p90", latency.p90()},
         {"p99", latency.p99()}
     };
-    snapshot["latency_apply_mbo_msg"] = {
-        {"p50", apply_stats.p50()},
-        {"p90", apply_stats.p90()},
-        {"p99", apply_stats.p99()},
-        {"throughput_p50", 1000000.0 / apply_stats.p50()},
-        {"throughput_p90", 1000000.0 / apply_stats.p90()},
-        {"throughput_p99", 1000000.0 / apply_stats.p99()}
-    };
+    add_apply_latency(snapshot);
 
     future_value->set_value(std::move(snapshot));
 
     co_return;
 }
 
-Future<Json> OrderBookController::get_orderbook_snapshot()
+Future<Json> OrderBookController::get_orderbook_snapshot(std::optional<uint32_t> instrument_id, size_t levels, std::optional<int64_t> bucket_ticks, std::optional<uint16_t> publisher_id)
+{
+    return Future<Json>([this, instrument_id, levels, bucket_ticks, publisher_id](Future<Json>::FutureValue* future_value)
+    {
+        // Read from the published depth on the calling thread, only deeper, bucketed or consolidated requests go to the apply thread
+        bool consolidated = m_options.venue_books && !publisher_id;
+        if (levels <= OrderBook::PUBLISHED_DEPTH_LEVELS && !bucket_ticks && !consolidated)
+        {
+            future_value->set_value(read_published_snapshot(instrument_id, levels, venue_of(publisher_id)));
+            return;
+        }
+
+        auto task = this->get_orderbook_snapshot_async(future_value, instrument_id, levels, bucket_ticks, publisher_id);
+        task.start_running_on(event_base);
+    });
+}
+
+Task<void> OrderBookController::save_checkpoint_async(Future<Json>::FutureValue* future_value, std::string path)
+{
+    Json result;
+    if (m_books == nullptr)
+    {
+        result["status"] = "ERROR";
+        result["message"] = "Checkpoints need unsharded streaming";
+        future_value->set_value(std::move(result));
+        co_return;
+    }
+
+    // Taken between two applied batches: the last record handed over is the last one applied, unless a ring sits
+    // between the reader and the books
+    OrderBookCheckpoint::StreamPosition position = m_stream_position;
+    position.last_offset = m_options.pipelined_reader ? OrderBookCheckpoint::NO_OFFSET : m_dbn_wrapper->last_record_offset();
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool ok = OrderBookCheckpoint::save(path, *m_books, position);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    result["status"] = ok ? "OK" : "ERROR";
+    result["path"] = path;
+    result["books"] = m_books->size();
+    result["record_index"] = m_stream_position.record_index;
+    result["save_ms"] = ms;
+    future_value->set_value(std::move(result));
+
+    co_return;
+}
+
+Future<Json> OrderBookController::save_checkpoint(const std::string& path)
+{
+    return Future<Json>([this, path](Future<Json>::FutureValue* future_value)
+    {
+        auto task = this->save_checkpoint_async(future_value, path);
+        task.start_running_on(event_base);
+    });
+}
+
+Task<void> OrderBookController::get_queue_position_async(Future<Json>::FutureValue* future_value, std::optional<uint32_t> instrument_id, uint64_t order_id, std::optional<uint16_t> publisher_id)
+{
+    uint32_t id = instrument_id.value_or(m_first_instrument_id.load(std::memory_order_acquire));
+    if (id == NO_INSTRUMENT)
+    {
+        future_value->set_value(Json{});
+        co_return;
+    }
+
+    uint16_t venue = venue_of(publisher_id);
+
+    auto find_position = [id, order_id, venue](OrderBookRegistry& books) -> Json
+    {
+        OrderBookBase* order_book = books.find(id, venue);
+        auto position = order_book ? order_book->queue_position(order_id) : std::nullopt;
+        if (!position)
+        {
+            return Json{};
+        }
+
+        return {
+            {"price", position->price},
+            {"side", position->is_bid ? "B" : "A"},
+            {"size", position->size},
+            {"size_ahead", position->size_ahead},
+            {"count_ahead", position->count_ahead},
+            {"level_size", position->level_size},
+            {"level_count", position->level_count},
+            {"indexed", order_book->queue_positions()}
+        };
+    };
+
+    Json result;
+    if (m_shards.empty())
+    {
+        result = find_position(*m_books);
+    }
+    else
+    {
+        size_t shard_index = OrderBookShard::shard_of(id, m_shards.size());
+        result = co_await m_shards[shard_index]->run_on_shard(find_position);
+    }
+
+    future_value->set_value(std::move(result));
+
+    co_return;
+}
+
+Future<Json> OrderBookController::get_queue_position(std::optional<uint32_t> instrument_id, uint64_t order_id, std::optional<uint16_t> publisher_id)
+{
+    return Future<Json>([this, instrument_id, order_id, publisher_id](Future<Json>::FutureValue* future_value)
+    {
+        auto task = this->get_queue_position_async(future_value, instrument_id, order_id, publisher_id);
+        task.start_running_on(event_base);
+    });
+}
+
+Task<void> OrderBookController::get_instruments_async(Future<Json>::FutureValue* future_value)
+{
+    auto list_instruments = [](OrderBookRegistry& books) -> Json
+    {
+        Json instruments;
+        for (uint32_t instrument_id : books.instrument_ids())
+        {
+            instruments.push_back(instrument_id);
+        }
+        return instruments;
+    };
+
+    Json instruments;
+    if (m_books != nullptr)
+    {
+        instruments = list_instruments(*m_books);
+    }
+    for (auto& shard : m_shards)
+    {
+        Json shard_instruments = co_await shard->run_on_shard(list_instruments);
+        for (int i = 0; i < shard_instruments.size(); ++i)
+        {
+            instruments.push_back(shard_instruments[i]);
+        }
+    }
+
+    future_value->set_value(std::move(instruments));
+
+    co_return;
+}
+
+Future<Json> OrderBookController::get_instruments()
 {
     return Future<Json>([this](Future<Json>::FutureValue* future_value)
     {
-        auto task = this->get_orderbook_snapshot_async(future_value);
+        auto task = this->get_instruments_async(future_value);
         task.start_running_on(event_base);
     });
 }
\ No newline at end of file
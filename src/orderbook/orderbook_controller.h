@@ -1,12 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <vector>
+#include <iterator>
+#include <optional>
 
 #include <utils/utils.h>
 
 #include <orderbook/orderbook.h>
+#include <orderbook/orderbook_products.h>
+#include <orderbook/orderbook_registry.h>
+#include <orderbook/orderbook_shard.h>
+#include <orderbook/orderbook_checkpoint.h>
 #include <dbn_wrapper/dbn_wrapper.h>
+#include <dbn_wrapper/dbn_seek_index.h>
 #include <utils/latency_tracker.h>
+#include <utils/seqlock.h>
 #include <coroutine/event_base_manager.h>
 #include <coroutine/task.h>
 #include <coroutine/future.h>
@@ -15,25 +26,139 @@ class OrderBookController
 {
     Singleton(OrderBookController)
 
+public:
+    // Set by /start_streaming_orderbook
+    struct StreamingOptions
+    {
+        size_t num_shards = 0;              // 0 => apply on the GATEWAY thread, otherwise instruments are hash-partitioned across shards
+        std::string mbp10_output_path;      // non-empty => binary MBP-10 records are written there (one file per shard: "<path>.<shard>")
+        bool event_batching = false;        // snapshots and MBP-10 records only reflect complete events (F_LAST)
+        std::string checkpoint_path;        // non-empty (unsharded only) => books are loaded from it, the replay resumes after its position
+        bool queue_positions = false;       // per-level queue-position index behind get_queue_position()
+        std::vector<int64_t> bucket_resolutions;    // bucketed aggregates maintained per book (in ticks), read by bucket snapshots
+        bool venue_books = false;           // one book per (instrument, publisher_id) and a consolidated view per instrument
+        size_t signal_levels = 0;           // > 0 => every book maintains microstructure signals over that many top levels
+        bool pipelined_reader = false;      // decode on the DBN_READER thread, the apply thread drains a record ring
+        std::string product;                // known product ("CL", see orderbook_products.h) => its compile-time configured book
+                                            // for every instrument, otherwise runtime-configured books
+        uint64_t start_ts_recv = 0;         // > 0 (unsharded, single file) => the replay starts at the first record at or after
+                                            // it, books are rebuilt from the nearest preceding reset or from checkpoint_path
+    };
+
+    using SignalsSubscriber = OrderBookRegistry::SignalsCallback;
+
 private:
-    std::unique_ptr<OrderBook> m_order_book;
+    static constexpr uint32_t NO_INSTRUMENT = UINT32_MAX;
+    static constexpr auto APPLY_LATENCY_PUBLISH_INTERVAL = std::chrono::seconds(1);
+
+    using ApplyLatency = OrderBookShard::ApplyLatency;
+
+    std::unique_ptr<OrderBookRegistry> m_books;   // one book per instrument_id (unsharded mode)
+    std::vector<std::unique_ptr<OrderBookShard>> m_shards;  // sharded mode: books live on the shard threads
+
+    // Registries readers on any thread go through (find_published_book, read_bbo): the unsharded one, or one per shard.
+    // initialize() publishes a new directory when the layout changes. Directories, and the registries and shards they
+    // list, are never freed since a reader may still hold them: a layout change (shard count, product) keeps the
+    // memory of the books it drops
+    struct PublishedDirectory
+    {
+        std::vector<const OrderBookRegistry*> registries;
+        bool sharded = false;
+        bool venue_books = false;
+    };
+    std::atomic<const PublishedDirectory*> m_published_directory = nullptr;
+    std::vector<std::unique_ptr<PublishedDirectory>> m_published_directories;
+    std::vector<std::unique_ptr<OrderBookRegistry>> m_retired_books;
+    std::vector<std::unique_ptr<OrderBookShard>> m_retired_shards;
+    std::vector<std::unique_ptr<Mbp10Writer>> m_mbp10_writers;  // one per registry/shard when MBP-10 output is on
+    std::atomic<uint32_t> m_first_instrument_id = NO_INSTRUMENT;    // default instrument for snapshots
     std::unique_ptr<DbnWrapper> m_dbn_wrapper;
+    std::unique_ptr<DbnRecordRing> m_record_ring = std::make_unique<DbnRecordRing>();  // pipelined replay, stats read by snapshots
+    StreamingOptions m_options;
+    OrderBookCheckpoint::StreamPosition m_stream_position;  // MBO records of the file applied so far (GATEWAY thread)
 
     EventBase* event_base = EventBaseManager::get_event_base_by_id(EventBaseID::GATEWAY);
 
-    // File path
-    std::string m_dbn_file_path;
+    // File paths, replayed as one stream merged by ts_recv
+    std::vector<std::string> m_dbn_file_paths;
 
-    // Measure apply stats
+    // Measure apply stats (sharded mode: the hand-off to the shard queues, the shards time their own apply)
     LatencyTracker apply_stats;
     int count_mbo_msgs = 0;
 
+    // Apply latency percentiles (hand-off when sharded) published by the gateway for snapshot readers on other threads
+    SeqLock<ApplyLatency> m_apply_latency;
+
+    // In-process signal subscribers, called on the apply thread of the book (GATEWAY or its shard)
+    std::vector<SignalsSubscriber> m_signals_subscribers;
+    std::atomic<bool> m_apply_latency_wanted = false;
+    std::chrono::high_resolution_clock::time_point m_apply_latency_time;
+
+    static OrderBookRegistry::BookFactory make_book_factory(EventBase* book_event_base, const std::string& product);
+    Mbp10Writer* make_mbp10_writer(const std::string& path);   // nullptr when `path` is empty
+    void configure_registry(OrderBookRegistry& books, Mbp10Writer* mbp10_writer) const;
+    void publish_directory();   // after the layout of a run is built, see PublishedDirectory
+    OrderBookRegistry::SignalsCallback make_signals_callback() const;  // nullptr without signals or subscribers
+    void resume_from_checkpoint();
+
+    // Start the replay at StreamingOptions::start_ts_recv. The books are rebuilt on the GATEWAY EventBase which owns
+    // them, yielding every SEEK_CHUNK_RECORDS so that queries keep being served, the seek index (which may need a scan
+    // of the whole file) is loaded on the DBN_READER EventBase. initialize() awaits it without holding its thread
+    static constexpr uint64_t SEEK_CHUNK_RECORDS = 16384;
+    Future<bool> seek_to_start_ts();
+    Task<void> seek_to_start_ts_async(Future<bool>::FutureValue* future_value);
+    Future<bool> load_seek_index(DbnSeekIndex& index);
+    Task<void> load_seek_index_async(Future<bool>::FutureValue* future_value, DbnSeekIndex& index);
+
+    // Suspend and go back to the end of the EventBase ready queue, so queued tasks can run
+    static Future<bool> yield();
+
+    // Drops the MBO records up to `position`, jumping through the seek index when there is one
+    bool skip_to(const OrderBookCheckpoint::StreamPosition& position, const DbnSeekIndex* index);
+
+    // Publisher key of a book: the requested venue with venue books, otherwise the single book of the instrument
+    uint16_t venue_of(std::optional<uint16_t> publisher_id) const;
+
+    // Published book of an instrument (and the shard owning it), nullptr when unknown, any thread
+    const OrderBookBase* find_published_book(uint32_t instrument_id, uint16_t publisher_id, size_t& shard_index) const;
+
+    // Snapshot from the depth published by the apply thread, runs on the calling thread
+    Json read_published_snapshot(std::optional<uint32_t> instrument_id, size_t levels, uint16_t publisher_id);
+    void add_apply_latency(Json& snapshot);
+    void add_signals(Json& snapshot, const OrderBookBase& order_book) const;
+
 public:
-    void initialize(const std::string& dbn_file_path);
+    // Several files (e.g. one per product per day) are merged by (ts_recv, sequence) into one replay
+    Task<void> initialize(const std::vector<std::string>& dbn_file_paths, const StreamingOptions& options);
     Task<void> stop_streaming();
     Task<void> start_streaming(double speed = 1.0);
 
-    // Get current order book snapshot
-    Task<void> get_orderbook_snapshot_async(Future<Json>::FutureValue* future_value);
-    Future<Json> get_orderbook_snapshot();
+    // Get current order book snapshot (first seen instrument when instrument_id is not given), `levels` per side.
+    // Up to PUBLISHED_DEPTH_LEVELS it never enqueues work on the apply thread.
+    // With `bucket_ticks`, `levels` buckets of that many ticks per side, built on the apply thread from the bucketed aggregates.
+    // With venue books: the book of `publisher_id`, or without it the consolidated view (built on the apply thread)
+    Task<void> get_orderbook_snapshot_async(Future<Json>::FutureValue* future_value, std::optional<uint32_t> instrument_id, size_t levels, std::optional<int64_t> bucket_ticks, std::optional<uint16_t> publisher_id);
+    Future<Json> get_orderbook_snapshot(std::optional<uint32_t> instrument_id = std::nullopt, size_t levels = OrderBook::DEFAULT_DEPTH_CACHE_LEVELS, std::optional<int64_t> bucket_ticks = std::nullopt, std::optional<uint16_t> publisher_id = std::nullopt);
+
+    // Write every book and the replay position to `path` (unsharded only), runs on the apply thread between batches
+    Task<void> save_checkpoint_async(Future<Json>::FutureValue* future_value, std::string path);
+    Future<Json> save_checkpoint(const std::string& path);
+
+    // Size / count ahead of an order in its level queue (first seen instrument when instrument_id is not given).
+    // With venue books, order ids are looked up in the book of `publisher_id`
+    Task<void> get_queue_position_async(Future<Json>::FutureValue* future_value, std::optional<uint32_t> instrument_id, uint64_t order_id, std::optional<uint16_t> publisher_id);
+    Future<Json> get_queue_position(std::optional<uint32_t> instrument_id, uint64_t order_id, std::optional<uint16_t> publisher_id = std::nullopt);
+
+    // Any thread (e.g. strategy EventBases): best bid / ask of an instrument straight from the book's BBO seqlock,
+    // without a hop to the apply thread. Returns its version, 0 (and an empty Bbo) when unknown or never published.
+    // With venue books, the BBO of the book of `publisher_id`
+    uint64_t read_bbo(uint32_t instrument_id, OrderBook::Bbo& out, std::optional<uint16_t> publisher_id = std::nullopt) const;
+
+    // In-process consumer of the signals of every book (see StreamingOptions::signal_levels), called on the apply
+    // thread right after the message that changed them. Subscribe before initialize(), it must not block
+    void subscribe_signals(SignalsSubscriber subscriber);
+
+    // Get all instrument ids seen so far
+    Task<void> get_instruments_async(Future<Json>::FutureValue* future_value);
+    Future<Json> get_instruments();
 };
\ No newline at end of file
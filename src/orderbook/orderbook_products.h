@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+
+#include <orderbook/orderbook.h>
+
+// Compile-time configured books for the products we know.
+// Prices are fixed-point 1e-9 (databento), so a 0.01 tick is 10'000'000.
+
+// CME Crude Oil (CL): 0.01 tick, dense ladder over [$0, $500]
+using CLOrderBook = BasicOrderBook<StaticBookConfig<
+    10000000LL,             // tick = 0.01
+    0LL,                    // price_min = $0
+    500000000000LL          // price_max = $500
+>>;
+
+// Book of a known product ("CL"), for the registry's book factory. nullptr when the product has no configured book
+inline std::unique_ptr<OrderBookBase> make_product_book(std::string_view product, EventBase* event_base)
+{
+    if (product == "CL") return std::make_unique<CLOrderBook>(event_base);
+    return nullptr;
+}
+
+inline bool is_known_product(std::string_view product)
+{
+    return product == "CL";
+}
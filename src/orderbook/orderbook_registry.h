@@ -0,0 +1,426 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+
+#include <databento/dbn.hpp>
+
+#include <hash_map/flat_hash_map.h>
+#include <hash_map/atomic_pointer_map.h>
+#include <orderbook/orderbook.h>
+#include <orderbook/consolidated_book.h>
+#include <orderbook/mbp10_writer.h>
+
+// One book per instrument_id, created lazily on first sight through the factory (any OrderBookBase: runtime or
+// compile-time configured, see orderbook_products.h).
+// Books get a dense id (creation order), messages are routed without hashing in the common case:
+// - same instrument as the previous message → cached book
+// - otherwise a direct-mapped slot (instrument_id & mask) → dense id
+// - only a slot collision falls back to the FlatHashMap
+// Books touched by apply_batch() publish their top levels once per batch, readers on other threads
+// find them through find_published() (lock-free hash directory) and read the seqlock block of the book.
+// With an MBP-10 writer, every book emits its MBP-10 records into it and apply_batch() flushes them.
+// With event batching, a book in the middle of an event (no F_LAST yet) stays pending until the event completes.
+// reset() empties the books but keeps them (and their memory) registered, so a new run reuses them.
+// With venue books, a book is kept per (instrument_id, publisher_id) and each instrument gets a ConsolidatedBook
+// summing its venue books level by level.
+class OrderBookRegistry
+{
+public:
+    using BookFactory = std::function<std::unique_ptr<OrderBookBase>(uint32_t instrument_id)>;    // e.g. make_product_book()
+    using SignalsCallback = std::function<void(uint32_t instrument_id, uint16_t publisher_id, const OrderBook::Signals&)>;
+
+    static constexpr uint16_t ALL_VENUES = UINT16_MAX;    // publisher_id of the books when venue books are off
+
+private:
+    static constexpr size_t DIRECT_SLOTS = 1024;
+    static constexpr uint64_t NO_BOOK = UINT64_MAX;
+    static constexpr uint32_t NO_INSTRUMENT = UINT32_MAX;
+    static constexpr size_t PUBLISHED_BOOKS_CAPACITY = 1024;     // grows on demand
+
+    // Books are keyed by publisher_id << 32 | instrument_id
+    static inline uint64_t book_key(uint32_t instrument_id, uint16_t publisher_id)
+    {
+        return ((uint64_t)publisher_id << 32) | instrument_id;
+    }
+
+    struct DirectSlot
+    {
+        uint64_t key = NO_BOOK;
+        uint32_t dense_id = 0;
+    };
+
+    BookFactory m_factory;
+    std::vector<std::unique_ptr<OrderBookBase>> m_books;   // dense_id → book
+    std::vector<uint32_t> m_instrument_ids;            // dense_id → instrument_id
+    std::vector<uint16_t> m_publisher_ids;             // dense_id → publisher_id (ALL_VENUES without venue books)
+    std::vector<uint32_t> m_instruments;               // distinct instrument ids, in order of first sight
+    std::array<DirectSlot, DIRECT_SLOTS> m_direct_slots;
+    FlatHashMap<uint64_t, uint32_t> m_dense_ids;       // book key → dense_id
+
+    uint64_t m_last_key = NO_BOOK;
+    uint32_t m_last_dense_id = 0;
+    OrderBookBase* m_last_book = nullptr;
+
+    // Venue books: consolidated view per instrument
+    bool m_venue_books = false;
+    std::vector<std::unique_ptr<ConsolidatedBook>> m_consolidated;
+    FlatHashMap<uint32_t, uint32_t> m_consolidated_ids;    // instrument_id → index in m_consolidated
+
+    // Books applied since the last publish (dense ids), each listed once
+    std::vector<uint32_t> m_pending_publish;
+    std::vector<bool> m_is_pending_publish;
+
+    // Reader-side directory, book key → book: written by the apply thread only, lock-free for readers
+    AtomicPointerMap<const OrderBookBase> m_published_books{PUBLISHED_BOOKS_CAPACITY};
+
+    Mbp10Writer* m_mbp10_writer = nullptr;
+    bool m_event_batching = false;
+    bool m_queue_positions = false;
+    std::vector<int64_t> m_bucket_resolutions;
+    size_t m_signal_levels = 0;
+    SignalsCallback m_signals_callback;
+
+public:
+    OrderBookRegistry(BookFactory factory) : m_factory(std::move(factory)) {}
+
+    OrderBookRegistry(const OrderBookRegistry&) = delete;
+    OrderBookRegistry& operator=(const OrderBookRegistry&) = delete;
+
+    // A batch of one: the book is published (and its MBP-10 records flushed) right away
+    inline void apply(const databento::MboMsg& mbo)
+    {
+        apply_batch(std::span<const databento::MboMsg>(&mbo, 1));
+    }
+
+    // Runs of consecutive messages for the same book go to OrderBook::apply_batch
+    void apply_batch(std::span<const databento::MboMsg> msgs)
+    {
+        size_t begin = 0;
+        while (begin < msgs.size())
+        {
+            uint32_t instrument_id = msgs[begin].hd.instrument_id;
+            uint16_t publisher_id = publisher_of(msgs[begin]);
+            size_t end = begin + 1;
+            while (end < msgs.size() && msgs[end].hd.instrument_id == instrument_id && publisher_of(msgs[end]) == publisher_id)
+            {
+                ++end;
+            }
+
+            get_or_create(instrument_id, publisher_id)->apply_batch(msgs.subspan(begin, end - begin));
+            mark_pending_publish(m_last_dense_id);
+            begin = end;
+        }
+
+        publish_pending();
+
+        if (m_mbp10_writer)
+        {
+            m_mbp10_writer->flush();
+        }
+    }
+
+    // Every book emits MBP-10 records into `writer` (nullptr = none), set it before applying
+    void set_mbp10_writer(Mbp10Writer* writer)
+    {
+        m_mbp10_writer = writer;
+        for (auto& book : m_books) install_mbp10_writer(*book);
+    }
+
+    // Every book batches by event (see OrderBook::set_event_batching), set it before applying
+    void set_event_batching(bool enabled)
+    {
+        m_event_batching = enabled;
+        for (auto& book : m_books) book->set_event_batching(enabled);
+    }
+
+    // Every book keeps a queue-position index per level, set it before applying
+    void set_queue_positions(bool enabled)
+    {
+        m_queue_positions = enabled;
+        for (auto& book : m_books) book->set_queue_positions(enabled);
+    }
+
+    // Every book maintains bucketed aggregates at these resolutions (see OrderBook::set_bucket_resolutions)
+    void set_bucket_resolutions(const std::vector<int64_t>& resolutions)
+    {
+        m_bucket_resolutions = resolutions;
+        for (auto& book : m_books) book->set_bucket_resolutions(resolutions);
+    }
+
+    // Every book maintains microstructure signals over its top `levels` levels (see OrderBook::set_signal_levels)
+    void set_signal_levels(size_t levels)
+    {
+        m_signal_levels = levels;
+        for (auto& book : m_books) book->set_signal_levels(levels);
+    }
+
+    // Every book hands its new signals to `callback` on the apply thread (nullptr = none), set it before applying
+    void set_signals_callback(SignalsCallback callback)
+    {
+        m_signals_callback = std::move(callback);
+        for (size_t dense_id = 0; dense_id < m_books.size(); ++dense_id) install_signals_callback(dense_id);
+    }
+
+    // One book per (instrument_id, publisher_id) plus a consolidated view per instrument, set it before applying.
+    // Books created in the other mode stay registered (empty after a reset) but are not routed to anymore
+    void set_venue_books(bool enabled)
+    {
+        if (m_venue_books == enabled) return;
+
+        m_venue_books = enabled;
+        m_last_key = NO_BOOK;
+    }
+
+    inline bool venue_books() const { return m_venue_books; }
+
+    inline uint16_t publisher_of(const databento::MboMsg& mbo) const
+    {
+        return m_venue_books ? mbo.hd.publisher_id : ALL_VENUES;
+    }
+
+    // Empty every book and publish it empty, for a new run. Books, dense ids and the published directory stay:
+    // readers on other threads may hold on to them, and instruments seen again get their old book back
+    void reset()
+    {
+        for (auto& book : m_books)
+        {
+            book->clear();
+            book->publish();
+        }
+
+        for (uint32_t dense_id : m_pending_publish) m_is_pending_publish[dense_id] = false;
+        m_pending_publish.clear();
+    }
+
+    // Publish every book applied since the last call, books in the middle of an event stay pending
+    void publish_pending()
+    {
+        size_t kept = 0;
+        for (uint32_t dense_id : m_pending_publish)
+        {
+            OrderBookBase* book = m_books[dense_id].get();
+            if (book->event_open())
+            {
+                m_pending_publish[kept++] = dense_id;
+                continue;
+            }
+
+            book->publish();
+            m_is_pending_publish[dense_id] = false;
+        }
+        m_pending_publish.resize(kept);
+    }
+
+    // After apply_batch(): some book is in the middle of an event (never with event batching off)
+    inline bool has_open_events() const
+    {
+        return !m_pending_publish.empty();
+    }
+
+    // Any thread: book whose published depth can be read, nullptr when unknown
+    const OrderBookBase* find_published(uint32_t instrument_id, uint16_t publisher_id = ALL_VENUES) const
+    {
+        return m_published_books.find(book_key(instrument_id, publisher_id));
+    }
+
+    inline OrderBookBase* get_or_create(uint32_t instrument_id, uint16_t publisher_id = ALL_VENUES)
+    {
+        uint64_t key = book_key(instrument_id, publisher_id);
+        if (key == m_last_key) [[likely]]
+        {
+            return m_last_book;
+        }
+
+        uint32_t dense_id = dense_id_of(key);
+        if (dense_id == NO_INSTRUMENT)
+        {
+            dense_id = create_book(instrument_id, publisher_id);
+        }
+
+        m_last_key = key;
+        m_last_dense_id = dense_id;
+        m_last_book = m_books[dense_id].get();
+        return m_last_book;
+    }
+
+    // nullptr when the book has not been seen yet
+    OrderBookBase* find(uint32_t instrument_id, uint16_t publisher_id = ALL_VENUES) const
+    {
+        uint32_t dense_id = dense_id_of(book_key(instrument_id, publisher_id));
+        return dense_id == NO_INSTRUMENT ? nullptr : m_books[dense_id].get();
+    }
+
+    // Venue books: consolidated view of an instrument, nullptr when none of its venues has been seen yet
+    ConsolidatedBook* find_consolidated(uint32_t instrument_id) const
+    {
+        const uint32_t* index = m_consolidated_ids.find(instrument_id);
+        return index ? m_consolidated[*index].get() : nullptr;
+    }
+
+    inline OrderBookBase* get_by_dense_id(size_t dense_id) const { return m_books[dense_id].get(); }
+    inline uint32_t instrument_id_of(size_t dense_id) const { return m_instrument_ids[dense_id]; }
+    inline uint16_t publisher_id_of(size_t dense_id) const { return m_publisher_ids[dense_id]; }
+    inline size_t size() const { return m_books.size(); }
+    inline bool empty() const { return m_books.empty(); }
+
+    // Distinct instruments, in order of first sight
+    const std::vector<uint32_t>& instrument_ids() const { return m_instruments; }
+
+    // Book count, then per book (dense id order) its instrument_id, publisher_id and OrderBook checkpoint
+    void save_checkpoint(std::vector<char>& out) const
+    {
+        append(out, (uint64_t)m_books.size());
+        for (size_t dense_id = 0; dense_id < m_books.size(); ++dense_id)
+        {
+            append(out, m_instrument_ids[dense_id]);
+            append(out, (uint32_t)m_publisher_ids[dense_id]);
+            m_books[dense_id]->save_checkpoint(out);
+        }
+    }
+
+    // Into an empty (or reset) registry: books are created through the factory if needed, then loaded and published
+    bool load_checkpoint(const char*& pos, const char* end)
+    {
+        uint64_t book_count = 0;
+        if (!read(pos, end, book_count)) return false;
+
+        for (uint64_t i = 0; i < book_count; ++i)
+        {
+            uint32_t instrument_id = 0;
+            uint32_t publisher_id = 0;
+            if (!read(pos, end, instrument_id) || !read(pos, end, publisher_id) || publisher_id > ALL_VENUES) return false;
+            if ((publisher_id != ALL_VENUES) != m_venue_books) return false;     // saved with the other venue mode
+
+            OrderBookBase* book = get_or_create(instrument_id, (uint16_t)publisher_id);
+            if (!book->load_checkpoint(pos, end)) return false;
+            book->publish();
+        }
+        return true;
+    }
+
+private:
+    template <typename T>
+    static inline void append(std::vector<char>& out, const T& value)
+    {
+        size_t pos = out.size();
+        out.resize(pos + sizeof(T));
+        std::memcpy(out.data() + pos, &value, sizeof(T));
+    }
+
+    template <typename T>
+    static inline bool read(const char*& pos, const char* end, T& value)
+    {
+        if ((size_t)(end - pos) < sizeof(T)) return false;
+        std::memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return true;
+    }
+
+    void install_mbp10_writer(OrderBookBase& book)
+    {
+        if (m_mbp10_writer == nullptr)
+        {
+            book.set_mbp10_callback(nullptr);
+            return;
+        }
+
+        book.set_mbp10_callback([writer = m_mbp10_writer](const databento::Mbp10Msg& msg)
+        {
+            writer->write(msg);
+        });
+    }
+
+    void install_signals_callback(uint32_t dense_id)
+    {
+        if (!m_signals_callback)
+        {
+            m_books[dense_id]->set_signals_callback(nullptr);
+            return;
+        }
+
+        m_books[dense_id]->set_signals_callback([this, instrument_id = m_instrument_ids[dense_id], publisher_id = m_publisher_ids[dense_id]](const OrderBook::Signals& signals)
+        {
+            m_signals_callback(instrument_id, publisher_id, signals);
+        });
+    }
+
+    inline void mark_pending_publish(uint32_t dense_id)
+    {
+        if (!m_is_pending_publish[dense_id])
+        {
+            m_is_pending_publish[dense_id] = true;
+            m_pending_publish.push_back(dense_id);
+        }
+    }
+
+    // Direct slot by instrument_id (the venues of an instrument compete for it)
+    inline uint32_t dense_id_of(uint64_t key) const
+    {
+        const DirectSlot& slot = m_direct_slots[key & (DIRECT_SLOTS - 1)];
+        if (slot.key == key)
+        {
+            return slot.dense_id;
+        }
+
+        const uint32_t* dense_id = m_dense_ids.find(key);
+        return dense_id ? *dense_id : NO_INSTRUMENT;
+    }
+
+    uint32_t create_book(uint32_t instrument_id, uint16_t publisher_id)
+    {
+        uint64_t key = book_key(instrument_id, publisher_id);
+        bool new_instrument = dense_id_of(book_key(instrument_id, ALL_VENUES)) == NO_INSTRUMENT && find_consolidated(instrument_id) == nullptr;
+
+        uint32_t dense_id = (uint32_t)m_books.size();
+        m_books.push_back(m_factory(instrument_id));
+        m_books.back()->set_event_batching(m_event_batching);
+        m_books.back()->set_queue_positions(m_queue_positions);
+        m_books.back()->set_bucket_resolutions(m_bucket_resolutions);
+        m_books.back()->set_signal_levels(m_signal_levels);
+        install_mbp10_writer(*m_books.back());
+        m_instrument_ids.push_back(instrument_id);
+        m_publisher_ids.push_back(publisher_id);
+        install_signals_callback(dense_id);
+        m_dense_ids.insert_or_assign(key, dense_id);
+        m_is_pending_publish.push_back(false);
+
+        if (publisher_id != ALL_VENUES)
+        {
+            add_to_consolidated(instrument_id, publisher_id, *m_books.back());
+        }
+        if (new_instrument)
+        {
+            m_instruments.push_back(instrument_id);
+        }
+
+        m_published_books.insert(key, m_books.back().get());
+
+        // First come keeps the direct slot, colliding books go through m_dense_ids
+        DirectSlot& slot = m_direct_slots[key & (DIRECT_SLOTS - 1)];
+        if (slot.key == NO_BOOK)
+        {
+            slot = DirectSlot{key, dense_id};
+        }
+
+        return dense_id;
+    }
+
+    void add_to_consolidated(uint32_t instrument_id, uint16_t publisher_id, OrderBookBase& book)
+    {
+        ConsolidatedBook* consolidated = find_consolidated(instrument_id);
+        if (consolidated == nullptr)
+        {
+            m_consolidated_ids.insert_or_assign(instrument_id, (uint32_t)m_consolidated.size());
+            m_consolidated.push_back(std::make_unique<ConsolidatedBook>());
+            consolidated = m_consolidated.back().get();
+        }
+        consolidated->add_venue(publisher_id, book);
+    }
+};
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include <databento/dbn.hpp>
+#include <spdlog/spdlog.h>
+
+#include <queue/spsc_queue.h>
+#include <hash_map/flat_hash_map.h>
+#include <utils/latency_tracker.h>
+#include <utils/seqlock.h>
+#include <orderbook/orderbook_registry.h>
+#include <coroutine/event_base_manager.h>
+#include <coroutine/task.h>
+#include <coroutine/future.h>
+
+// A pinned EventBase that exclusively owns the books of its instruments.
+// The reader (single producer) pushes MBO messages into the shard queue, the shard drains and applies them
+// on its own thread. Snapshot requests for its instruments run as tasks on the same EventBase, between batches.
+class OrderBookShard
+{
+public:
+    static constexpr size_t MAX_SHARDS = 16;
+
+    // Per-message apply time on the shard thread (us), percentiles over the batches applied since start
+    struct ApplyLatency
+    {
+        double p50 = 0;
+        double p90 = 0;
+        double p99 = 0;
+    };
+
+private:
+    static constexpr size_t QUEUE_SIZE = 65536;     // MBO messages buffered between the reader and the shard
+    static constexpr size_t APPLY_BATCH = 256;      // messages applied before yielding to other tasks on the shard
+    static constexpr size_t OPEN_EVENT_POLLS = 1024; // empty polls for the rest of an open event before yielding anyway
+    static constexpr auto APPLY_LATENCY_PUBLISH_INTERVAL = std::chrono::seconds(1);
+
+    EventBase* m_event_base;
+    OrderBookRegistry m_books;
+    SPSCQueue<databento::MboMsg, QUEUE_SIZE> m_queue;
+
+    std::atomic<bool> m_is_running = false;
+    std::atomic<size_t> m_applied_count = 0;
+    Future<bool>::FutureValue* m_stop_future_value = nullptr;
+
+    // Apply latency: sampled and published by the shard thread, percentiles only computed when asked for
+    LatencyTracker m_apply_stats;
+    SeqLock<ApplyLatency> m_apply_latency;
+    std::atomic<bool> m_apply_latency_wanted = false;
+    std::chrono::steady_clock::time_point m_apply_latency_time;
+
+public:
+    OrderBookShard(EventBase* event_base, OrderBookRegistry::BookFactory factory)
+        : m_event_base(event_base),
+          m_books(std::move(factory))
+    {}
+
+    static EventBase* get_shard_event_base(size_t shard_index)
+    {
+        return EventBaseManager::get_event_base_by_id((EventBaseID)(ORDERBOOK_SHARD_0 + shard_index));
+    }
+
+    // Which shard owns an instrument
+    static inline size_t shard_of(uint32_t instrument_id, size_t num_shards)
+    {
+        return Mix64Hash{}(instrument_id) % num_shards;
+    }
+
+    // Reader side (single producer)
+    inline void push(const databento::MboMsg& mbo)
+    {
+        m_queue.push(mbo);
+    }
+
+    // Before start(), on the shard thread (after the tasks already queued there): drops the messages still queued,
+    // empties the books (kept for reuse, see OrderBookRegistry::reset) and runs `configure(books)`
+    Future<bool> reset(std::function<void(OrderBookRegistry&)> configure)
+    {
+        return Future<bool>([this, configure = std::move(configure)](Future<bool>::FutureValue* future_value)
+        {
+            auto task = reset_async(configure, future_value);
+            task.start_running_on(m_event_base);
+        });
+    }
+
+    void start()
+    {
+        m_is_running.store(true, std::memory_order_release);
+        auto task = run();
+        task.start_running_on(m_event_base);
+    }
+
+    // Resolves once the drain loop has exited, after that the shard can be destroyed
+    Future<bool> stop()
+    {
+        return Future<bool>([this](Future<bool>::FutureValue* future_value)
+        {
+            m_stop_future_value = future_value;
+            m_is_running.store(false, std::memory_order_release);
+        });
+    }
+
+    inline EventBase* get_event_base() const { return m_event_base; }
+    inline const OrderBookRegistry& get_books() const { return m_books; }   // for find_published() only
+    inline size_t applied_count() const { return m_applied_count.load(std::memory_order_relaxed); }
+    inline size_t queue_size() const { return m_queue.size(); }
+
+    // Any thread: apply latency last published by the shard, which publishes again within a second
+    inline ApplyLatency apply_latency()
+    {
+        ApplyLatency apply_latency;
+        m_apply_latency.load(apply_latency);
+        m_apply_latency_wanted.store(true, std::memory_order_relaxed);
+        return apply_latency;
+    }
+
+    // Runs `fn(OrderBookRegistry&)` on the shard thread and returns its Json result
+    template <typename F>
+    Future<Json> run_on_shard(F fn)
+    {
+        return Future<Json>([this, fn = std::move(fn)](Future<Json>::FutureValue* future_value)
+        {
+            auto task = run_on_shard_async(fn, future_value);
+            task.start_running_on(m_event_base);
+        });
+    }
+
+private:
+    template <typename F>
+    Task<void> run_on_shard_async(F fn, Future<Json>::FutureValue* future_value)
+    {
+        future_value->set_value(fn(m_books));
+        co_return;
+    }
+
+    Task<void> reset_async(std::function<void(OrderBookRegistry&)> configure, Future<bool>::FutureValue* future_value)
+    {
+        databento::MboMsg batch[APPLY_BATCH];
+        while (m_queue.pop_batch(batch, APPLY_BATCH) > 0) {}
+
+        m_books.reset();
+        configure(m_books);
+        m_applied_count.store(0, std::memory_order_relaxed);
+        m_apply_stats.clear();
+        m_apply_latency.store(ApplyLatency{});
+
+        future_value->set_value(true);
+        co_return;
+    }
+
+    // Suspend and go back to the end of the EventBase ready queue, so queued tasks (snapshots) can run
+    static Future<bool> yield()
+    {
+        return Future<bool>([](Future<bool>::FutureValue* future_value)
+        {
+            future_value->set_value(true);
+        });
+    }
+
+    Task<void> run()
+    {
+        databento::MboMsg batch[APPLY_BATCH];
+        size_t open_event_polls = 0;   // empty polls in a row while an event is open
+
+        while (m_is_running.load(std::memory_order_acquire))
+        {
+            size_t count = m_queue.pop_batch(batch, APPLY_BATCH);
+            if (count > 0)
+            {
+                auto start = std::chrono::steady_clock::now();
+                m_books.apply_batch(std::span<const databento::MboMsg>(batch, count));
+                auto end = std::chrono::steady_clock::now();
+                m_applied_count.fetch_add(count, std::memory_order_relaxed);
+
+                // Per-message apply latency, averaged over the batch
+                m_apply_stats.add_sample(std::chrono::duration<double, std::micro>(end - start).count() / count);
+                if (m_apply_latency_wanted.load(std::memory_order_relaxed) && end - m_apply_latency_time >= APPLY_LATENCY_PUBLISH_INTERVAL)
+                {
+                    m_apply_latency_time = end;
+                    m_apply_latency_wanted.store(false, std::memory_order_relaxed);
+                    m_apply_latency.store(ApplyLatency{m_apply_stats.p50(), m_apply_stats.p90(), m_apply_stats.p99()});
+                }
+            }
+
+            // Event batching: the rest of an open event is already being pushed, finish it before snapshots run.
+            // Bounded: a reader that stops pushing mid-event (stopped, truncated feed) does not stall the shard's tasks
+            open_event_polls = count > 0 ? 0 : open_event_polls + 1;
+            if (m_books.has_open_events() && open_event_polls < OPEN_EVENT_POLLS) continue;
+
+            open_event_polls = 0;
+            co_await yield();
+        }
+
+        if (m_stop_future_value && m_stop_future_value->is_value_set() == false)
+        {
+            m_stop_future_value->set_value(true);
+        }
+
+        co_return;
+    }
+};
@@ -0,0 +1,114 @@
+#include <orderbook/orderbook_registry.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Apply latency of a registry against the number of reader threads polling its books: readers go through
+// find_published() and the BBO / depth seqlocks, as OrderBookController::read_bbo() and published snapshots do, while
+// this thread applies a synthetic stream in replay-sized batches. Prints ns per message (p50 / p99 over batches).
+static constexpr uint32_t INSTRUMENTS = 16;
+static constexpr size_t MESSAGES = 2000000;
+static constexpr size_t BATCH = 256;    // DbnWrapper apply batch
+
+static std::vector<databento::MboMsg> make_stream()
+{
+    std::mt19937_64 rng(11);
+    std::vector<std::vector<uint64_t>> live(INSTRUMENTS);
+    std::vector<databento::MboMsg> msgs(MESSAGES);
+
+    for (size_t i = 0; i < MESSAGES; ++i)
+    {
+        uint32_t instrument = (uint32_t)((i / 8) % INSTRUMENTS);     // short runs per instrument, like busy feeds
+        std::vector<uint64_t>& orders = live[instrument];
+        uint64_t roll = rng() % 10;
+
+        databento::MboMsg& m = msgs[i];
+        m.hd.instrument_id = 1000 + instrument;
+        m.side = (rng() % 2) ? databento::Side::Bid : databento::Side::Ask;
+        m.price = 10000000 + ((int64_t)(rng() % 100) - 50) * 100;
+        m.size = 1 + (uint32_t)(rng() % 20);
+        m.flags = databento::FlagSet{databento::FlagSet::kLast};
+
+        if (roll < 6 || orders.size() < 16)
+        {
+            m.action = databento::Action::Add;
+            m.order_id = i + 1;
+            orders.push_back(m.order_id);
+        }
+        else
+        {
+            size_t pick = rng() % orders.size();
+            m.order_id = orders[pick];
+            m.action = roll < 9 ? databento::Action::Cancel : databento::Action::Modify;
+            if (m.action == databento::Action::Cancel)
+            {
+                orders[pick] = orders.back();
+                orders.pop_back();
+            }
+        }
+    }
+    return msgs;
+}
+
+int main()
+{
+    std::vector<databento::MboMsg> msgs = make_stream();
+    OrderBookRegistry registry([](uint32_t)
+    {
+        return std::make_unique<OrderBook>(4096, 100, nullptr);
+    });
+
+    std::printf("Registry apply vs readers, %zu messages over %u instruments in batches of %zu, %u hardware threads\n",
+                msgs.size(), INSTRUMENTS, BATCH, std::thread::hardware_concurrency());
+
+    for (size_t num_readers : {0, 1, 2, 4})
+    {
+        registry.reset();
+        registry.apply_batch(std::span<const databento::MboMsg>(msgs.data(), INSTRUMENTS * 8));   // every book exists
+
+        std::atomic<bool> done = false;
+        std::atomic<uint64_t> reads = 0;
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < num_readers; ++r)
+        {
+            readers.emplace_back([&, r]()
+            {
+                OrderBook::Bbo bbo;
+                OrderBook::PublishedDepth depth;
+                uint64_t count = 0;
+                for (uint32_t i = (uint32_t)r; !done.load(std::memory_order_relaxed); ++i, ++count)
+                {
+                    const OrderBookBase* book = registry.find_published(1000 + i % INSTRUMENTS);
+                    if (i % 16 == 0) book->read_published(depth);
+                    else book->read_bbo(bbo);
+                }
+                reads.fetch_add(count, std::memory_order_relaxed);
+            });
+        }
+
+        std::vector<double> ns_per_msg;
+        ns_per_msg.reserve(msgs.size() / BATCH + 1);
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t begin = 0; begin < msgs.size(); begin += BATCH)
+        {
+            size_t count = std::min(BATCH, msgs.size() - begin);
+            auto start = std::chrono::steady_clock::now();
+            registry.apply_batch(std::span<const databento::MboMsg>(msgs.data() + begin, count));
+            ns_per_msg.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        done.store(true, std::memory_order_relaxed);
+        for (std::thread& reader : readers) reader.join();
+
+        std::sort(ns_per_msg.begin(), ns_per_msg.end());
+        std::printf("readers %zu: apply p50 %.1f ns/msg, p99 %.1f ns/msg, %.2f M msg/s, %.1f M reads/s\n", num_readers,
+                    ns_per_msg[ns_per_msg.size() / 2], ns_per_msg[ns_per_msg.size() * 99 / 100], msgs.size() / seconds / 1e6, reads.load() / seconds / 1e6);
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#include <utils/seqlock.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// Top-of-book sized block (see OrderBook::Bbo)
+struct Top
+{
+    uint64_t values[5];
+};
+
+// One writer publishing a top-of-book block while a reader polls it: ns per reader load, split vs same cache line
+// layout of the SeqLock
+template <bool SAME_CACHE_LINE>
+static double reader_ns_per_load(bool with_writer, uint64_t& torn)
+{
+    static SeqLock<Top, SAME_CACHE_LINE> lock;
+    constexpr uint64_t LOADS = 2000000;
+    std::atomic<bool> done = false;
+
+    std::thread writer([&]()
+    {
+        for (uint64_t i = 1; with_writer && !done.load(std::memory_order_relaxed); ++i)
+        {
+            lock.write([i](Top& t)
+            {
+                for (uint64_t& v : t.values) v = i;
+            });
+        }
+    });
+
+    Top out;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < LOADS; ++i)
+    {
+        lock.load(out);
+        if (out.values[4] != out.values[0]) torn++;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    done = true;
+    writer.join();
+
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / LOADS;
+}
+
+int main()
+{
+    uint64_t torn = 0;
+    double split_idle = reader_ns_per_load<false>(false, torn);
+    double packed_idle = reader_ns_per_load<true>(false, torn);
+    double split_busy = reader_ns_per_load<false>(true, torn);
+    double packed_busy = reader_ns_per_load<true>(true, torn);
+
+    std::printf("SeqLock<Top> ns per load, no writer: split %.1f, same line %.1f | writer spinning: split %.1f, same line %.1f\n",
+                split_idle, packed_idle, split_busy, packed_busy);
+    if (torn != 0)
+    {
+        std::printf("%lu torn reads\n", torn);
+        return 1;
+    }
+    return 0;
+}
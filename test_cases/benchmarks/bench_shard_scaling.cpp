@@ -0,0 +1,117 @@
+#include <orderbook/orderbook_shard.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Sharded apply throughput against the shard count: this thread plays the reader and pushes a synthetic stream over
+// INSTRUMENTS instruments into the shard queues, timed until every shard has applied its part. Shard counts stop at
+// the hardware threads left beside the reader: pinned shards sharing a core only measure the scheduler.
+static constexpr uint32_t INSTRUMENTS = 16;
+static constexpr size_t MESSAGES = 2000000;
+
+// Adds, cancels and modifies of resting orders around a fixed mid, instruments interleaved
+static std::vector<databento::MboMsg> make_stream()
+{
+    std::mt19937_64 rng(7);
+    std::vector<std::vector<uint64_t>> live(INSTRUMENTS);
+    std::vector<databento::MboMsg> msgs(MESSAGES);
+
+    for (size_t i = 0; i < MESSAGES; ++i)
+    {
+        uint32_t instrument = (uint32_t)(rng() % INSTRUMENTS);
+        std::vector<uint64_t>& orders = live[instrument];
+        uint64_t roll = rng() % 10;
+
+        databento::MboMsg& m = msgs[i];
+        m.hd.instrument_id = 1000 + instrument;
+        m.side = (rng() % 2) ? databento::Side::Bid : databento::Side::Ask;
+        m.price = 10000000 + ((int64_t)(rng() % 100) - 50) * 100;
+        m.size = 1 + (uint32_t)(rng() % 20);
+        m.flags = databento::FlagSet{databento::FlagSet::kLast};
+
+        if (roll < 6 || orders.size() < 16)
+        {
+            m.action = databento::Action::Add;
+            m.order_id = i + 1;
+            orders.push_back(m.order_id);
+        }
+        else
+        {
+            size_t pick = rng() % orders.size();
+            m.order_id = orders[pick];
+            m.action = roll < 9 ? databento::Action::Cancel : databento::Action::Modify;
+            if (m.action == databento::Action::Cancel)
+            {
+                orders[pick] = orders.back();
+                orders.pop_back();
+            }
+        }
+    }
+    return msgs;
+}
+
+static Task<void> stop_shard(OrderBookShard& shard)
+{
+    co_await shard.stop();
+}
+
+// Messages per second through `num_shards` fresh shards
+static double run(const std::vector<databento::MboMsg>& msgs, size_t num_shards)
+{
+    auto factory = [](uint32_t)
+    {
+        return std::make_unique<OrderBook>(4096, 100, nullptr);
+    };
+
+    std::vector<std::unique_ptr<OrderBookShard>> shards;
+    for (size_t i = 0; i < num_shards; ++i)
+    {
+        shards.push_back(std::make_unique<OrderBookShard>(OrderBookShard::get_shard_event_base(i), factory));
+        shards.back()->start();
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (const databento::MboMsg& mbo : msgs)
+    {
+        shards[OrderBookShard::shard_of(mbo.hd.instrument_id, num_shards)]->push(mbo);
+    }
+
+    size_t applied = 0;
+    while (applied < msgs.size())
+    {
+        applied = 0;
+        for (auto& shard : shards) applied += shard->applied_count();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    for (auto& shard : shards)
+    {
+        stop_shard(*shard).start_running_on(shard->get_event_base()).wait();
+    }
+
+    return msgs.size() / std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main()
+{
+    std::vector<databento::MboMsg> msgs = make_stream();
+    std::printf("Sharded apply, %zu messages over %u instruments, %u hardware threads\n", msgs.size(), INSTRUMENTS, std::thread::hardware_concurrency());
+
+    size_t max_shards = std::clamp<size_t>(std::thread::hardware_concurrency(), 2, std::min<size_t>(8, OrderBookShard::MAX_SHARDS) + 1) - 1;
+    double single = 0;
+    for (size_t num_shards = 1; num_shards <= max_shards; num_shards *= 2)
+    {
+        double rate = run(msgs, num_shards);
+        if (num_shards == 1) single = rate;
+        std::printf("shards %zu: %.2f M msg/s, x%.2f\n", num_shards, rate / 1e6, rate / single);
+    }
+
+    // The EventBase threads run for the life of the process (as in the server), they are never joined
+    std::fflush(stdout);
+    std::_Exit(0);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include <hash_map/atomic_pointer_map.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/***********************************************
+ * TEST 1: Insert / find, keys sharing their low
+ * bits probe past each other
+ ***********************************************/
+TEST(AtomicPointerMap, InsertFind)
+{
+    std::vector<int> values(4);
+    AtomicPointerMap<int> map(16);
+
+    ASSERT_TRUE(map.insert(3, &values[0]));
+    ASSERT_TRUE(map.insert(3 + (1ULL << 32), &values[1]));     // same low bits: same first slot
+    ASSERT_TRUE(map.insert(4, &values[2]));
+
+    ASSERT_EQ(map.size(), 3);
+    ASSERT_EQ(map.find(3), &values[0]);
+    ASSERT_EQ(map.find(3 + (1ULL << 32)), &values[1]);
+    ASSERT_EQ(map.find(4), &values[2]);
+    ASSERT_EQ(map.find(5), nullptr);
+
+    // Inserted once, EmptyKey rejected
+    ASSERT_FALSE(map.insert(3, &values[3]));
+    ASSERT_EQ(map.find(3), &values[0]);
+    ASSERT_FALSE(map.insert(UINT64_MAX, &values[3]));
+    ASSERT_EQ(map.find(UINT64_MAX), nullptr);
+}
+
+/***********************************************
+ * TEST 2: The map grows past its initial
+ * capacity, every key stays reachable
+ ***********************************************/
+TEST(AtomicPointerMap, GrowsPastInitialCapacity)
+{
+    constexpr uint64_t COUNT = 10000;
+    std::vector<uint64_t> values(COUNT);
+    AtomicPointerMap<uint64_t> map(16);
+
+    for (uint64_t i = 0; i < COUNT; ++i)
+    {
+        values[i] = i;
+        ASSERT_TRUE(map.insert((i % 3) << 32 | i, &values[i]));
+    }
+
+    ASSERT_EQ(map.size(), COUNT);
+    ASSERT_GE(map.capacity(), 2 * COUNT);
+    for (uint64_t i = 0; i < COUNT; ++i)
+    {
+        ASSERT_EQ(map.find((i % 3) << 32 | i), &values[i]);
+        ASSERT_EQ(map.find(((i % 3) + 1) << 32 | i), nullptr);
+    }
+}
+
+/***********************************************
+ * TEST 3: A reader on another thread, probing
+ * while the writer inserts and grows the map,
+ * only ever finds the right value or nothing
+ ***********************************************/
+TEST(AtomicPointerMap, ConcurrentReaderWhileGrowing)
+{
+    constexpr uint64_t COUNT = 50000;
+    std::vector<uint64_t> values(COUNT);
+    for (uint64_t i = 0; i < COUNT; ++i) values[i] = i;
+
+    AtomicPointerMap<const uint64_t> map(16);
+    std::atomic<bool> done = false;
+    std::atomic<uint64_t> wrong = 0;
+    std::atomic<uint64_t> found = 0;
+
+    std::thread reader([&]()
+    {
+        while (!done.load(std::memory_order_acquire))
+        {
+            for (uint64_t i = 0; i < COUNT; i += 97)
+            {
+                const uint64_t* value = map.find(i);
+                if (value == nullptr) continue;
+                if (*value != i) wrong.fetch_add(1, std::memory_order_relaxed);
+                found.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    });
+
+    for (uint64_t i = 0; i < COUNT; ++i)
+    {
+        map.insert(i, &values[i]);
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    ASSERT_EQ(wrong.load(), 0);
+    for (uint64_t i = 0; i < COUNT; ++i)
+    {
+        ASSERT_EQ(map.find(i), &values[i]);
+    }
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <dbn_wrapper/dbn_wrapper.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using databento::MboMsg;
+
+static MboMsg make_mbo(uint64_t order_id)
+{
+    MboMsg m{};
+    m.hd.length = sizeof(MboMsg) / databento::RecordHeader::kLengthMultiplier;
+    m.hd.rtype = databento::RType::Mbo;
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = 100000 + (int64_t)order_id;
+    m.size = 1;
+    m.action = databento::Action::Add;
+    m.side = databento::Side::Bid;
+    m.ts_recv = databento::UnixNanos{std::chrono::nanoseconds{order_id}};
+    m.sequence = (uint32_t)order_id;
+    return m;
+}
+
+// DBN bytes: metadata prefix with a dataset, `count` MBO records (order ids 1..count) with a 32-byte record of
+// another type every 1000 records
+static std::vector<char> make_dbn(size_t count)
+{
+    std::vector<char> data = {'D', 'B', 'N', 3};
+    uint32_t length = 24;
+    data.insert(data.end(), (const char*)&length, (const char*)&length + sizeof(length));
+    std::string dataset = "TEST.MBO";
+    dataset.resize(length, '\0');
+    data.insert(data.end(), dataset.begin(), dataset.end());
+
+    for (size_t i = 1; i <= count; ++i)
+    {
+        if (i % 1000 == 0)
+        {
+            char other[32] = {};
+            other[0] = sizeof(other) / databento::RecordHeader::kLengthMultiplier;
+            other[1] = (char)databento::RType::Mbp1;
+            data.insert(data.end(), other, other + sizeof(other));
+        }
+
+        MboMsg m = make_mbo(i);
+        data.insert(data.end(), (const char*)&m, (const char*)&m + sizeof(m));
+    }
+    return data;
+}
+
+static std::string write_file(const std::string& name, const std::vector<char>& data)
+{
+    std::string path = ::testing::TempDir() + name;
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::fwrite(data.data(), 1, data.size(), file);
+    std::fclose(file);
+    return path;
+}
+
+// Every MBO record of the file in order, read in batches of at most `max_count`
+static void expect_reads_all(DbnFileReader& reader, size_t count, size_t max_count)
+{
+    ASSERT_EQ(reader.version(), 3);
+    ASSERT_EQ(reader.dataset(), "TEST.MBO");
+
+    uint64_t expected = 1;
+    std::span<const MboMsg> batch;
+    while (!(batch = reader.next_mbo_batch(max_count)).empty())
+    {
+        ASSERT_LE(batch.size(), max_count);
+        ASSERT_EQ((uintptr_t)batch.data() % alignof(MboMsg), 0);
+        for (const MboMsg& mbo : batch)
+        {
+            ASSERT_EQ(mbo.order_id, expected++);
+        }
+    }
+    ASSERT_EQ(expected, count + 1);
+}
+
+/***********************************************
+ * TEST 1: Plain DBN is read in place, runs of
+ * MBO records stop at records of other types
+ ***********************************************/
+TEST(DbnFileReader, ReadsMappedFileInPlace)
+{
+    std::string path = write_file("dbn_reader_test.dbn", make_dbn(5500));
+
+    DbnFileReader reader(path);
+    ASSERT_FALSE(reader.compressed());
+
+    std::span<const MboMsg> batch = reader.next_mbo_batch(SIZE_MAX);
+    ASSERT_EQ(batch.size(), 999);       // up to the first non-MBO record
+    ASSERT_EQ(batch.back().order_id, 999);
+    expect_reads_all(*std::make_unique<DbnFileReader>(path), 5500, 300);
+
+    std::remove(path.c_str());
+}
+
+/***********************************************
+ * TEST 2: zstd input spanning several buffer
+ * refills gives the same records
+ ***********************************************/
+TEST(DbnFileReader, StreamsCompressedFile)
+{
+    size_t count = DbnFileReader::ZSTD_BUFFER_SIZE / sizeof(MboMsg) * 2 + 123;
+    std::vector<char> plain = make_dbn(count);
+
+    std::vector<char> compressed(ZSTD_compressBound(plain.size()));
+    size_t size = ZSTD_compress(compressed.data(), compressed.size(), plain.data(), plain.size(), 1);
+    ASSERT_FALSE(ZSTD_isError(size));
+    compressed.resize(size);
+    std::string path = write_file("dbn_reader_test.dbn.zst", compressed);
+
+    DbnFileReader reader(path);
+    ASSERT_TRUE(reader.compressed());
+    expect_reads_all(reader, count, SIZE_MAX);
+
+    std::remove(path.c_str());
+}
+
+/***********************************************
+ * TEST 3: Checkpoint resume skips exactly the
+ * saved number of records, rejects a mismatch
+ ***********************************************/
+TEST(DbnFileReader, WrapperSkipsRecords)
+{
+    std::string path = write_file("dbn_reader_skip_test.dbn", make_dbn(3000));
+
+    DbnWrapper wrapper(path);
+    ASSERT_TRUE(wrapper.skip_records(2500, 2500, 2500));
+
+    DbnWrapper mismatch(path);
+    ASSERT_FALSE(mismatch.skip_records(2500, 2499, 2499));
+
+    DbnWrapper past_end(path);
+    ASSERT_FALSE(past_end.skip_records(3001, 3000, 3000));
+
+    std::remove(path.c_str());
+}
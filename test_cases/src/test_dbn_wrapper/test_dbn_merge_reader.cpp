@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include <dbn_wrapper/dbn_wrapper.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using databento::MboMsg;
+
+static MboMsg make_mbo(uint64_t order_id, uint64_t ts_recv, uint32_t sequence)
+{
+    MboMsg m{};
+    m.hd.length = sizeof(MboMsg) / databento::RecordHeader::kLengthMultiplier;
+    m.hd.rtype = databento::RType::Mbo;
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = 100000;
+    m.size = 1;
+    m.action = databento::Action::Add;
+    m.side = databento::Side::Bid;
+    m.ts_recv = databento::UnixNanos{std::chrono::nanoseconds{ts_recv}};
+    m.sequence = sequence;
+    return m;
+}
+
+// DBN file of the given records, with a 32-byte record of another type every 500 records
+static std::string write_dbn(const std::string& name, const std::vector<MboMsg>& records)
+{
+    std::vector<char> data = {'D', 'B', 'N', 3};
+    uint32_t length = 24;
+    data.insert(data.end(), (const char*)&length, (const char*)&length + sizeof(length));
+    std::string dataset = "TEST.MBO";
+    dataset.resize(length, '\0');
+    data.insert(data.end(), dataset.begin(), dataset.end());
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (i % 500 == 499)
+        {
+            char other[32] = {};
+            other[0] = sizeof(other) / databento::RecordHeader::kLengthMultiplier;
+            other[1] = (char)databento::RType::Mbp1;
+            data.insert(data.end(), other, other + sizeof(other));
+        }
+        data.insert(data.end(), (const char*)&records[i], (const char*)&records[i] + sizeof(MboMsg));
+    }
+
+    std::string path = ::testing::TempDir() + name;
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::fwrite(data.data(), 1, data.size(), file);
+    std::fclose(file);
+    return path;
+}
+
+// Every record of the reader, in batches of at most `max_count`
+static std::vector<MboMsg> read_all(DbnMergeReader& reader, size_t max_count)
+{
+    std::vector<MboMsg> records;
+    std::span<const MboMsg> batch;
+    while (!(batch = reader.next_mbo_batch(max_count)).empty())
+    {
+        EXPECT_LE(batch.size(), max_count);
+        records.insert(records.end(), batch.begin(), batch.end());
+    }
+    return records;
+}
+
+/***********************************************
+ * TEST 1: Overlapping files come out in global
+ * (ts_recv, sequence) order, equal keys in
+ * file order
+ ***********************************************/
+TEST(DbnMergeReader, MergesByTsRecvThenSequence)
+{
+    // order_id = file * 1'000'000 + index in the file
+    std::vector<std::vector<MboMsg>> files(3);
+    for (uint64_t i = 0; i < 3000; ++i)
+    {
+        files[0].push_back(make_mbo(i, 1000 + i * 3, 0));                       // every 3 ns
+        files[1].push_back(make_mbo(1'000'000 + i, 1000 + i * 7, (uint32_t)i)); // every 7 ns
+        files[2].push_back(make_mbo(2'000'000 + i, 1000 + (i / 10) * 5, (uint32_t)(i % 10)));  // bursts of 10
+    }
+
+    std::vector<std::string> paths;
+    for (size_t f = 0; f < files.size(); ++f)
+    {
+        paths.push_back(write_dbn("dbn_merge_test_" + std::to_string(f) + ".dbn", files[f]));
+    }
+
+    for (size_t max_count : {SIZE_MAX, (size_t)7})
+    {
+        DbnMergeReader reader(paths);
+        ASSERT_EQ(reader.file_count(), 3);
+        std::vector<MboMsg> merged = read_all(reader, max_count);
+        ASSERT_EQ(merged.size(), 9000);
+
+        std::vector<uint64_t> next_index(3, 0);
+        for (size_t i = 0; i < merged.size(); ++i)
+        {
+            // Each file in its own order
+            size_t f = merged[i].order_id / 1'000'000;
+            ASSERT_EQ(merged[i].order_id % 1'000'000, next_index[f]++);
+
+            if (i == 0) continue;
+            auto key = [](const MboMsg& m) { return std::make_tuple(m.ts_recv.time_since_epoch().count(), m.sequence, m.order_id / 1'000'000); };
+            ASSERT_LT(key(merged[i - 1]), key(merged[i]));
+        }
+    }
+
+    for (const std::string& path : paths) std::remove(path.c_str());
+}
+
+/***********************************************
+ * TEST 2: Files one after the other (days) are
+ * copied in whole runs, one file is read in
+ * place
+ ***********************************************/
+TEST(DbnMergeReader, DisjointFilesAndSingleFile)
+{
+    std::vector<MboMsg> day1, day2;
+    for (uint64_t i = 0; i < 3000; ++i)
+    {
+        day1.push_back(make_mbo(i, 1'000'000 + i, 0));
+        day2.push_back(make_mbo(3000 + i, 9'000'000 + i, 0));
+    }
+    std::string path1 = write_dbn("dbn_merge_day1.dbn", day1);
+    std::string path2 = write_dbn("dbn_merge_day2.dbn", day2);
+
+    // Later day first on the command line: still replayed in time order
+    DbnMergeReader reader({path2, path1});
+    std::span<const MboMsg> batch = reader.next_mbo_batch(SIZE_MAX);
+    ASSERT_EQ(batch.size(), DbnMergeReader::MERGE_BATCH); // day 1 (runs up to each non-MBO record) then the start of day 2
+    ASSERT_EQ(batch.front().order_id, 0);
+
+    std::vector<MboMsg> merged(batch.begin(), batch.end());
+    std::vector<MboMsg> rest = read_all(reader, SIZE_MAX);
+    merged.insert(merged.end(), rest.begin(), rest.end());
+    ASSERT_EQ(merged.size(), 6000);
+    for (size_t i = 0; i < merged.size(); ++i)
+    {
+        ASSERT_EQ(merged[i].order_id, i);
+    }
+
+    // One file: same batches as its own reader
+    DbnMergeReader single({path1});
+    DbnFileReader plain(path1);
+    std::span<const MboMsg> merged_batch;
+    while (!(merged_batch = single.next_mbo_batch(SIZE_MAX)).empty())
+    {
+        std::span<const MboMsg> plain_batch = plain.next_mbo_batch(SIZE_MAX);
+        ASSERT_EQ(merged_batch.size(), plain_batch.size());
+        ASSERT_EQ(std::memcmp(merged_batch.data(), plain_batch.data(), plain_batch.size_bytes()), 0);
+    }
+    ASSERT_TRUE(plain.next_mbo_batch(SIZE_MAX).empty());
+
+    std::remove(path1.c_str());
+    std::remove(path2.c_str());
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+#include <dbn_wrapper/dbn_record_ring.h>
+
+#include <thread>
+#include <vector>
+
+using databento::MboMsg;
+
+static std::vector<MboMsg> make_records(size_t count)
+{
+    std::vector<MboMsg> records(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        records[i].order_id = i + 1;
+    }
+    return records;
+}
+
+/***********************************************
+ * TEST 1: Batch pushes stop at the free room,
+ * wrap around the end of the ring and count
+ * the stalls of each side
+ ***********************************************/
+TEST(DbnRecordRing, BatchPushWrapsAndCountsStalls)
+{
+    auto ring = std::make_unique<DbnRecordRing>();
+    std::vector<MboMsg> records = make_records(DbnRecordRing::capacity() + 100);
+    std::vector<MboMsg> out(DbnRecordRing::capacity());
+
+    ASSERT_EQ(ring->pop_batch(out.data(), out.size(), true), 0);
+    ASSERT_EQ(ring->pop_batch(out.data(), out.size(), false), 0);     // reader done: not a stall
+
+    // Full after `capacity` records
+    ASSERT_EQ(ring->push_batch(records.data(), records.size()), DbnRecordRing::capacity());
+    ASSERT_EQ(ring->push_batch(records.data() + DbnRecordRing::capacity(), 100), 0);
+
+    ASSERT_EQ(ring->pop_batch(out.data(), 300, true), 300);
+    ASSERT_EQ(out[0].order_id, 1);
+    ASSERT_EQ(out[299].order_id, 300);
+
+    // The last 100 go behind the wrap point
+    ASSERT_EQ(ring->push_batch(records.data() + DbnRecordRing::capacity(), 100), 100);
+    uint64_t expected = 301;
+    size_t count = 0;
+    while ((count = ring->pop_batch(out.data(), out.size(), false)) > 0)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            ASSERT_EQ(out[i].order_id, expected++);
+        }
+    }
+    ASSERT_EQ(expected, DbnRecordRing::capacity() + 101);
+
+    DbnRecordRing::Stats stats = ring->stats();
+    ASSERT_EQ(stats.records, DbnRecordRing::capacity() + 100);
+    ASSERT_EQ(stats.reader_stalls, 2);
+    ASSERT_EQ(stats.apply_stalls, 1);
+    ASSERT_EQ(stats.max_occupancy, DbnRecordRing::capacity());
+    ASSERT_EQ(stats.occupancy, 0);
+
+    Json json = ring->stats_json();
+    ASSERT_EQ((std::string)json["bottleneck"], "apply");
+
+    ring->reset();
+    ASSERT_EQ(ring->stats().records, 0);
+}
+
+/***********************************************
+ * TEST 2: Reader and apply threads, every
+ * record arrives once and in order
+ ***********************************************/
+TEST(DbnRecordRing, ThreadedTransferKeepsOrder)
+{
+    auto ring = std::make_unique<DbnRecordRing>();
+    std::vector<MboMsg> records = make_records(1000000);
+    std::atomic<bool> reader_done = false;
+
+    std::thread reader([&]
+    {
+        size_t pushed = 0;
+        while (pushed < records.size())
+        {
+            pushed += ring->push_batch(records.data() + pushed, std::min<size_t>(records.size() - pushed, 4096));
+        }
+        reader_done.store(true, std::memory_order_release);
+    });
+
+    std::vector<MboMsg> out(256);
+    uint64_t expected = 1;
+    while (true)
+    {
+        bool done = reader_done.load(std::memory_order_acquire);
+        size_t count = ring->pop_batch(out.data(), out.size(), !done);
+        if (count == 0 && done) break;
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            ASSERT_EQ(out[i].order_id, expected++);
+        }
+    }
+    reader.join();
+
+    ASSERT_EQ(expected, records.size() + 1);
+    ASSERT_EQ(ring->stats().records, records.size());
+}
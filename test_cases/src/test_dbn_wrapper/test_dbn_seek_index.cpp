@@ -0,0 +1,245 @@
+#include <gtest/gtest.h>
+#include <dbn_wrapper/dbn_wrapper.h>
+#include <dbn_wrapper/dbn_seek_index.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using databento::MboMsg;
+
+// Record i: order id i, ts_recv 1000 + 10 * i, instruments 1 and 2 alternating
+static MboMsg make_mbo(uint64_t i, databento::Action action = databento::Action::Add)
+{
+    MboMsg m{};
+    m.hd.length = sizeof(MboMsg) / databento::RecordHeader::kLengthMultiplier;
+    m.hd.rtype = databento::RType::Mbo;
+    m.hd.instrument_id = (uint32_t)(i % 2 + 1);
+    m.hd.publisher_id = 1;
+    m.order_id = i;
+    m.price = 100000;
+    m.size = 1;
+    m.action = action;
+    m.side = databento::Side::Bid;
+    m.ts_recv = databento::UnixNanos{std::chrono::nanoseconds{1000 + 10 * i}};
+    m.sequence = (uint32_t)i;
+    return m;
+}
+
+// DBN bytes of `count` records, instrument 1 cleared at record 5000 and instrument 2 at record 7001, with a 32-byte
+// record of another type every 1000 records
+static std::vector<char> make_dbn(size_t count)
+{
+    std::vector<char> data = {'D', 'B', 'N', 3};
+    uint32_t length = 24;
+    data.insert(data.end(), (const char*)&length, (const char*)&length + sizeof(length));
+    std::string dataset = "TEST.MBO";
+    dataset.resize(length, '\0');
+    data.insert(data.end(), dataset.begin(), dataset.end());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i % 1000 == 999)
+        {
+            char other[32] = {};
+            other[0] = sizeof(other) / databento::RecordHeader::kLengthMultiplier;
+            other[1] = (char)databento::RType::Mbp1;
+            data.insert(data.end(), other, other + sizeof(other));
+        }
+
+        MboMsg m = make_mbo(i, i == 5000 || i == 7001 ? databento::Action::Clear : databento::Action::Add);
+        data.insert(data.end(), (const char*)&m, (const char*)&m + sizeof(m));
+    }
+    return data;
+}
+
+static std::string write_file(const std::string& name, const std::vector<char>& data)
+{
+    std::string path = ::testing::TempDir() + name;
+    FILE* file = std::fopen(path.c_str(), "wb");
+    std::fwrite(data.data(), 1, data.size(), file);
+    std::fclose(file);
+    return path;
+}
+
+/***********************************************
+ * TEST 1: Entries every `interval` records with
+ * the earliest reset over every book, lookups
+ * by ts_recv and by record
+ ***********************************************/
+TEST(DbnSeekIndex, BuildsEntriesWithResetPoints)
+{
+    std::string path = write_file("dbn_seek_test.dbn", make_dbn(10000));
+    std::string index_path = DbnSeekIndex::path_for(path);
+    ASSERT_TRUE(DbnSeekIndex::build(path, index_path, 1024));
+
+    DbnSeekIndex index;
+    ASSERT_TRUE(index.load(index_path, path));
+    ASSERT_EQ(index.record_count(), 10000);
+    ASSERT_EQ(index.entries().size(), 10);
+
+    for (const DbnSeekIndex::Entry& entry : index.entries())
+    {
+        ASSERT_EQ(entry.ts_recv, 1000 + 10 * entry.record_index);
+        ASSERT_EQ(entry.sequence, entry.record_index);
+
+        // Instrument 1 rebuilt from its first record (0) then from its clear (5000), instrument 2 from 1 then 7001
+        uint64_t expected = entry.record_index < 5000 ? 0 : entry.record_index < 7001 ? 1 : 5000;
+        ASSERT_EQ(entry.reset_record_index, expected);
+    }
+
+    ASSERT_EQ(index.find_before(1000), nullptr);
+    ASSERT_EQ(index.find_before(1001)->record_index, 0);
+    ASSERT_EQ(index.find_before(1000 + 10 * 3072)->record_index, 2048);
+    ASSERT_EQ(index.find_before(UINT64_MAX)->record_index, 9216);
+    ASSERT_EQ(index.find_record(3071)->record_index, 2048);
+    ASSERT_EQ(index.find_record(3072)->record_index, 3072);
+
+    // Built for another file size: stale
+    std::string other_path = write_file("dbn_seek_other.dbn", make_dbn(10001));
+    ASSERT_FALSE(index.load(index_path, other_path));
+
+    // Same size, but the file was regenerated and replaced: stale
+    std::string new_path = write_file("dbn_seek_test.dbn.new", make_dbn(10000));
+    ASSERT_EQ(std::rename(new_path.c_str(), path.c_str()), 0);
+    ASSERT_FALSE(index.load(index_path, path));
+
+    std::remove(path.c_str());
+    std::remove(other_path.c_str());
+    std::remove(index_path.c_str());
+}
+
+/***********************************************
+ * TEST 2: Seeking to indexed offsets of plain
+ * and compressed files continues at the
+ * indexed record, backwards too
+ ***********************************************/
+TEST(DbnSeekIndex, SeeksPlainAndCompressedFiles)
+{
+    size_t count = DbnFileReader::ZSTD_BUFFER_SIZE / sizeof(MboMsg) * 2 + 123;
+    std::vector<char> plain = make_dbn(count);
+
+    std::vector<char> compressed(ZSTD_compressBound(plain.size()));
+    size_t size = ZSTD_compress(compressed.data(), compressed.size(), plain.data(), plain.size(), 1);
+    ASSERT_FALSE(ZSTD_isError(size));
+    compressed.resize(size);
+
+    for (const auto& [name, data] : {std::make_pair("dbn_seek_plain.dbn", &plain), std::make_pair("dbn_seek_zstd.dbn.zst", &compressed)})
+    {
+        std::string path = write_file(name, *data);
+        std::string index_path = DbnSeekIndex::path_for(path);
+
+        DbnSeekIndex index;
+        ASSERT_TRUE(index.load_or_build(path));
+        ASSERT_EQ(index.record_count(), count);
+
+        DbnFileReader reader(path);
+        for (size_t i : {index.entries().size() - 1, (size_t)3, index.entries().size() / 2, (size_t)0})
+        {
+            const DbnSeekIndex::Entry& entry = index.entries()[i];
+            ASSERT_TRUE(reader.seek(entry.offset));
+            std::span<const MboMsg> batch = reader.next_mbo_batch(SIZE_MAX);
+            ASSERT_FALSE(batch.empty());
+            ASSERT_EQ(batch.front().order_id, entry.record_index);
+        }
+
+        std::remove(path.c_str());
+        std::remove(index_path.c_str());
+    }
+}
+
+/***********************************************
+ * TEST 3: Seek to the reset point, then fast
+ * forward (chunked) stops right before the start
+ * ts_recv
+ ***********************************************/
+TEST(DbnSeekIndex, WrapperFastForwardsToTimestamp)
+{
+    std::string path = write_file("dbn_seek_wrapper.dbn", make_dbn(10000));
+    ASSERT_TRUE(DbnSeekIndex::build(path, DbnSeekIndex::path_for(path), 1024));
+    DbnSeekIndex index;
+    ASSERT_TRUE(index.load_or_build(path));
+
+    // Start at record 8000
+    uint64_t start_ts_recv = 1000 + 10 * 8000;
+    const DbnSeekIndex::Entry* entry = index.find_before(start_ts_recv);
+    ASSERT_NE(entry, nullptr);
+    ASSERT_EQ(entry->reset_record_index, 5000);
+
+    DbnWrapper wrapper(path);
+    ASSERT_TRUE(wrapper.seek(entry->reset_offset));
+
+    std::vector<MboMsg> replayed;
+    auto collect = [&](std::span<const MboMsg> records) { replayed.insert(replayed.end(), records.begin(), records.end()); };
+    // In chunks, as the controller does between yields
+    ASSERT_EQ(wrapper.fast_forward(start_ts_recv, collect, 1024), 1024);
+    ASSERT_EQ(wrapper.fast_forward(start_ts_recv, collect, 1024), 1024);
+    ASSERT_EQ(wrapper.fast_forward(start_ts_recv, collect, 1024), 952);
+    ASSERT_EQ(wrapper.fast_forward(start_ts_recv, collect, 1024), 0);
+    ASSERT_EQ(replayed.size(), 3000);
+    ASSERT_EQ(replayed.front().order_id, 5000);
+    ASSERT_EQ(replayed.back().order_id, 7999);
+
+    // The replay continues at the start
+    replayed.clear();
+    ASSERT_EQ(wrapper.fast_forward(UINT64_MAX, collect), 2000);
+    ASSERT_EQ(replayed.front().order_id, 8000);
+
+    std::remove(path.c_str());
+    std::remove(DbnSeekIndex::path_for(path).c_str());
+}
+
+/***********************************************
+ * TEST 4: A checkpoint resumes at the offset of
+ * the last record handed over, plain and
+ * compressed, and checks that record
+ ***********************************************/
+TEST(DbnSeekIndex, WrapperResumesAtLastRecordOffset)
+{
+    size_t count = DbnFileReader::ZSTD_BUFFER_SIZE / sizeof(MboMsg) * 2 + 123;
+    std::vector<char> plain = make_dbn(count);
+
+    std::vector<char> compressed(ZSTD_compressBound(plain.size()));
+    size_t size = ZSTD_compress(compressed.data(), compressed.size(), plain.data(), plain.size(), 1);
+    ASSERT_FALSE(ZSTD_isError(size));
+    compressed.resize(size);
+
+    auto ignore = [](std::span<const MboMsg>) {};
+    uint64_t applied = count / 2 + 7;
+
+    for (const auto& [name, data] : {std::make_pair("dbn_resume_plain.dbn", &plain), std::make_pair("dbn_resume_zstd.dbn.zst", &compressed)})
+    {
+        std::string path = write_file(name, *data);
+
+        DbnWrapper wrapper(path);
+        ASSERT_EQ(wrapper.last_record_offset(), DbnWrapper::NO_OFFSET);
+        ASSERT_EQ(wrapper.fast_forward(UINT64_MAX, ignore, applied), applied);
+        uint64_t offset = wrapper.last_record_offset();
+        ASSERT_NE(offset, DbnWrapper::NO_OFFSET);
+
+        MboMsg last = make_mbo(applied - 1);
+        DbnWrapper resumed(path);
+        ASSERT_TRUE(resumed.seek(offset));
+        ASSERT_TRUE(resumed.skip_records(1, last.ts_recv.time_since_epoch().count(), last.sequence));
+        ASSERT_EQ(resumed.last_record_offset(), offset);
+
+        std::vector<MboMsg> replayed;
+        resumed.fast_forward(UINT64_MAX, [&](std::span<const MboMsg> records) { replayed.insert(replayed.end(), records.begin(), records.end()); }, 1);
+        ASSERT_EQ(replayed.size(), 1);
+        ASSERT_EQ(replayed.front().order_id, applied);
+
+        // Another record at that offset fails the check
+        DbnWrapper mismatched(path);
+        ASSERT_TRUE(mismatched.seek(offset));
+        ASSERT_FALSE(mismatched.skip_records(1, last.ts_recv.time_since_epoch().count(), last.sequence + 1));
+
+        std::remove(path.c_str());
+    }
+
+    // Merged files have no offset of their own
+    std::string path = write_file("dbn_resume_merged.dbn", plain);
+    DbnWrapper merged(std::vector<std::string>{path, path});
+    ASSERT_EQ(merged.fast_forward(UINT64_MAX, ignore, 100), 100);
+    ASSERT_EQ(merged.last_record_offset(), DbnWrapper::NO_OFFSET);
+    std::remove(path.c_str());
+}
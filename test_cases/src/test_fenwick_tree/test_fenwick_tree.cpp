@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+#include <fenwick/fenwick_tree.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/***********************************************
+ * TEST 1: Point add / prefix sum
+ ***********************************************/
+TEST(FenwickTree, PrefixSums)
+{
+    FenwickTree<int64_t> tree(10);
+
+    tree.add(0, 5);
+    tree.add(3, 2);
+    tree.add(9, 7);
+
+    ASSERT_EQ(tree.prefix_sum(0), 0);
+    ASSERT_EQ(tree.prefix_sum(1), 5);
+    ASSERT_EQ(tree.prefix_sum(4), 7);
+    ASSERT_EQ(tree.prefix_sum(9), 7);
+    ASSERT_EQ(tree.prefix_sum(10), 14);
+
+    tree.add(3, -2);
+    ASSERT_EQ(tree.prefix_sum(10), 12);
+}
+
+/***********************************************
+ * TEST 2: build() and random adds against a
+ * plain array
+ ***********************************************/
+TEST(FenwickTree, RandomOpsMatchArray)
+{
+    const size_t size = 1000;
+    std::mt19937_64 rng(3);
+
+    std::vector<int64_t> values(size);
+    for (int64_t& v : values) v = rng() % 100;
+
+    FenwickTree<int64_t> tree;
+    tree.build(values);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        size_t slot = rng() % size;
+        int64_t delta = (int64_t)(rng() % 21) - 10;
+        tree.add(slot, delta);
+        values[slot] += delta;
+
+        size_t end = rng() % (size + 1);
+        int64_t expected = 0;
+        for (size_t j = 0; j < end; ++j) expected += values[j];
+        ASSERT_EQ(tree.prefix_sum(end), expected);
+    }
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <hash_map/flat_hash_map.h>
+
+#include <random>
+#include <unordered_map>
+
+/***********************************************
+ * TEST 1: Insert / find / overwrite
+ ***********************************************/
+TEST(FlatHashMap, InsertFindOverwrite)
+{
+    FlatHashMap<uint64_t, uint32_t> map;
+
+    map.insert_or_assign(1, 10);
+    map.insert_or_assign(2, 20);
+
+    ASSERT_EQ(map.size(), 2);
+    ASSERT_EQ(*map.find(1), 10);
+    ASSERT_EQ(*map.find(2), 20);
+    ASSERT_EQ(map.find(3), nullptr);
+
+    // Overwrite keeps size
+    map.insert_or_assign(1, 11);
+    ASSERT_EQ(map.size(), 2);
+    ASSERT_EQ(*map.find(1), 11);
+}
+
+/***********************************************
+ * TEST 2: Erase with backward shift keeps
+ * every other key reachable
+ ***********************************************/
+TEST(FlatHashMap, EraseKeepsOtherKeysReachable)
+{
+    FlatHashMap<uint64_t, uint64_t> map(16);
+
+    for (uint64_t k = 0; k < 13; ++k) map.insert_or_assign(k, k * 100);
+
+    ASSERT_TRUE(map.erase(5));
+    ASSERT_FALSE(map.erase(5));
+    ASSERT_EQ(map.size(), 12);
+
+    for (uint64_t k = 0; k < 13; ++k)
+    {
+        if (k == 5) ASSERT_EQ(map.find(k), nullptr);
+        else        ASSERT_EQ(*map.find(k), k * 100);
+    }
+}
+
+/***********************************************
+ * TEST 3: Grows past initial capacity
+ ***********************************************/
+TEST(FlatHashMap, GrowsPowerOfTwo)
+{
+    FlatHashMap<uint64_t, uint64_t> map(16);
+
+    for (uint64_t k = 1; k <= 1000; ++k) map.insert_or_assign(k, k);
+
+    ASSERT_EQ(map.size(), 1000);
+    ASSERT_EQ(map.capacity() & (map.capacity() - 1), 0);
+    for (uint64_t k = 1; k <= 1000; ++k) ASSERT_EQ(*map.find(k), k);
+}
+
+/***********************************************
+ * TEST 4: Random insert / erase against
+ * std::unordered_map
+ ***********************************************/
+TEST(FlatHashMap, RandomOpsMatchUnorderedMap)
+{
+    FlatHashMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> expected;
+    std::mt19937_64 rng(42);
+
+    for (int i = 0; i < 200000; ++i)
+    {
+        uint64_t key = rng() % 5000;
+        if (rng() % 3 == 0)
+        {
+            ASSERT_EQ(map.erase(key), expected.erase(key) == 1);
+        }
+        else
+        {
+            map.insert_or_assign(key, i);
+            expected[key] = i;
+        }
+    }
+
+    ASSERT_EQ(map.size(), expected.size());
+    for (auto& [key, value] : expected) ASSERT_EQ(*map.find(key), value);
+}
+
+/***********************************************
+ * TEST 5: clear() between random ops, stale
+ * blocks never bring old keys back
+ ***********************************************/
+TEST(FlatHashMap, ClearKeepsCapacityAndForgetsKeys)
+{
+    FlatHashMap<uint64_t, uint64_t> map;
+    std::unordered_map<uint64_t, uint64_t> expected;
+    std::mt19937_64 rng(11);
+
+    for (int round = 0; round < 20; ++round)
+    {
+        size_t capacity = map.capacity();
+        map.clear();
+        expected.clear();
+        ASSERT_EQ(map.size(), 0);
+        ASSERT_EQ(map.capacity(), capacity);
+
+        for (int i = 0; i < 20000; ++i)
+        {
+            uint64_t key = rng() % 8000;
+            if (rng() % 3 == 0)
+            {
+                ASSERT_EQ(map.erase(key), expected.erase(key) == 1);
+            }
+            else
+            {
+                map.insert_or_assign(key, i);
+                expected[key] = i;
+            }
+        }
+
+        ASSERT_EQ(map.size(), expected.size());
+        for (uint64_t key = 0; key < 8000; ++key)
+        {
+            auto it = expected.find(key);
+            if (it == expected.end()) ASSERT_EQ(map.find(key), nullptr);
+            else                      ASSERT_EQ(*map.find(key), it->second);
+        }
+
+        size_t visited = 0;
+        map.for_each([&](uint64_t key, uint64_t value) { ASSERT_EQ(expected.at(key), value); ++visited; });
+        ASSERT_EQ(visited, expected.size());
+    }
+}
+
+/***********************************************
+ * TEST 6: The empty-slot key is rejected, the
+ * map is left untouched
+ ***********************************************/
+TEST(FlatHashMap, RejectsEmptyKey)
+{
+    FlatHashMap<uint64_t, uint64_t> map;
+    ASSERT_EQ(map.find(UINT64_MAX), nullptr);
+    ASSERT_FALSE(map.erase(UINT64_MAX));
+
+    ASSERT_FALSE(map.insert_or_assign(UINT64_MAX, 1));
+    ASSERT_TRUE(map.insert_or_assign(7, 70));
+    map[UINT64_MAX] = 2;
+    ASSERT_EQ(map[UINT64_MAX], 0);
+
+    ASSERT_EQ(map.size(), 1);
+    ASSERT_EQ(map.find(UINT64_MAX), nullptr);
+    ASSERT_FALSE(map.erase(UINT64_MAX));
+    ASSERT_EQ(map.size(), 1);
+    ASSERT_EQ(*map.find(7), 70);
+
+    size_t visited = 0;
+    map.for_each([&](uint64_t, uint64_t) { ++visited; });
+    ASSERT_EQ(visited, 1);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <bitmap/hierarchical_bitmap.h>
+
+#include <random>
+#include <set>
+#include <vector>
+
+/***********************************************
+ * TEST 1: next / prev on an empty bitmap
+ ***********************************************/
+TEST(HierarchicalBitmap, EmptyBitmapHasNoSetBits)
+{
+    HierarchicalBitmap bitmap(12000);
+
+    ASSERT_EQ(bitmap.next(0), HierarchicalBitmap::npos);
+    ASSERT_EQ(bitmap.prev(11999), HierarchicalBitmap::npos);
+}
+
+/***********************************************
+ * TEST 2: next / prev across word and
+ * summary boundaries
+ ***********************************************/
+TEST(HierarchicalBitmap, NextPrevAcrossBoundaries)
+{
+    HierarchicalBitmap bitmap(100000);
+
+    bitmap.set(3);
+    bitmap.set(64);
+    bitmap.set(70000);
+
+    ASSERT_EQ(bitmap.next(0), 3);
+    ASSERT_EQ(bitmap.next(4), 64);
+    ASSERT_EQ(bitmap.next(65), 70000);
+    ASSERT_EQ(bitmap.next(70001), HierarchicalBitmap::npos);
+
+    ASSERT_EQ(bitmap.prev(99999), 70000);
+    ASSERT_EQ(bitmap.prev(69999), 64);
+    ASSERT_EQ(bitmap.prev(63), 3);
+    ASSERT_EQ(bitmap.prev(2), HierarchicalBitmap::npos);
+
+    bitmap.reset(64);
+    ASSERT_EQ(bitmap.next(4), 70000);
+    ASSERT_EQ(bitmap.prev(69999), 3);
+}
+
+/***********************************************
+ * TEST 3: Random set / reset against std::set
+ ***********************************************/
+TEST(HierarchicalBitmap, RandomOpsMatchStdSet)
+{
+    const size_t size = 300000;
+    HierarchicalBitmap bitmap(size);
+    std::set<size_t> expected;
+    std::mt19937_64 rng(7);
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        size_t idx = rng() % size;
+        if (rng() % 2) { bitmap.set(idx); expected.insert(idx); }
+        else           { bitmap.reset(idx); expected.erase(idx); }
+
+        size_t from = rng() % size;
+
+        auto it = expected.lower_bound(from);
+        ASSERT_EQ(bitmap.next(from), it == expected.end() ? HierarchicalBitmap::npos : *it);
+
+        auto rit = expected.upper_bound(from);
+        ASSERT_EQ(bitmap.prev(from), rit == expected.begin() ? HierarchicalBitmap::npos : *std::prev(rit));
+    }
+}
+
+/***********************************************
+ * TEST 4: for_each_set visits the set bits in
+ * order, clear() leaves nothing behind
+ ***********************************************/
+TEST(HierarchicalBitmap, ForEachSetAndClear)
+{
+    HierarchicalBitmap bitmap(300000);
+    std::set<size_t> expected;
+    std::mt19937_64 rng(3);
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        size_t idx = rng() % bitmap.size();
+        bitmap.set(idx);
+        expected.insert(idx);
+    }
+
+    std::vector<size_t> visited;
+    bitmap.for_each_set([&](size_t idx) { visited.push_back(idx); });
+    ASSERT_EQ(visited, std::vector<size_t>(expected.begin(), expected.end()));
+
+    bitmap.clear();
+    ASSERT_EQ(bitmap.next(0), HierarchicalBitmap::npos);
+    ASSERT_EQ(bitmap.prev(bitmap.size() - 1), HierarchicalBitmap::npos);
+
+    bitmap.set(64);
+    ASSERT_EQ(bitmap.next(0), 64);
+}
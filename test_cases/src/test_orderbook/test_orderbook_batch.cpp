@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+#include <orderbook/orderbook_registry.h>
+
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+using databento::RecordHeader;
+
+static MboMsg make_mbo(uint32_t instrument_id, uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = instrument_id;
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+// Random add / cancel / modify / trade stream over a few instruments
+static std::vector<MboMsg> make_stream(size_t count, uint32_t num_instruments)
+{
+    std::mt19937_64 rng(3);
+    std::vector<MboMsg> msgs;
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'M', 'T', 'F'};
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = (1000 + (int64_t)(rng() % 100)) * 100;
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            order_id = i + 1;
+            live.push_back(order_id);
+            action = 'A';
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        // order ids are unique across instruments, keep each order on one instrument
+        msgs.push_back(make_mbo(1 + order_id % num_instruments, order_id, action, side, px, sz));
+    }
+    return msgs;
+}
+
+static void expect_same_depth(const OrderBookBase& actual, const OrderBookBase& expected)
+{
+    auto a = actual.get_depth(1000);
+    auto e = expected.get_depth(1000);
+
+    ASSERT_EQ(a.bids.size(), e.bids.size());
+    ASSERT_EQ(a.asks.size(), e.asks.size());
+    for (size_t i = 0; i < e.bids.size(); ++i)
+    {
+        ASSERT_EQ(a.bids[i].price, e.bids[i].price);
+        ASSERT_EQ(a.bids[i].size, e.bids[i].size);
+    }
+    for (size_t i = 0; i < e.asks.size(); ++i)
+    {
+        ASSERT_EQ(a.asks[i].price, e.asks[i].price);
+        ASSERT_EQ(a.asks[i].size, e.asks[i].size);
+    }
+}
+
+/***********************************************
+ * BATCH TEST 1:
+ * apply_batch over uneven chunks gives the same
+ * book as one apply() per message
+ ***********************************************/
+TEST(OrderBookBatch, ApplyBatchMatchesApply)
+{
+    auto msgs = make_stream(30000, 1);
+
+    OrderBook expected(64, 100, nullptr);
+    OrderBook actual(64, 100, nullptr);
+
+    for (const MboMsg& mbo : msgs)
+    {
+        expected.apply(mbo);
+    }
+
+    // Chunk sizes below, around and above the prefetch distance
+    const size_t chunks[] = {1, 5, 8, 17, 256};
+    size_t pos = 0;
+    for (size_t i = 0; pos < msgs.size(); ++i)
+    {
+        size_t n = std::min(chunks[i % std::size(chunks)], msgs.size() - pos);
+        actual.apply_batch(std::span<const MboMsg>(msgs.data() + pos, n));
+        pos += n;
+    }
+
+    expect_same_depth(actual, expected);
+}
+
+/***********************************************
+ * BATCH TEST 2:
+ * Registry apply_batch splits interleaved
+ * instruments into per-book runs
+ ***********************************************/
+TEST(OrderBookBatch, RegistryApplyBatchInterleaved)
+{
+    auto msgs = make_stream(20000, 3);
+    auto factory = [](uint32_t) { return std::make_unique<OrderBook>(64, 100, nullptr); };
+
+    OrderBookRegistry expected(factory);
+    OrderBookRegistry actual(factory);
+
+    for (const MboMsg& mbo : msgs)
+    {
+        expected.apply(mbo);
+    }
+    for (size_t pos = 0; pos < msgs.size(); pos += 100)
+    {
+        actual.apply_batch(std::span<const MboMsg>(msgs.data() + pos, std::min<size_t>(100, msgs.size() - pos)));
+    }
+
+    ASSERT_EQ(actual.size(), 3);
+    for (uint32_t instrument_id : expected.instrument_ids())
+    {
+        ASSERT_NE(actual.find(instrument_id), nullptr);
+        expect_same_depth(*actual.find(instrument_id), *expected.find(instrument_id));
+    }
+}
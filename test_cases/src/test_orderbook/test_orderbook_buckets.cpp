@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+/***********************************************
+ * TEST 1: Buckets sum their levels, best → worst,
+ * at every maintained resolution
+ ***********************************************/
+TEST(OrderBookBuckets, AggregatesLevels)
+{
+    OrderBook ob(0, 200000, 100, nullptr);  // tick=100
+    ob.set_bucket_resolutions({5, 10});
+
+    ob.apply(make_mbo(1, 'A', 'B', 100000, 5));     // tick 1000
+    ob.apply(make_mbo(2, 'A', 'B', 100400, 3));     // tick 1004
+    ob.apply(make_mbo(3, 'A', 'B', 100500, 2));     // tick 1005
+    ob.apply(make_mbo(4, 'A', 'B', 100500, 1));
+    ob.apply(make_mbo(5, 'A', 'A', 101200, 4));     // tick 1012
+    ob.apply(make_mbo(6, 'A', 'A', 102000, 6));     // tick 1020
+
+    std::vector<OrderBook::BucketEntry> bids;
+    ASSERT_TRUE(ob.get_buckets(true, 5, 10, bids));
+    ASSERT_EQ(bids.size(), 2);
+    ASSERT_EQ(bids[0].price, 100500);
+    ASSERT_EQ(bids[0].size, 3);
+    ASSERT_EQ(bids[0].count, 2);
+    ASSERT_EQ(bids[1].price, 100000);
+    ASSERT_EQ(bids[1].size, 8);
+
+    ob.get_buckets(true, 10, 10, bids);
+    ASSERT_EQ(bids.size(), 1);
+    ASSERT_EQ(bids[0].size, 11);
+    ASSERT_EQ(bids[0].count, 4);
+
+    std::vector<OrderBook::BucketEntry> asks;
+    ob.get_buckets(false, 10, 1, asks);
+    ASSERT_EQ(asks.size(), 1);
+    ASSERT_EQ(asks[0].price, 101000);
+    ASSERT_EQ(asks[0].size, 4);
+
+    // Partial cancel, then the last order of a bucket leaves
+    ob.apply(make_mbo(3, 'C', 'B', 100500, 1));
+    ob.apply(make_mbo(2, 'C', 'B', 100400, 3));
+    ob.get_buckets(true, 5, 10, bids);
+    ASSERT_EQ(bids[0].size, 2);
+    ASSERT_EQ(bids[1].size, 5);
+    ASSERT_EQ(bids[1].count, 1);
+
+    ob.apply(make_mbo(0, 'R', 'B', 0, 0));
+    ob.get_buckets(true, 5, 10, bids);
+    ASSERT_TRUE(bids.empty());
+}
+
+/***********************************************
+ * TEST 2: Random stream, maintained buckets equal
+ * the ones summed from the ladder
+ ***********************************************/
+TEST(OrderBookBuckets, RandomStreamMatchesLadderSums)
+{
+    OrderBook indexed(64, 100, nullptr);    // re-centering, prices go negative
+    OrderBook summed(64, 100, nullptr);
+    indexed.set_bucket_resolutions({1, 5, 10, 50});
+
+    std::mt19937_64 rng(21);
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'C', 'M', 'M', 'T', 'F'};
+    int64_t mid = 3000;
+
+    for (int i = 0; i < 60000; ++i)
+    {
+        if (i % 10000 == 0) mid -= 4000;    // drift far enough to re-center
+        if (i == 30000)
+        {
+            // Reconfigured mid-stream: rebuilt from the resting levels
+            indexed.set_bucket_resolutions({5, 50, 1, 10});
+        }
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = mid + ((int64_t)(rng() % 200) - 100) * 100;
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            action = 'A';
+            order_id = i + 1;
+            live.push_back(order_id);
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        MboMsg mbo = make_mbo(order_id, action, side, px, sz);
+        indexed.apply(mbo);
+        summed.apply(mbo);
+
+        if (i % 97 != 0) continue;
+
+        for (int64_t bucket_ticks : {1, 5, 10, 50})
+        {
+            for (bool is_bid : {true, false})
+            {
+                std::vector<OrderBook::BucketEntry> expected, actual;
+                summed.get_buckets(is_bid, bucket_ticks, 8, expected);
+                indexed.get_buckets(is_bid, bucket_ticks, 8, actual);
+
+                ASSERT_EQ(actual.size(), expected.size());
+                for (size_t b = 0; b < expected.size(); ++b)
+                {
+                    ASSERT_EQ(actual[b].price, expected[b].price);
+                    ASSERT_EQ(actual[b].size, expected[b].size);
+                    ASSERT_EQ(actual[b].count, expected[b].count);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook_checkpoint.h>
+
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+
+static MboMsg make_mbo(uint32_t instrument_id, uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = instrument_id;
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+// Random stream; prices wander so the ladder re-centers and uses overflow levels
+static std::vector<MboMsg> make_random_stream(uint32_t instrument_id, size_t count, uint64_t seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> live;
+    std::vector<MboMsg> msgs;
+    const char actions[] = {'A', 'A', 'A', 'C', 'M', 'T', 'F'};
+    int64_t mid = 100000;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i % 4000 == 0) mid += 3000;
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = mid + ((int64_t)(rng() % 60) - 30) * 100;
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            action = 'A';
+            order_id = seed * 1000000 + i + 1;
+            live.push_back(order_id);
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+        msgs.push_back(make_mbo(instrument_id, order_id, action, side, px, sz));
+    }
+    return msgs;
+}
+
+static void expect_same_depth(const OrderBookBase& a, const OrderBookBase& b)
+{
+    auto da = a.get_depth(100000);
+    auto db = b.get_depth(100000);
+    ASSERT_EQ(da.bids.size(), db.bids.size());
+    ASSERT_EQ(da.asks.size(), db.asks.size());
+    for (size_t i = 0; i < da.bids.size(); ++i)
+    {
+        ASSERT_EQ(da.bids[i].price, db.bids[i].price);
+        ASSERT_EQ(da.bids[i].size, db.bids[i].size);
+    }
+    for (size_t i = 0; i < da.asks.size(); ++i)
+    {
+        ASSERT_EQ(da.asks[i].price, db.asks[i].price);
+        ASSERT_EQ(da.asks[i].size, db.asks[i].size);
+    }
+}
+
+/***********************************************
+ * TEST 1: Save / load keeps levels, FIFO order
+ * and the order index
+ ***********************************************/
+TEST(OrderBookCheckpoint, BookRoundTrip)
+{
+    std::vector<MboMsg> msgs = make_random_stream(1, 30000, 3);
+
+    OrderBook original(64, 100, nullptr);
+    original.apply_batch(std::span<const MboMsg>(msgs.data(), 20000));
+
+    std::vector<char> data;
+    original.save_checkpoint(data);
+
+    OrderBook restored(64, 100, nullptr);
+    const char* pos = data.data();
+    ASSERT_TRUE(restored.load_checkpoint(pos, data.data() + data.size()));
+    ASSERT_EQ(pos, data.data() + data.size());
+    expect_same_depth(original, restored);
+
+    // Orders are written level by level in FIFO order: same bytes means same queues
+    std::vector<char> data_again;
+    restored.save_checkpoint(data_again);
+    ASSERT_EQ(data, data_again);
+
+    // The order index works: cancels / modifies / fills of restored orders keep both books equal
+    original.apply_batch(std::span<const MboMsg>(msgs.data() + 20000, 10000));
+    restored.apply_batch(std::span<const MboMsg>(msgs.data() + 20000, 10000));
+    expect_same_depth(original, restored);
+}
+
+/***********************************************
+ * TEST 2: A book fed message by message through
+ * apply() checkpoints its last ts_recv too
+ ***********************************************/
+TEST(OrderBookCheckpoint, ApplyStampsLastTsRecv)
+{
+    std::vector<MboMsg> msgs = make_random_stream(1, 5000, 5);
+    for (size_t i = 0; i < msgs.size(); ++i)
+    {
+        msgs[i].ts_recv = databento::UnixNanos{std::chrono::nanoseconds{1000 + 10 * (int64_t)i}};
+    }
+
+    OrderBook batched(64, 100, nullptr);
+    batched.apply_batch(msgs);
+
+    OrderBook single(64, 100, nullptr);
+    for (const MboMsg& mbo : msgs)
+    {
+        single.apply(mbo);
+    }
+
+    std::vector<char> data;
+    single.save_checkpoint(data);
+    std::vector<char> batched_data;
+    batched.save_checkpoint(batched_data);
+    ASSERT_EQ(data, batched_data);
+
+    OrderBook restored(64, 100, nullptr);
+    const char* pos = data.data();
+    ASSERT_TRUE(restored.load_checkpoint(pos, data.data() + data.size()));
+    restored.publish();
+
+    OrderBook::PublishedDepth depth;
+    ASSERT_GT(restored.read_published(depth), 0);
+    ASSERT_EQ(depth.last_ts_recv, 1000 + 10 * (msgs.size() - 1));
+}
+
+/***********************************************
+ * TEST 3: Checkpoint file with several books and
+ * the stream position
+ ***********************************************/
+TEST(OrderBookCheckpoint, RegistryFileRoundTrip)
+{
+    auto factory = [](uint32_t)
+    {
+        return std::make_unique<OrderBook>(64, 100, nullptr);
+    };
+
+    OrderBookRegistry books(factory);
+    for (uint32_t instrument_id : {7u, 8u, 9u})
+    {
+        std::vector<MboMsg> msgs = make_random_stream(instrument_id, 5000, instrument_id);
+        books.apply_batch(msgs);
+    }
+
+    std::string path = ::testing::TempDir() + "orderbook_checkpoint_test.bin";
+    ASSERT_TRUE(OrderBookCheckpoint::save(path, books, OrderBookCheckpoint::StreamPosition{15000, 123456789, 42, 987654}));
+
+    OrderBookRegistry restored(factory);
+    OrderBookCheckpoint::StreamPosition position;
+    ASSERT_TRUE(OrderBookCheckpoint::load(path, restored, position));
+    ASSERT_EQ(position.record_index, 15000);
+    ASSERT_EQ(position.last_ts_recv, 123456789);
+    ASSERT_EQ(position.last_sequence, 42);
+    ASSERT_EQ(position.last_offset, 987654);
+
+    ASSERT_EQ(restored.instrument_ids(), books.instrument_ids());
+    for (uint32_t instrument_id : {7u, 8u, 9u})
+    {
+        expect_same_depth(*books.find(instrument_id), *restored.find(instrument_id));
+
+        // Loaded books are published for readers right away
+        OrderBook::PublishedDepth depth;
+        ASSERT_GT(restored.find_published(instrument_id)->read_published(depth), 0);
+    }
+
+    // A book with another tick size cannot take the checkpoint
+    OrderBookRegistry other([](uint32_t)
+    {
+        return std::make_unique<OrderBook>(64, 50, nullptr);
+    });
+    ASSERT_FALSE(OrderBookCheckpoint::load(path, other, position));
+
+    std::remove(path.c_str());
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 #include <orderbook/orderbook.h>
 
+#include <memory>
+#include <random>
+#include <vector>
+
 using databento::MboMsg;
 using databento::RecordHeader;
 
@@ -81,4 +85,74 @@ TEST(OrderBookBasic, TradeDoesNotChangeBook)
     auto after = ob.best_ask();
     // ASSERT_TRUE(after.has_value());
     // ASSERT_EQ(after->second, 7);  // unchanged
-}
\ No newline at end of file
+}
+/***********************************************
+ * TEST 4: A book reused across resets ends up
+ * like a fresh book fed the same messages
+ ***********************************************/
+TEST(OrderBookBasic, ReusedAfterResetMatchesFreshBook)
+{
+    OrderBook reused(0, 200000, 100, nullptr);
+    reused.set_queue_positions(true);
+    std::unique_ptr<OrderBook> fresh;
+
+    std::mt19937_64 rng(5);
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'M', 'T'};
+
+    for (int i = 0; i < 40000; ++i)
+    {
+        if (i % 5000 == 0)
+        {
+            reused.apply(make_mbo(0, 'R', 'B', 0, 0));
+            fresh = std::make_unique<OrderBook>(0, 200000, 100, nullptr);
+            live.clear();
+        }
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = 100000 + ((int64_t)(rng() % 40) - 20) * 100 + (rng() % 50 == 0 ? 500000 : 0);  // some overflow levels
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            action = 'A';
+            order_id = i % 7000 + 1;    // ids come back after a reset
+            live.push_back(order_id);
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        MboMsg mbo = make_mbo(order_id, action, side, px, sz);
+        reused.apply(mbo);
+        fresh->apply(mbo);
+
+        uint64_t probe = live[rng() % live.size()];
+        auto expected = fresh->queue_position(probe);
+        auto actual = reused.queue_position(probe);
+        ASSERT_EQ(actual.has_value(), expected.has_value());
+        if (expected)
+        {
+            ASSERT_EQ(actual->size_ahead, expected->size_ahead);
+            ASSERT_EQ(actual->count_ahead, expected->count_ahead);
+        }
+    }
+
+    auto expected = fresh->get_depth(1000);
+    auto actual = reused.get_depth(1000);
+    ASSERT_EQ(actual.bids.size(), expected.bids.size());
+    ASSERT_EQ(actual.asks.size(), expected.asks.size());
+    for (size_t i = 0; i < expected.bids.size(); ++i)
+    {
+        ASSERT_EQ(actual.bids[i].price, expected.bids[i].price);
+        ASSERT_EQ(actual.bids[i].size, expected.bids[i].size);
+    }
+    for (size_t i = 0; i < expected.asks.size(); ++i)
+    {
+        ASSERT_EQ(actual.asks[i].price, expected.asks[i].price);
+        ASSERT_EQ(actual.asks[i].size, expected.asks[i].size);
+    }
+}
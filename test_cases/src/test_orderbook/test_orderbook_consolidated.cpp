@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook_registry.h>
+#include <orderbook/orderbook_checkpoint.h>
+
+#include <map>
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+
+static MboMsg make_mbo(uint16_t publisher_id, uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.hd.publisher_id = publisher_id;
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+static std::unique_ptr<OrderBookRegistry> make_venue_registry()
+{
+    auto registry = std::make_unique<OrderBookRegistry>([](uint32_t)
+    {
+        return std::make_unique<OrderBook>(64, 100, nullptr);
+    });
+    registry->set_venue_books(true);
+    return registry;
+}
+
+// Consolidated levels of a side, summed from the venue books
+static std::vector<ConsolidatedBook::Entry> sum_venues(const OrderBookRegistry& registry, bool is_bid)
+{
+    std::map<int64_t, ConsolidatedBook::Entry> levels;
+    for (size_t dense_id = 0; dense_id < registry.size(); ++dense_id)
+    {
+        registry.get_by_dense_id(dense_id)->for_each_level(is_bid, SIZE_MAX, [&](int64_t price, const OrderBook::Level& level)
+        {
+            ConsolidatedBook::Entry& entry = levels.try_emplace(price, ConsolidatedBook::Entry{price, 0, 0}).first->second;
+            entry.size += level.total_size;
+            entry.count += level.queue.size();
+        });
+    }
+
+    std::vector<ConsolidatedBook::Entry> out;
+    for (auto& [price, entry] : levels) out.push_back(entry);
+    if (is_bid) std::reverse(out.begin(), out.end());
+    return out;
+}
+
+static void expect_consolidated_matches(const OrderBookRegistry& registry)
+{
+    const ConsolidatedBook* consolidated = registry.find_consolidated(1);
+    ASSERT_NE(consolidated, nullptr);
+
+    std::vector<ConsolidatedBook::Entry> actual;
+    for (bool is_bid : {true, false})
+    {
+        std::vector<ConsolidatedBook::Entry> expected = sum_venues(registry, is_bid);
+        consolidated->get_levels(is_bid, SIZE_MAX, actual);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            ASSERT_EQ(actual[i].price, expected[i].price);
+            ASSERT_EQ(actual[i].size, expected[i].size);
+            ASSERT_EQ(actual[i].count, expected[i].count);
+        }
+    }
+}
+
+/***********************************************
+ * TEST 1: Venues get their own book (same order
+ * ids do not clash), the consolidated levels sum
+ * them with a per-venue breakdown
+ ***********************************************/
+TEST(OrderBookConsolidated, SumsVenuesWithBreakdown)
+{
+    auto registry = make_venue_registry();
+
+    registry->apply(make_mbo(1, 7, 'A', 'B', 10000, 5));
+    registry->apply(make_mbo(2, 7, 'A', 'B', 10000, 3));
+    registry->apply(make_mbo(2, 8, 'A', 'B', 9900, 4));
+    registry->apply(make_mbo(1, 9, 'A', 'A', 10100, 2));
+
+    ASSERT_EQ(registry->size(), 2);
+    ASSERT_EQ(registry->instrument_ids().size(), 1);
+    ASSERT_EQ(registry->find(1), nullptr);
+    ASSERT_EQ(registry->find(1, 1)->best_bid()->second, 5);
+    ASSERT_EQ(registry->find(1, 2)->best_bid()->second, 3);
+
+    const ConsolidatedBook* consolidated = registry->find_consolidated(1);
+    std::vector<ConsolidatedBook::Entry> bids;
+    consolidated->get_levels(true, 10, bids);
+    ASSERT_EQ(bids.size(), 2);
+    ASSERT_EQ(bids[0].price, 10000);
+    ASSERT_EQ(bids[0].size, 8);
+    ASSERT_EQ(bids[0].count, 2);
+    ASSERT_EQ(bids[1].price, 9900);
+
+    Json snapshot = consolidated->build_snapshot(10);
+    ASSERT_EQ((int64_t)snapshot["bids"][0]["size"], 8);
+    ASSERT_EQ(snapshot["bids"][0]["venues"].size(), 2);
+    ASSERT_EQ((int64_t)snapshot["bids"][0]["venues"][1]["publisher_id"], 2);
+    ASSERT_EQ((int64_t)snapshot["bids"][0]["venues"][1]["size"], 3);
+    ASSERT_EQ(snapshot["bids"][1]["venues"].size(), 1);
+
+    // Cancel on one venue, order 7 of the other venue stays
+    registry->apply(make_mbo(2, 7, 'C', 'B', 10000, 3));
+    consolidated->get_levels(true, 10, bids);
+    ASSERT_EQ(bids[0].size, 5);
+    ASSERT_EQ(bids[0].count, 1);
+
+    // Book reset of venue 1 only
+    registry->apply(make_mbo(1, 0, 'R', 'N', 0, 0));
+    consolidated->get_levels(true, 10, bids);
+    ASSERT_EQ(bids.size(), 1);
+    ASSERT_EQ(bids[0].price, 9900);
+    consolidated->get_levels(false, 10, bids);
+    ASSERT_TRUE(bids.empty());
+}
+
+/***********************************************
+ * TEST 2: Random multi-venue stream, the
+ * consolidated ladder equals the sum of the
+ * venue books, also after a checkpoint reload
+ * and a registry reset
+ ***********************************************/
+TEST(OrderBookConsolidated, RandomStreamMatchesVenueSums)
+{
+    auto registry = make_venue_registry();
+
+    std::mt19937_64 rng(19);
+    std::vector<std::pair<uint16_t, uint64_t>> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'C', 'M', 'M', 'T', 'F'};
+    int64_t mid = 100000;
+
+    for (int i = 0; i < 30000; ++i)
+    {
+        if (i % 5000 == 0) mid += 3000;     // drift far enough to re-center
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = mid + ((int64_t)(rng() % 16) - 8) * 100;
+        uint32_t sz = 1 + rng() % 20;
+
+        uint16_t publisher_id;
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            action = 'A';
+            publisher_id = 1 + i % 3;
+            order_id = i / 3 + 1;     // every id shows up once per venue
+            live.emplace_back(publisher_id, order_id);
+        }
+        else
+        {
+            std::tie(publisher_id, order_id) = live[rng() % live.size()];
+        }
+
+        registry->apply(make_mbo(publisher_id, order_id, action, side, px, sz));
+        if (i % 500 == 0) expect_consolidated_matches(*registry);
+    }
+    expect_consolidated_matches(*registry);
+    ASSERT_EQ(registry->find_consolidated(1)->venues().size(), 3);
+
+    // Venue books reloaded from a checkpoint rebuild the same consolidated ladder
+    std::vector<char> data;
+    registry->save_checkpoint(data);
+    auto restored = make_venue_registry();
+    const char* pos = data.data();
+    ASSERT_TRUE(restored->load_checkpoint(pos, data.data() + data.size()));
+    expect_consolidated_matches(*restored);
+
+    std::vector<ConsolidatedBook::Entry> expected, actual;
+    registry->find_consolidated(1)->get_levels(true, SIZE_MAX, expected);
+    restored->find_consolidated(1)->get_levels(true, SIZE_MAX, actual);
+    ASSERT_EQ(actual.size(), expected.size());
+
+    // Not loaded into a registry without venue books
+    auto single = make_venue_registry();
+    single->set_venue_books(false);
+    pos = data.data();
+    ASSERT_FALSE(single->load_checkpoint(pos, data.data() + data.size()));
+
+    registry->reset();
+    registry->find_consolidated(1)->get_levels(true, SIZE_MAX, actual);
+    ASSERT_TRUE(actual.empty());
+    registry->find_consolidated(1)->get_levels(false, SIZE_MAX, actual);
+    ASSERT_TRUE(actual.empty());
+}
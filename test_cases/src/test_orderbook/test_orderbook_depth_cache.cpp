@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+using databento::RecordHeader;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+// The cached top levels must equal the first levels of a full ladder walk
+static void expect_cache_matches_walk(const OrderBook& ob, size_t cache_levels)
+{
+    auto cached = ob.get_depth(cache_levels);
+    auto walked = ob.get_depth(100000);
+
+    ASSERT_EQ(cached.bids.size(), std::min(cache_levels, walked.bids.size()));
+    ASSERT_EQ(cached.asks.size(), std::min(cache_levels, walked.asks.size()));
+    for (size_t i = 0; i < cached.bids.size(); ++i)
+    {
+        ASSERT_EQ(cached.bids[i].price, walked.bids[i].price);
+        ASSERT_EQ(cached.bids[i].size, walked.bids[i].size);
+    }
+    for (size_t i = 0; i < cached.asks.size(); ++i)
+    {
+        ASSERT_EQ(cached.asks[i].price, walked.asks[i].price);
+        ASSERT_EQ(cached.asks[i].size, walked.asks[i].size);
+    }
+}
+
+// Random stream; prices wander so the ladder re-centers and uses overflow levels
+static void run_random_stream(OrderBook& ob, size_t cache_levels)
+{
+    std::mt19937_64 rng(11);
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'C', 'M', 'T', 'F'};
+    int64_t mid = 100000;
+
+    for (int i = 0; i < 40000; ++i)
+    {
+        if (i % 5000 == 0) mid += 3000;     // drift far enough to leave the window
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = mid + ((int64_t)(rng() % 60) - 30) * 100;
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            order_id = i + 1;
+            live.push_back(order_id);
+            action = 'A';
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        ob.apply(make_mbo(order_id, action, side, px, sz));
+
+        if (i % 97 == 0)
+        {
+            expect_cache_matches_walk(ob, cache_levels);
+        }
+    }
+    expect_cache_matches_walk(ob, cache_levels);
+}
+
+/***********************************************
+ * DEPTH CACHE TEST 1:
+ * Top level emptied → next level pulled in
+ ***********************************************/
+TEST(OrderBookDepthCache, RefillAfterTopLevelEmptied)
+{
+    OrderBook ob(100000, 110000, 100, nullptr);
+    ob.set_depth_cache_levels(2);
+
+    ob.apply(make_mbo(1, 'A', 'B', 105000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 104900, 6));
+    ob.apply(make_mbo(3, 'A', 'B', 104000, 7));
+    ob.apply(make_mbo(4, 'A', 'B', 50000, 8));      // overflow level below the window
+
+    auto depth = ob.get_depth(2);
+    ASSERT_EQ(depth.bids.size(), 2);
+    ASSERT_EQ(depth.bids[0].price, 105000);
+    ASSERT_EQ(depth.bids[1].price, 104900);
+
+    ob.apply(make_mbo(1, 'C', 'B', 105000, 5));
+    ob.apply(make_mbo(3, 'C', 'B', 104000, 7));
+
+    depth = ob.get_depth(2);
+    ASSERT_EQ(depth.bids.size(), 2);
+    ASSERT_EQ(depth.bids[0].price, 104900);
+    ASSERT_EQ(depth.bids[1].price, 50000);
+    ASSERT_EQ(depth.bids[1].size, 8);
+}
+
+/***********************************************
+ * DEPTH CACHE TEST 2:
+ * Random stream, fixed ladder with overflow
+ ***********************************************/
+TEST(OrderBookDepthCache, RandomStreamFixedLadder)
+{
+    OrderBook ob(100000, 110000, 100, nullptr);
+    ob.set_depth_cache_levels(5);
+    run_random_stream(ob, 5);
+}
+
+/***********************************************
+ * DEPTH CACHE TEST 3:
+ * Random stream, re-centering ladder
+ ***********************************************/
+TEST(OrderBookDepthCache, RandomStreamRecenteringLadder)
+{
+    OrderBook ob(64, 100, nullptr);
+    run_random_stream(ob, OrderBook::DEFAULT_DEPTH_CACHE_LEVELS);
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook_registry.h>
+
+#include <vector>
+
+using databento::MboMsg;
+using databento::Mbp10Msg;
+using databento::FlagSet;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz, bool last = true)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    m.flags = last ? FlagSet{FlagSet::kLast} : FlagSet{};
+    return m;
+}
+
+// Resting asks at 101/102/103, then a buy sweeps through the first two levels in one event
+static std::vector<MboMsg> make_sweep()
+{
+    return {
+        make_mbo(1, 'A', 'A', 10100, 5),
+        make_mbo(2, 'A', 'A', 10200, 5),
+        make_mbo(3, 'A', 'A', 10300, 5),
+        make_mbo(9, 'A', 'B', 9900, 1),
+        make_mbo(0, 'T', 'B', 10100, 5, false),
+        make_mbo(1, 'C', 'A', 10100, 5, false),
+        make_mbo(0, 'T', 'B', 10200, 5, false),
+        make_mbo(2, 'C', 'A', 10200, 5, true),
+    };
+}
+
+/***********************************************
+ * TEST 1: One MBP-10 record per event, on its
+ * F_LAST message
+ ***********************************************/
+TEST(OrderBookEventBatching, Mbp10RecordPerEvent)
+{
+    OrderBook ob(4096, 100, nullptr);
+    ob.set_event_batching(true);
+
+    std::vector<Mbp10Msg> records;
+    ob.set_mbp10_callback([&](const Mbp10Msg& msg) { records.push_back(msg); });
+
+    std::vector<MboMsg> msgs = make_sweep();
+    for (size_t i = 0; i < 4; ++i) ob.apply(msgs[i]);
+    ASSERT_EQ(records.size(), 4);
+    ASSERT_FALSE(ob.event_open());
+
+    ob.apply(msgs[4]);
+    ob.apply(msgs[5]);
+    ASSERT_TRUE(ob.event_open());
+    ASSERT_EQ(records.size(), 4);
+
+    ob.apply(msgs[6]);
+    ob.apply(msgs[7]);
+    ASSERT_FALSE(ob.event_open());
+    ASSERT_EQ(records.size(), 5);
+    ASSERT_EQ(records.back().levels[0].ask_px, 10300);
+    ASSERT_EQ(records.back().levels[1].ask_px, databento::kUndefPrice);
+}
+
+/***********************************************
+ * TEST 2: The registry only publishes a book
+ * once its event is complete
+ ***********************************************/
+TEST(OrderBookEventBatching, PublishWaitsForEventEnd)
+{
+    OrderBookRegistry registry([](uint32_t)
+    {
+        return std::make_unique<OrderBook>(4096, 100, nullptr);
+    });
+    registry.set_event_batching(true);
+
+    std::vector<MboMsg> msgs = make_sweep();
+    OrderBook::PublishedDepth depth;
+
+    registry.apply_batch(std::span<const MboMsg>(msgs.data(), 4));
+    ASSERT_FALSE(registry.has_open_events());
+    const OrderBookBase* book = registry.find_published(1);
+    ASSERT_NE(book, nullptr);
+    uint64_t version = book->read_published(depth);
+    ASSERT_EQ(depth.asks[0].price, 10100);
+
+    // Batch ends in the middle of the sweep: nothing new is published
+    registry.apply_batch(std::span<const MboMsg>(msgs.data() + 4, 2));
+    ASSERT_TRUE(registry.has_open_events());
+    ASSERT_EQ(book->read_published(depth), version);
+    ASSERT_EQ(depth.asks[0].price, 10100);
+
+    registry.apply_batch(std::span<const MboMsg>(msgs.data() + 6, 2));
+    ASSERT_FALSE(registry.has_open_events());
+    ASSERT_GT(book->read_published(depth), version);
+    ASSERT_EQ(depth.ask_count, 1);
+    ASSERT_EQ(depth.asks[0].price, 10300);
+}
+
+/***********************************************
+ * TEST 3: The BBO skips the intermediate tops
+ * of an event
+ ***********************************************/
+TEST(OrderBookEventBatching, BboOnlyAtEventEnd)
+{
+    OrderBook ob(4096, 100, nullptr);
+    ob.set_event_batching(true);
+
+    std::vector<MboMsg> msgs = make_sweep();
+    OrderBook::Bbo bbo;
+
+    for (size_t i = 0; i < 4; ++i) ob.apply(msgs[i]);
+    uint64_t version = ob.read_bbo(bbo);
+    ASSERT_EQ(bbo.ask_price, 10100);
+
+    // 10100 is gone mid-event, the published top still shows it
+    for (size_t i = 4; i < 7; ++i) ob.apply(msgs[i]);
+    ASSERT_EQ(ob.read_bbo(bbo), version);
+    ASSERT_EQ(bbo.ask_price, 10100);
+
+    ob.apply(msgs[7]);
+    ASSERT_EQ(ob.read_bbo(bbo), version + 1);
+    ASSERT_EQ(bbo.ask_price, 10300);
+    ASSERT_EQ(bbo.ask_size, 5);
+    ASSERT_EQ(bbo.bid_price, 9900);
+}
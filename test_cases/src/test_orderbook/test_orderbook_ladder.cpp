@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+
+using databento::MboMsg;
+using databento::RecordHeader;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+/***********************************************
+ * LADDER TEST 1:
+ * Fixed ladder: prices outside [min, max] go to
+ * overflow levels and stay correct
+ ***********************************************/
+TEST(OrderBookLadder, FixedLadderOutOfRangePrices)
+{
+    OrderBook ob(100000, 110000, 100, nullptr);
+
+    ob.apply(make_mbo(1, 'A', 'B', 105000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 50000, 7));     // far below the window
+    ob.apply(make_mbo(3, 'A', 'A', 300000, 2));    // far above the window
+
+    auto depth = ob.get_depth(10);
+    ASSERT_EQ(depth.bids.size(), 2);
+    ASSERT_EQ(depth.bids[0].price, 105000);
+    ASSERT_EQ(depth.bids[1].price, 50000);
+    ASSERT_EQ(depth.bids[1].size, 7);
+
+    auto ba = ob.best_ask();
+    ASSERT_TRUE(ba.has_value());
+    ASSERT_EQ(ba->first, 300000);
+
+    // Cancel overflow orders → levels disappear
+    ob.apply(make_mbo(2, 'C', 'B', 50000, 7));
+    ob.apply(make_mbo(3, 'C', 'A', 300000, 2));
+    ASSERT_EQ(ob.get_depth(10).bids.size(), 1);
+    ASSERT_FALSE(ob.best_ask().has_value());
+}
+
+/***********************************************
+ * LADDER TEST 2:
+ * Overflow bid above the window is the best bid
+ ***********************************************/
+TEST(OrderBookLadder, OverflowAboveWindowIsBest)
+{
+    OrderBook ob(100000, 110000, 100, nullptr);
+
+    ob.apply(make_mbo(1, 'A', 'B', 105000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 120000, 1));
+
+    auto bb = ob.best_bid();
+    ASSERT_TRUE(bb.has_value());
+    ASSERT_EQ(bb->first, 120000);
+    ASSERT_EQ(bb->second, 1);
+}
+
+/***********************************************
+ * LADDER TEST 3:
+ * Recentering ladder follows the market and
+ * keeps FIFO order of resting orders
+ ***********************************************/
+TEST(OrderBookLadder, RecenteringFollowsMarket)
+{
+    OrderBook ob(64, 100, nullptr);   // 64 dense levels
+
+    ob.apply(make_mbo(1, 'A', 'B', 1000000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 1000000, 6));
+    ob.apply(make_mbo(3, 'A', 'A', 1000100, 3));
+
+    // Market drifts far up: new orders re-center the window
+    ob.apply(make_mbo(4, 'A', 'B', 2000000, 4));
+    ob.apply(make_mbo(5, 'A', 'A', 2000100, 2));
+
+    auto bb = ob.best_bid();
+    ASSERT_TRUE(bb.has_value());
+    ASSERT_EQ(bb->first, 2000000);
+    auto ba = ob.best_ask();
+    ASSERT_TRUE(ba.has_value());
+    ASSERT_EQ(ba->first, 1000100);   // old ask is still resting
+
+    auto depth = ob.get_depth(10);
+    ASSERT_EQ(depth.bids.size(), 2);
+    ASSERT_EQ(depth.bids[1].price, 1000000);
+    ASSERT_EQ(depth.bids[1].size, 11);
+
+    // Old resting orders are still reachable after the move
+    ob.apply(make_mbo(1, 'C', 'B', 1000000, 5));
+    ob.apply(make_mbo(3, 'C', 'A', 1000100, 3));
+    depth = ob.get_depth(10);
+    ASSERT_EQ(depth.bids[1].size, 6);
+    ASSERT_EQ(ob.best_ask()->first, 2000100);
+}
+
+/***********************************************
+ * LADDER TEST 4:
+ * Negative prices (spread instruments)
+ ***********************************************/
+TEST(OrderBookLadder, NegativePrices)
+{
+    OrderBook ob(64, 100, nullptr);
+
+    ob.apply(make_mbo(1, 'A', 'B', -500, 5));
+    ob.apply(make_mbo(2, 'A', 'B', -700, 2));
+    ob.apply(make_mbo(3, 'A', 'A', -300, 4));
+
+    auto bb = ob.best_bid();
+    ASSERT_TRUE(bb.has_value());
+    ASSERT_EQ(bb->first, -500);
+    ASSERT_EQ(ob.best_ask()->first, -300);
+
+    auto depth = ob.get_depth(10);
+    ASSERT_EQ(depth.bids.size(), 2);
+    ASSERT_EQ(depth.bids[1].price, -700);
+
+    ob.apply(make_mbo(1, 'M', 'B', -200, 5));
+    ASSERT_EQ(ob.best_bid()->first, -200);
+}
+
+/***********************************************
+ * LADDER TEST 5:
+ * Reset clears window and overflow levels
+ ***********************************************/
+TEST(OrderBookLadder, ResetClearsOverflowAndDepth)
+{
+    OrderBook ob(100000, 110000, 100, nullptr);
+
+    ob.apply(make_mbo(1, 'A', 'B', 105000, 5));
+    ob.apply(make_mbo(2, 'A', 'A', 300000, 2));
+    ob.apply(make_mbo(0, 'R', 'B', 0, 0));
+
+    auto depth = ob.get_depth(10);
+    ASSERT_TRUE(depth.bids.empty());
+    ASSERT_TRUE(depth.asks.empty());
+}
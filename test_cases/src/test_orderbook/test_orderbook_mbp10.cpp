@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+using databento::Mbp10Msg;
+using databento::kUndefPrice;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.hd.publisher_id = 2;
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    m.sequence = (uint32_t)order_id;
+    return m;
+}
+
+/***********************************************
+ * TEST 1: Record header, levels and depth
+ ***********************************************/
+TEST(OrderBookMbp10, RecordMatchesBook)
+{
+    OrderBook ob(4096, 100, nullptr);
+    std::vector<Mbp10Msg> records;
+    ob.set_mbp10_callback([&](const Mbp10Msg& msg) { records.push_back(msg); });
+
+    ob.apply(make_mbo(1, 'A', 'B', 10000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 10000, 7));
+    ob.apply(make_mbo(3, 'A', 'B', 9900, 1));
+    ob.apply(make_mbo(4, 'A', 'A', 10100, 4));
+    ASSERT_EQ(records.size(), 4);
+
+    const Mbp10Msg& msg = records.back();
+    ASSERT_EQ(msg.hd.rtype, databento::RType::Mbp10);
+    ASSERT_EQ(msg.hd.Size(), sizeof(Mbp10Msg));
+    ASSERT_EQ(msg.hd.instrument_id, 1);
+    ASSERT_EQ(msg.hd.publisher_id, 2);
+    ASSERT_EQ(msg.sequence, 4);
+    ASSERT_EQ((char)msg.action, 'A');
+    ASSERT_EQ((char)msg.side, 'A');
+    ASSERT_EQ(msg.price, 10100);
+    ASSERT_EQ(msg.size, 4);
+    ASSERT_EQ(msg.depth, 0);
+
+    ASSERT_EQ(msg.levels[0].bid_px, 10000);
+    ASSERT_EQ(msg.levels[0].bid_sz, 12);
+    ASSERT_EQ(msg.levels[0].bid_ct, 2);
+    ASSERT_EQ(msg.levels[1].bid_px, 9900);
+    ASSERT_EQ(msg.levels[1].bid_sz, 1);
+    ASSERT_EQ(msg.levels[1].bid_ct, 1);
+    ASSERT_EQ(msg.levels[2].bid_px, kUndefPrice);
+    ASSERT_EQ(msg.levels[2].bid_sz, 0);
+
+    ASSERT_EQ(msg.levels[0].ask_px, 10100);
+    ASSERT_EQ(msg.levels[0].ask_sz, 4);
+    ASSERT_EQ(msg.levels[0].ask_ct, 1);
+    ASSERT_EQ(msg.levels[1].ask_px, kUndefPrice);
+
+    // Second bid level
+    ASSERT_EQ(records[2].depth, 1);
+
+    // Json view derived from the same record
+    Json json = OrderBook::mbp10_to_json(msg);
+    ASSERT_EQ(json["levels"].size(), 10);
+    ASSERT_EQ((int64_t)json["levels"][0]["bid_px"], 10000);
+    ASSERT_EQ((int64_t)json["depth"], 0);
+}
+
+/***********************************************
+ * TEST 2: Events below the top 10 emit nothing,
+ * trades always emit
+ ***********************************************/
+TEST(OrderBookMbp10, OnlyTopTenChangesEmit)
+{
+    OrderBook ob(4096, 100, nullptr);
+    std::vector<Mbp10Msg> records;
+    ob.set_mbp10_callback([&](const Mbp10Msg& msg) { records.push_back(msg); });
+
+    for (uint64_t i = 0; i < 12; ++i)
+    {
+        ob.apply(make_mbo(i + 1, 'A', 'B', 10000 - (int64_t)i * 100, 1));
+    }
+    ASSERT_EQ(records.size(), 10);
+
+    // 12th level: not visible in MBP-10
+    ob.apply(make_mbo(100, 'A', 'B', 10000 - 11 * 100, 3));
+    ASSERT_EQ(records.size(), 10);
+
+    // Cancelling the best level pulls the 11th level into the top 10
+    ob.apply(make_mbo(1, 'C', 'B', 10000, 1));
+    ASSERT_EQ(records.size(), 11);
+    ASSERT_EQ(records.back().levels[0].bid_px, 9900);
+    ASSERT_EQ(records.back().levels[9].bid_px, 9000);
+    ASSERT_EQ(records.back().depth, 0);
+
+    // Trade against a level that is not in the book: book unchanged, record anyway
+    ob.apply(make_mbo(0, 'T', 'A', 12000, 1));
+    ASSERT_EQ(records.size(), 12);
+    ASSERT_EQ((char)records.back().action, 'T');
+}
+
+/***********************************************
+ * TEST 3: Random stream, records equal the top
+ * 10 of a ladder walk
+ ***********************************************/
+TEST(OrderBookMbp10, RandomStreamMatchesLadderWalk)
+{
+    OrderBook ob(64, 100, nullptr);
+    OrderBook walked(64, 100, nullptr);
+    walked.set_depth_cache_levels(5);      // below 10 levels the pairs come from a ladder walk
+
+    size_t record_count = 0;
+    Mbp10Msg last{};
+    ob.set_mbp10_callback([&](const Mbp10Msg& msg) { last = msg; ++record_count; });
+
+    std::mt19937_64 rng(5);
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'C', 'M', 'T', 'F'};
+    int64_t mid = 100000;
+    OrderBook::BidAskPairs previous;
+    walked.fill_bid_ask_pairs(previous);
+
+    for (int i = 0; i < 30000; ++i)
+    {
+        if (i % 5000 == 0) mid += 3000;     // drift far enough to leave the window
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = mid + ((int64_t)(rng() % 60) - 30) * 100;
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            action = 'A';
+            order_id = i + 1;
+            live.push_back(order_id);
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        MboMsg mbo = make_mbo(order_id, action, side, px, sz);
+        size_t count_before = record_count;
+        ob.apply(mbo);
+        walked.apply(mbo);
+
+        OrderBook::BidAskPairs expected;
+        walked.fill_bid_ask_pairs(expected);
+        bool changed = std::memcmp(expected.data(), previous.data(), sizeof(expected)) != 0;
+        previous = expected;
+
+        // Every change is reported (touching a top level without changing it may be reported too)
+        ASSERT_LE(record_count - count_before, 1u);
+        if (changed || action == 'T')
+        {
+            ASSERT_EQ(record_count - count_before, 1u);
+        }
+        if (record_count > count_before)
+        {
+            ASSERT_EQ(std::memcmp(last.levels.data(), expected.data(), sizeof(expected)), 0);
+        }
+    }
+}
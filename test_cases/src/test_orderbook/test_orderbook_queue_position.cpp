@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+/***********************************************
+ * TEST 1: Size / count ahead under add, partial
+ * cancel, priority-losing modify and fill
+ ***********************************************/
+TEST(OrderBookQueuePosition, TracksQueueChanges)
+{
+    OrderBook ob(4096, 100, nullptr);
+    ob.set_queue_positions(true);
+
+    ob.apply(make_mbo(1, 'A', 'B', 10000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 10000, 7));
+    ob.apply(make_mbo(3, 'A', 'B', 10000, 2));
+
+    auto pos = ob.queue_position(3);
+    ASSERT_TRUE(pos.has_value());
+    ASSERT_EQ(pos->size_ahead, 12);
+    ASSERT_EQ(pos->count_ahead, 2);
+    ASSERT_EQ(pos->level_size, 14);
+    ASSERT_EQ(pos->level_count, 3);
+    ASSERT_EQ(ob.queue_position(1)->size_ahead, 0);
+
+    // Partial cancel keeps priority
+    ob.apply(make_mbo(1, 'C', 'B', 10000, 3));
+    ASSERT_EQ(ob.queue_position(3)->size_ahead, 9);
+
+    // Size up: order 1 goes to the back
+    ob.apply(make_mbo(1, 'M', 'B', 10000, 4));
+    ASSERT_EQ(ob.queue_position(1)->size_ahead, 9);
+    ASSERT_EQ(ob.queue_position(1)->count_ahead, 2);
+    ASSERT_EQ(ob.queue_position(2)->size_ahead, 0);
+
+    // Full fill of the front order
+    ob.apply(make_mbo(2, 'F', 'B', 10000, 7));
+    ASSERT_EQ(ob.queue_position(3)->size_ahead, 0);
+    ASSERT_EQ(ob.queue_position(1)->size_ahead, 2);
+    ASSERT_EQ(ob.queue_position(1)->count_ahead, 1);
+
+    ASSERT_FALSE(ob.queue_position(2).has_value());
+}
+
+/***********************************************
+ * TEST 2: Random stream, indexed queries equal
+ * the queue walk of a book without the index
+ ***********************************************/
+TEST(OrderBookQueuePosition, RandomStreamMatchesQueueWalk)
+{
+    OrderBook indexed(64, 100, nullptr);
+    OrderBook walked(64, 100, nullptr);
+    indexed.set_queue_positions(true);
+
+    std::mt19937_64 rng(9);
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'C', 'M', 'M', 'T', 'F'};
+    int64_t mid = 100000;
+
+    for (int i = 0; i < 60000; ++i)
+    {
+        if (i % 10000 == 0) mid += 3000;     // drift far enough to re-center
+        if (i == 30000)
+        {
+            // Turned off and on again: rebuilt from the resting orders
+            indexed.set_queue_positions(false);
+            indexed.set_queue_positions(true);
+        }
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = mid + ((int64_t)(rng() % 8) - 4) * 100;    // few levels: long queues, many slot renumberings
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            action = 'A';
+            order_id = i + 1;
+            live.push_back(order_id);
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        MboMsg mbo = make_mbo(order_id, action, side, px, sz);
+        indexed.apply(mbo);
+        walked.apply(mbo);
+
+        uint64_t probe = live[rng() % live.size()];
+        auto expected = walked.queue_position(probe);
+        auto actual = indexed.queue_position(probe);
+        ASSERT_EQ(actual.has_value(), expected.has_value());
+        if (expected)
+        {
+            ASSERT_EQ(actual->size_ahead, expected->size_ahead);
+            ASSERT_EQ(actual->count_ahead, expected->count_ahead);
+            ASSERT_EQ(actual->level_count, expected->level_count);
+        }
+    }
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook_registry.h>
+
+using databento::MboMsg;
+using databento::RecordHeader;
+
+static MboMsg make_mbo(uint32_t instrument_id, uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = instrument_id;
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+static OrderBookRegistry make_registry()
+{
+    return OrderBookRegistry([](uint32_t)
+    {
+        return std::make_unique<OrderBook>(0, 200000, 100, nullptr);
+    });
+}
+
+/***********************************************
+ * REGISTRY TEST 1:
+ * Messages of different instruments go to
+ * separate books
+ ***********************************************/
+TEST(OrderBookRegistry, RoutesByInstrumentId)
+{
+    OrderBookRegistry registry = make_registry();
+
+    registry.apply(make_mbo(42140878, 1, 'A', 'B', 100000, 5));
+    registry.apply(make_mbo(42140879, 2, 'A', 'B', 101000, 7));
+    registry.apply(make_mbo(42140878, 3, 'A', 'B', 99000, 1));
+
+    ASSERT_EQ(registry.size(), 2);
+    ASSERT_EQ(registry.instrument_id_of(0), 42140878);
+    ASSERT_EQ(registry.instrument_id_of(1), 42140879);
+
+    auto bb1 = registry.find(42140878)->best_bid();
+    ASSERT_EQ(bb1->first, 100000);
+    ASSERT_EQ(registry.find(42140878)->get_depth(10).bids.size(), 2);
+
+    auto bb2 = registry.find(42140879)->best_bid();
+    ASSERT_EQ(bb2->first, 101000);
+    ASSERT_EQ(bb2->second, 7);
+
+    ASSERT_EQ(registry.find(1), nullptr);
+
+    // Published for readers on other threads like after apply_batch
+    OrderBook::PublishedDepth depth;
+    ASSERT_GT(registry.find_published(42140878)->read_published(depth), 0);
+    ASSERT_EQ(depth.bid_count, 2);
+    ASSERT_EQ(depth.bids[0].price, 100000);
+}
+
+/***********************************************
+ * REGISTRY TEST 2:
+ * Instruments colliding on the direct-mapped
+ * slot still resolve to their own book
+ ***********************************************/
+TEST(OrderBookRegistry, DirectSlotCollision)
+{
+    OrderBookRegistry registry = make_registry();
+
+    // Same low bits → same direct slot
+    uint32_t a = 5;
+    uint32_t b = 5 + (1 << 20);
+
+    registry.apply(make_mbo(a, 1, 'A', 'A', 100000, 3));
+    registry.apply(make_mbo(b, 2, 'A', 'A', 150000, 4));
+    registry.apply(make_mbo(a, 3, 'A', 'A', 120000, 1));
+
+    ASSERT_EQ(registry.size(), 2);
+    ASSERT_EQ(registry.find(a)->get_depth(10).asks.size(), 2);
+    ASSERT_EQ(registry.find(b)->best_ask()->first, 150000);
+    ASSERT_EQ(registry.get_or_create(b), registry.find(b));
+}
+
+/***********************************************
+ * REGISTRY TEST 3:
+ * apply_batch publishes the books it touched,
+ * readers find them through find_published
+ ***********************************************/
+TEST(OrderBookRegistry, ApplyBatchPublishesTouchedBooks)
+{
+    OrderBookRegistry registry = make_registry();
+
+    std::vector<MboMsg> batch = {
+        make_mbo(7, 1, 'A', 'B', 100000, 5),
+        make_mbo(7, 2, 'A', 'B', 100100, 3),
+        make_mbo(8, 3, 'A', 'A', 150000, 4),
+        make_mbo(7, 4, 'A', 'A', 100500, 2),
+    };
+    registry.apply_batch(batch);
+
+    ASSERT_EQ(registry.find_published(9), nullptr);
+
+    const OrderBookBase* book = registry.find_published(7);
+    ASSERT_EQ(book, registry.find(7));
+
+    OrderBook::PublishedDepth depth;
+    ASSERT_EQ(book->read_published(depth), 1);      // one publish per batch
+    ASSERT_EQ(depth.bid_count, 2);
+    ASSERT_EQ(depth.bids[0].price, 100100);
+    ASSERT_EQ(depth.bids[1].size, 5);
+    ASSERT_EQ(depth.ask_count, 1);
+    ASSERT_EQ(depth.asks[0].price, 100500);
+
+    // Not applied → not published again
+    registry.apply_batch(std::vector<MboMsg>{make_mbo(8, 3, 'C', 'A', 150000, 4)});
+    ASSERT_EQ(book->read_published(depth), 1);
+    ASSERT_EQ(registry.find_published(8)->read_published(depth), 2);
+    ASSERT_EQ(depth.ask_count, 0);
+}
+
+/***********************************************
+ * REGISTRY TEST 4:
+ * reset() empties and publishes every book,
+ * the same book objects serve the next run
+ ***********************************************/
+TEST(OrderBookRegistry, ResetReusesBooks)
+{
+    OrderBookRegistry registry = make_registry();
+
+    registry.apply_batch(std::vector<MboMsg>{
+        make_mbo(7, 1, 'A', 'B', 100000, 5),
+        make_mbo(8, 2, 'A', 'A', 150000, 4),
+    });
+    const OrderBookBase* book = registry.find(7);
+
+    registry.reset();
+    registry.set_queue_positions(true);
+
+    ASSERT_EQ(registry.size(), 2);
+    ASSERT_EQ(registry.find(7), book);
+    ASSERT_FALSE(registry.find(7)->best_bid().has_value());
+    ASSERT_TRUE(registry.find(8)->queue_positions());
+
+    OrderBook::PublishedDepth depth;
+    registry.find_published(8)->read_published(depth);
+    ASSERT_EQ(depth.ask_count, 0);
+
+    // Same order ids as before the reset
+    registry.apply_batch(std::vector<MboMsg>{
+        make_mbo(7, 1, 'A', 'B', 100100, 3),
+        make_mbo(7, 2, 'A', 'B', 100100, 2),
+    });
+    ASSERT_EQ(registry.find(7), book);
+    ASSERT_EQ(book->best_bid()->first, 100100);
+    ASSERT_EQ(book->best_bid()->second, 5);
+    ASSERT_EQ(book->queue_position(2)->size_ahead, 3);
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook_registry.h>
+
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz, uint8_t flags = databento::FlagSet::kLast)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    m.flags = databento::FlagSet{flags};
+    return m;
+}
+
+// Signals recomputed from scratch from the book's top `levels` levels
+static void expect_signals_match(const OrderBook& ob, size_t levels)
+{
+    OrderBook::Signals signals;
+    ASSERT_GT(ob.read_signals(signals), 0);
+    ASSERT_EQ(signals.levels, levels);
+
+    OrderBook::DepthSnapshot depth = ob.get_depth((int)levels);
+    auto side_sums = [](const std::vector<OrderBook::DepthEntry>& entries, uint64_t& size, double& price)
+    {
+        size = 0;
+        double notional = 0;
+        for (const OrderBook::DepthEntry& entry : entries)
+        {
+            size += entry.size;
+            notional += (double)entry.price * entry.size;
+        }
+        price = size ? notional / size : 0;
+    };
+
+    uint64_t bid_depth = 0, ask_depth = 0;
+    double bid_depth_price = 0, ask_depth_price = 0;
+    side_sums(depth.bids, bid_depth, bid_depth_price);
+    side_sums(depth.asks, ask_depth, ask_depth_price);
+
+    ASSERT_EQ(signals.bid_depth, bid_depth);
+    ASSERT_EQ(signals.ask_depth, ask_depth);
+    ASSERT_NEAR(signals.bid_depth_price, bid_depth_price, 1e-6);
+    ASSERT_NEAR(signals.ask_depth_price, ask_depth_price, 1e-6);
+    if (bid_depth + ask_depth)
+    {
+        ASSERT_NEAR(signals.depth_imbalance, ((double)bid_depth - (double)ask_depth) / (bid_depth + ask_depth), 1e-12);
+    }
+
+    uint64_t bid_size = depth.bids.empty() ? 0 : depth.bids[0].size;
+    uint64_t ask_size = depth.asks.empty() ? 0 : depth.asks[0].size;
+    ASSERT_EQ(signals.bid_size, bid_size);
+    ASSERT_EQ(signals.ask_size, ask_size);
+    if (bid_size + ask_size)
+    {
+        ASSERT_NEAR(signals.imbalance, ((double)bid_size - (double)ask_size) / (bid_size + ask_size), 1e-12);
+    }
+
+    if (!depth.bids.empty() && !depth.asks.empty())
+    {
+        int64_t bid = depth.bids[0].price;
+        int64_t ask = depth.asks[0].price;
+        ASSERT_EQ(signals.spread, ask - bid);
+        ASSERT_DOUBLE_EQ(signals.mid, (bid + ask) / 2.0);
+        ASSERT_NEAR(signals.microprice, ((double)bid * ask_size + (double)ask * bid_size) / (bid_size + ask_size), 1e-6);
+    }
+    else
+    {
+        ASSERT_EQ(signals.spread, 0);
+        ASSERT_EQ(signals.mid, 0);
+    }
+}
+
+/***********************************************
+ * TEST 1: Values of a small book, one-sided
+ * and two-sided
+ ***********************************************/
+TEST(OrderBookSignals, ComputesTopOfBookAndDepthValues)
+{
+    OrderBook ob(0, 200000, 100, nullptr);
+    ob.set_signal_levels(2);
+
+    OrderBook::Signals signals;
+    ASSERT_EQ(ob.read_signals(signals), 0);
+
+    ob.apply(make_mbo(1, 'A', 'B', 10000, 30));
+    ob.read_signals(signals);
+    ASSERT_EQ(signals.bid_price, 10000);
+    ASSERT_EQ(signals.ask_price, 0);
+    ASSERT_EQ(signals.mid, 0);
+    ASSERT_EQ(signals.imbalance, 1.0);
+
+    ob.apply(make_mbo(2, 'A', 'B', 9900, 10));
+    ob.apply(make_mbo(3, 'A', 'B', 9800, 99));     // third level, not counted
+    ob.apply(make_mbo(4, 'A', 'A', 10200, 10));
+    ob.apply(make_mbo(5, 'A', 'A', 10400, 10));
+
+    ob.read_signals(signals);
+    ASSERT_EQ(signals.spread, 200);
+    ASSERT_DOUBLE_EQ(signals.mid, 10100);
+    ASSERT_DOUBLE_EQ(signals.microprice, (10000.0 * 10 + 10200.0 * 30) / 40);
+    ASSERT_DOUBLE_EQ(signals.imbalance, 0.5);
+    ASSERT_EQ(signals.bid_depth, 40);
+    ASSERT_EQ(signals.ask_depth, 20);
+    ASSERT_DOUBLE_EQ(signals.depth_imbalance, 20.0 / 60);
+    ASSERT_DOUBLE_EQ(signals.bid_depth_price, (10000.0 * 30 + 9900.0 * 10) / 40);
+    ASSERT_DOUBLE_EQ(signals.ask_depth_price, 10300);
+
+    Json json = OrderBook::signals_to_json(signals);
+    ASSERT_EQ((int64_t)json["spread"], 200);
+    ASSERT_EQ((int64_t)json["levels"], 2);
+}
+
+// Random adds / cancels / modifies / trades around a drifting mid, the signals are checked along the way
+static void run_random_stream(OrderBook& ob, size_t levels)
+{
+    std::mt19937_64 rng(20);
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'C', 'M', 'M', 'T', 'F'};
+    int64_t mid = 100000;
+    uint64_t next_id = 1;
+
+    for (int i = 0; i < 20000; ++i)
+    {
+        if (i % 4000 == 0) mid += 5000;     // drift far enough to re-center
+
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = mid + ((int64_t)(rng() % 16) - 8) * 100;
+        uint32_t sz = 1 + rng() % 20;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            action = 'A';
+            order_id = next_id++;
+            live.push_back(order_id);
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        ob.apply(make_mbo(order_id, action, side, px, sz));
+        if (i % 100 == 0) expect_signals_match(ob, levels);
+    }
+    expect_signals_match(ob, levels);
+
+    ob.apply(make_mbo(0, 'R', 'N', 0, 0));
+    expect_signals_match(ob, levels);
+}
+
+/***********************************************
+ * TEST 2: Random stream, the signals always
+ * equal the values recomputed from the depth
+ ***********************************************/
+TEST(OrderBookSignals, RandomStreamMatchesRecomputedDepth)
+{
+    OrderBook ob(256, 100, nullptr);
+    ob.set_signal_levels(OrderBook::DEFAULT_SIGNAL_LEVELS);
+    run_random_stream(ob, OrderBook::DEFAULT_SIGNAL_LEVELS);
+}
+
+/***********************************************
+ * TEST 3: Subscribers get one call per change
+ * of the inputs, none mid-event; the registry
+ * tags them with the instrument
+ ***********************************************/
+TEST(OrderBookSignals, SubscribersOnlySeeChangesAtEventEnd)
+{
+    OrderBookRegistry registry([](uint32_t)
+    {
+        return std::make_unique<OrderBook>(0, 200000, 100, nullptr);
+    });
+    registry.set_event_batching(true);
+    registry.set_signal_levels(3);
+
+    std::vector<std::pair<uint32_t, OrderBook::Signals>> received;
+    registry.set_signals_callback([&](uint32_t instrument_id, uint16_t, const OrderBook::Signals& signals)
+    {
+        received.emplace_back(instrument_id, signals);
+    });
+
+    registry.apply(make_mbo(1, 'A', 'B', 10000, 5));
+    registry.apply(make_mbo(2, 'A', 'A', 10100, 5));
+    ASSERT_EQ(received.size(), 2);
+    ASSERT_EQ(received.back().first, 1);
+    ASSERT_DOUBLE_EQ(received.back().second.mid, 10050);
+
+    // Levels entering the tracked top 3 publish, a level behind them does not
+    registry.apply(make_mbo(3, 'A', 'B', 9000, 5));
+    registry.apply(make_mbo(4, 'A', 'B', 9100, 5));
+    registry.apply(make_mbo(5, 'A', 'B', 9200, 5));
+    ASSERT_EQ(received.size(), 5);
+    registry.apply(make_mbo(6, 'A', 'B', 8000, 5));
+    ASSERT_EQ(received.size(), 5);
+
+    // A two-message event is published once, with its final state
+    registry.apply(make_mbo(1, 'C', 'B', 10000, 5, 0));
+    ASSERT_EQ(received.size(), 5);
+    registry.apply(make_mbo(7, 'A', 'B', 9900, 2));
+    ASSERT_EQ(received.size(), 6);
+    ASSERT_EQ(received.back().second.bid_price, 9900);
+    ASSERT_EQ(received.back().second.spread, 200);
+    ASSERT_EQ(received.back().second.bid_depth, 12);
+}
+
+/***********************************************
+ * TEST 4: Depth cache shorter than the signal
+ * levels, next to bucket views and a level
+ * callback sharing the level changes
+ ***********************************************/
+TEST(OrderBookSignals, RandomStreamWithShortDepthCacheAndLevelTracking)
+{
+    OrderBook ob(256, 100, nullptr);
+    ob.set_depth_cache_levels(3);
+    ob.set_bucket_resolutions({2});
+    size_t level_changes = 0;
+    ob.set_level_callback([&](bool, int64_t, int64_t, int64_t) { ++level_changes; });
+    ob.set_signal_levels(OrderBook::DEFAULT_SIGNAL_LEVELS);
+
+    run_random_stream(ob, 3);
+    ASSERT_GT(level_changes, 0);
+}
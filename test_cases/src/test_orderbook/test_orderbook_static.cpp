@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+#include <orderbook/orderbook_products.h>
+#include <orderbook/orderbook_registry.h>
+
+#include <random>
+#include <vector>
+
+using databento::MboMsg;
+using databento::RecordHeader;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+using SmallStaticBook = BasicOrderBook<StaticBookConfig<100, 100000, 110000>>;
+using NoTradeStaticBook = BasicOrderBook<StaticBookConfig<100, 100000, 110000, false>>;
+
+/***********************************************
+ * STATIC TEST 1:
+ * Static config: prices inside and outside the
+ * compile-time window
+ ***********************************************/
+TEST(OrderBookStatic, FixedWindowAndOverflow)
+{
+    SmallStaticBook ob;
+
+    ob.apply(make_mbo(1, 'A', 'B', 105000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 50000, 7));     // below the window
+    ob.apply(make_mbo(3, 'A', 'A', 300000, 2));    // above the window
+    ob.apply(make_mbo(4, 'A', 'A', 105100, 4));
+
+    auto depth = ob.get_depth(10);
+    ASSERT_EQ(depth.bids.size(), 2);
+    ASSERT_EQ(depth.bids[0].price, 105000);
+    ASSERT_EQ(depth.bids[1].price, 50000);
+    ASSERT_EQ(depth.asks.size(), 2);
+    ASSERT_EQ(depth.asks[0].price, 105100);
+    ASSERT_EQ(depth.asks[1].price, 300000);
+
+    ob.apply(make_mbo(4, 'C', 'A', 105100, 4));
+    ASSERT_EQ(ob.best_ask()->first, 300000);
+}
+
+/***********************************************
+ * STATIC TEST 2:
+ * TradesMutate = false ignores T/F/N
+ ***********************************************/
+TEST(OrderBookStatic, TradesDoNotMutateWhenDisabled)
+{
+    NoTradeStaticBook ob;
+
+    ob.apply(make_mbo(1, 'A', 'B', 105000, 10));
+    ob.apply(make_mbo(1, 'T', 'B', 105000, 4));
+    ob.apply(make_mbo(1, 'F', 'B', 105000, 10));
+    ASSERT_EQ(ob.best_bid()->second, 10);
+
+    // The fill is reflected by the cancel that follows it
+    ob.apply(make_mbo(1, 'C', 'B', 105000, 10));
+    ASSERT_FALSE(ob.best_bid().has_value());
+}
+
+/***********************************************
+ * STATIC TEST 3:
+ * CL static book matches the runtime-configured
+ * book on a random stream
+ ***********************************************/
+TEST(OrderBookStatic, CLBookMatchesRuntimeBook)
+{
+    CLOrderBook static_book;
+    OrderBook runtime_book(0, 500000000000LL, 10000000LL, nullptr);
+
+    std::mt19937_64 rng(42);
+    std::vector<uint64_t> live;
+    const char actions[] = {'A', 'A', 'A', 'C', 'M', 'T', 'F'};
+
+    for (int i = 0; i < 50000; ++i)
+    {
+        char action = actions[rng() % std::size(actions)];
+        char side = (rng() % 2) ? 'B' : 'A';
+        int64_t px = (6000 + (int64_t)(rng() % 200)) * 10000000LL;   // $60.00 - $61.99
+        uint32_t sz = 1 + rng() % 50;
+
+        uint64_t order_id;
+        if (action == 'A' || live.empty())
+        {
+            order_id = i + 1;
+            live.push_back(order_id);
+            action = 'A';
+        }
+        else
+        {
+            order_id = live[rng() % live.size()];
+        }
+
+        MboMsg mbo = make_mbo(order_id, action, side, px, sz);
+        static_book.apply(mbo);
+        runtime_book.apply(mbo);
+    }
+
+    auto expected = runtime_book.get_depth(1000);
+    auto actual = static_book.get_depth(1000);
+
+    ASSERT_EQ(actual.bids.size(), expected.bids.size());
+    ASSERT_EQ(actual.asks.size(), expected.asks.size());
+    for (size_t i = 0; i < expected.bids.size(); ++i)
+    {
+        ASSERT_EQ(actual.bids[i].price, expected.bids[i].price);
+        ASSERT_EQ(actual.bids[i].size, expected.bids[i].size);
+    }
+    for (size_t i = 0; i < expected.asks.size(); ++i)
+    {
+        ASSERT_EQ(actual.asks[i].price, expected.asks[i].price);
+        ASSERT_EQ(actual.asks[i].size, expected.asks[i].size);
+    }
+}
+
+/***********************************************
+ * STATIC TEST 4:
+ * A registry built with the product factory
+ * holds CL books, unknown products get none
+ ***********************************************/
+TEST(OrderBookStatic, ProductFactoryBuildsCLBooks)
+{
+    OrderBookRegistry registry([](uint32_t)
+    {
+        return make_product_book("CL", nullptr);
+    });
+
+    MboMsg mbo = make_mbo(1, 'A', 'B', 6000 * 10000000LL, 3);
+    mbo.hd.instrument_id = 7;
+    registry.apply(mbo);
+
+    OrderBookBase* book = registry.find(7);
+    ASSERT_NE(book, nullptr);
+    ASSERT_NE(dynamic_cast<CLOrderBook*>(book), nullptr);
+    ASSERT_EQ(book->best_bid()->first, 6000 * 10000000LL);
+
+    ASSERT_TRUE(is_known_product("CL"));
+    ASSERT_FALSE(is_known_product("ES"));
+    ASSERT_EQ(make_product_book("ES", nullptr), nullptr);
+}
+
+/***********************************************
+ * STATIC TEST 5:
+ * The full CL snapshot includes the levels
+ * outside the [$0, $500] ladder
+ ***********************************************/
+TEST(OrderBookStatic, CLSnapshotIncludesOverflowLevels)
+{
+    CLOrderBook ob;
+
+    ob.apply(make_mbo(1, 'A', 'B', 6000 * 10000000LL, 5));
+    ob.apply(make_mbo(2, 'A', 'B', -3763 * 10000000LL, 7));    // below $0
+    ob.apply(make_mbo(3, 'A', 'A', 6001 * 10000000LL, 2));
+    ob.apply(make_mbo(4, 'A', 'A', 60000 * 10000000LL, 4));    // above $500
+
+    Json snapshot = ob.build_snapshot();
+    ASSERT_EQ(snapshot["bids"].size(), 2);
+    ASSERT_EQ((int64_t)snapshot["bids"][0]["price"], 6000 * 10000000LL);
+    ASSERT_EQ((int64_t)snapshot["bids"][1]["price"], -3763 * 10000000LL);
+    ASSERT_EQ((int64_t)snapshot["bids"][1]["size"], 7);
+    ASSERT_EQ(snapshot["asks"].size(), 2);
+    ASSERT_EQ((int64_t)snapshot["asks"][0]["price"], 6001 * 10000000LL);
+    ASSERT_EQ((int64_t)snapshot["asks"][1]["price"], 60000 * 10000000LL);
+    ASSERT_EQ((int64_t)snapshot["asks"][1]["size"], 4);
+}
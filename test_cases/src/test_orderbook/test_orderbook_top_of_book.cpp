@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <orderbook/orderbook.h>
+
+using databento::MboMsg;
+using databento::RecordHeader;
+
+static MboMsg make_mbo(uint64_t order_id, char action, char side, int64_t px, uint32_t sz)
+{
+    MboMsg m{};
+    m.hd.instrument_id = 1;      // dummy
+    m.order_id = order_id;
+    m.price = px;
+    m.size = sz;
+    m.action = (databento::Action)action;
+    m.side = (databento::Side)side;
+    return m;
+}
+
+/***********************************************
+ * TOP TEST 1:
+ * Cancel the best bid → next lower bid
+ * becomes best
+ ***********************************************/
+TEST(OrderBookTopOfBook, CancelBestBidFallsBackToNextLevel)
+{
+    OrderBook ob(0, 200000, 100, nullptr);
+
+    ob.apply(make_mbo(1, 'A', 'B', 100000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 99000, 7));
+    ob.apply(make_mbo(3, 'A', 'B', 101000, 2));
+
+    ob.apply(make_mbo(3, 'C', 'B', 101000, 2));
+
+    auto bb = ob.best_bid();
+    ASSERT_TRUE(bb.has_value());
+    ASSERT_EQ(bb->first, 100000);
+    ASSERT_EQ(bb->second, 5);
+}
+
+/***********************************************
+ * TOP TEST 2:
+ * Fill the best ask → next higher ask
+ * becomes best
+ ***********************************************/
+TEST(OrderBookTopOfBook, FillBestAskFallsBackToNextLevel)
+{
+    OrderBook ob(0, 200000, 100, nullptr);
+
+    ob.apply(make_mbo(10, 'A', 'A', 101000, 3));
+    ob.apply(make_mbo(11, 'A', 'A', 103000, 4));
+
+    ob.apply(make_mbo(10, 'T', 'A', 101000, 3));
+
+    auto ba = ob.best_ask();
+    ASSERT_TRUE(ba.has_value());
+    ASSERT_EQ(ba->first, 103000);
+    ASSERT_EQ(ba->second, 4);
+}
+
+/***********************************************
+ * TOP TEST 3:
+ * Modify the best bid to a lower price →
+ * best bid follows the order
+ ***********************************************/
+TEST(OrderBookTopOfBook, ModifyBestBidPriceDown)
+{
+    OrderBook ob(0, 200000, 100, nullptr);
+
+    ob.apply(make_mbo(20, 'A', 'B', 100000, 5));
+    ob.apply(make_mbo(21, 'A', 'B', 98000, 1));
+
+    ob.apply(make_mbo(20, 'M', 'B', 97000, 5));
+
+    auto bb = ob.best_bid();
+    ASSERT_TRUE(bb.has_value());
+    ASSERT_EQ(bb->first, 98000);
+    ASSERT_EQ(bb->second, 1);
+
+    auto depth = ob.get_depth(10);
+    ASSERT_EQ(depth.bids.size(), 2);
+    ASSERT_EQ(depth.bids[1].price, 97000);
+}
+
+/***********************************************
+ * TOP TEST 4:
+ * Remove every order on a side → side empty,
+ * then refill at a new price
+ ***********************************************/
+TEST(OrderBookTopOfBook, SideEmptiesAndRefills)
+{
+    OrderBook ob(0, 200000, 100, nullptr);
+
+    ob.apply(make_mbo(30, 'A', 'A', 101000, 3));
+    ob.apply(make_mbo(31, 'A', 'A', 102000, 3));
+    ob.apply(make_mbo(31, 'C', 'A', 102000, 3));
+    ob.apply(make_mbo(30, 'C', 'A', 101000, 3));
+
+    ASSERT_FALSE(ob.best_ask().has_value());
+    ASSERT_TRUE(ob.get_depth(10).asks.empty());
+
+    ob.apply(make_mbo(32, 'A', 'A', 150000, 9));
+
+    auto ba = ob.best_ask();
+    ASSERT_TRUE(ba.has_value());
+    ASSERT_EQ(ba->first, 150000);
+    ASSERT_EQ(ba->second, 9);
+}
+
+/***********************************************
+ * TOP TEST 5:
+ * Published BBO follows the top of book and
+ * only moves when the top changes
+ ***********************************************/
+TEST(OrderBookTopOfBook, BboPublishedOnTopChanges)
+{
+    OrderBook ob(0, 200000, 100, nullptr);
+    OrderBook::Bbo bbo;
+
+    ASSERT_EQ(ob.read_bbo(bbo), 0);
+
+    ob.apply(make_mbo(1, 'A', 'B', 100000, 5));
+    ob.apply(make_mbo(2, 'A', 'A', 101000, 3));
+    ASSERT_EQ(ob.read_bbo(bbo), 2);
+    ASSERT_EQ(bbo.bid_price, 100000);
+    ASSERT_EQ(bbo.bid_size, 5);
+    ASSERT_EQ(bbo.ask_price, 101000);
+    ASSERT_EQ(bbo.ask_size, 3);
+
+    // Behind the top: nothing published
+    ob.apply(make_mbo(3, 'A', 'B', 99000, 7));
+    ob.apply(make_mbo(4, 'A', 'A', 102000, 1));
+    ASSERT_EQ(ob.read_bbo(bbo), 2);
+
+    // Size at the top
+    ob.apply(make_mbo(5, 'A', 'B', 100000, 2));
+    ASSERT_EQ(ob.read_bbo(bbo), 3);
+    ASSERT_EQ(bbo.bid_size, 7);
+
+    // Best ask level emptied
+    ob.apply(make_mbo(2, 'C', 'A', 101000, 3));
+    ASSERT_EQ(ob.read_bbo(bbo), 4);
+    ASSERT_EQ(bbo.ask_price, 102000);
+    ASSERT_EQ(bbo.ask_size, 1);
+
+    // Book reset: both sides empty
+    ob.apply(make_mbo(0, 'R', 'N', 0, 0));
+    ASSERT_EQ(ob.read_bbo(bbo), 5);
+    ASSERT_EQ(bbo.bid_size, 0);
+    ASSERT_EQ(bbo.ask_size, 0);
+}
+
+/***********************************************
+ * TOP TEST 6:
+ * BBO without a depth cache comes from the
+ * ladder
+ ***********************************************/
+TEST(OrderBookTopOfBook, BboWithoutDepthCache)
+{
+    OrderBook ob(0, 200000, 100, nullptr);
+    ob.set_depth_cache_levels(0);
+    OrderBook::Bbo bbo;
+
+    ob.apply(make_mbo(1, 'A', 'B', 100000, 5));
+    ob.apply(make_mbo(2, 'A', 'B', 100100, 4));
+    ob.apply(make_mbo(2, 'C', 'B', 100100, 4));
+
+    ob.read_bbo(bbo);
+    ASSERT_EQ(bbo.bid_price, 100000);
+    ASSERT_EQ(bbo.bid_size, 5);
+    ASSERT_EQ(bbo.ask_size, 0);
+}
@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include <time/replay_clock.h>
+
+/***********************************************
+ * TEST 1: Events less than the granularity
+ * after a group start join that group, due
+ * times scale with the speed
+ ***********************************************/
+TEST(ReplayClock, GroupsEventsAndScalesBySpeed)
+{
+    ReplayClock clock;
+    clock.start(2.0);
+
+    const uint64_t t0 = 1'700'000'000'000'000'000ULL;
+    ASSERT_TRUE(clock.starts_group(t0));
+    int64_t anchor = clock.due_ns();
+    ASSERT_LE(anchor, ReplayClock::now_ns());
+
+    // 2x speed: 1999 ns of event time are 999 ns of wall time, still inside the first group
+    ASSERT_FALSE(clock.starts_group(t0 + 1999));
+    ASSERT_EQ(clock.due_ns(), anchor);
+
+    ASSERT_TRUE(clock.starts_group(t0 + 2000));
+    ASSERT_EQ(clock.due_ns(), anchor + 1000);
+
+    // Same timestamp again, or an earlier one: no new group
+    ASSERT_FALSE(clock.starts_group(t0 + 2000));
+    ASSERT_FALSE(clock.starts_group(t0 + 100));
+
+    // Due times are taken from the anchor, not from the previous group
+    ASSERT_TRUE(clock.starts_group(t0 + 10'000'000));
+    ASSERT_EQ(clock.due_ns(), anchor + 5'000'000);
+
+    // start() takes a new anchor
+    clock.start(1.0);
+    ASSERT_TRUE(clock.starts_group(t0 + 10'000'000));
+    ASSERT_GE(clock.due_ns(), anchor);
+}
+
+// Wall time of the clocks under test, moved by hand
+static int64_t g_fake_now = 0;
+static int64_t fake_now() { return g_fake_now; }
+
+/***********************************************
+ * TEST 2: Long waits are split into a timer
+ * sleep and a final spin, groups are released
+ * at their due time (not before), on a fake
+ * time source
+ ***********************************************/
+TEST(ReplayClock, ReleasesGroupsOnTime)
+{
+    g_fake_now = 1'000'000;
+    ReplayClock clock(fake_now);
+    clock.start(1.0);
+
+    const uint64_t t0 = 1'000'000'000;
+    ASSERT_TRUE(clock.starts_group(t0));
+    ASSERT_EQ(clock.due_ns(), 1'000'000);
+    ASSERT_FALSE(clock.early());
+
+    // 5 ms ahead: everything but the spin threshold is slept
+    ASSERT_TRUE(clock.starts_group(t0 + 5'000'000));
+    ASSERT_EQ(clock.due_ns(), 6'000'000);
+    ASSERT_TRUE(clock.early());
+    ASSERT_EQ(clock.sleep_ns(), 5'000'000 - ReplayClock::SPIN_THRESHOLD_NS);
+
+    // Inside the spin threshold: no sleep left
+    g_fake_now = 6'000'000 - ReplayClock::SPIN_THRESHOLD_NS;
+    ASSERT_TRUE(clock.early());
+    ASSERT_EQ(clock.sleep_ns(), 0);
+
+    // Released 300 ns late
+    g_fake_now = 6'000'300;
+    ASSERT_FALSE(clock.early());
+    clock.spin_until_due();
+
+    // Short wait: spin only, released on time
+    ASSERT_TRUE(clock.starts_group(t0 + 5'000'000 + 50'000));
+    ASSERT_EQ(clock.sleep_ns(), 0);
+    g_fake_now = clock.due_ns();
+    clock.spin_until_due();
+
+    ASSERT_EQ(clock.waited_groups(), 2);
+    ASSERT_EQ(clock.max_lag_ns(), 300);
+    ASSERT_EQ(clock.avg_lag_ns(), 150.0);
+
+    // Behind schedule: due in the past, nothing to wait for
+    ASSERT_TRUE(clock.starts_group(t0 + 5'000'000 + 60'000));
+    g_fake_now += 200'000;
+    ASSERT_FALSE(clock.early());
+    ASSERT_EQ(clock.sleep_ns(), 0);
+}
+
+/***********************************************
+ * TEST 3: On steady_clock the TSC spin never
+ * releases a group before its due time
+ ***********************************************/
+TEST(ReplayClock, SpinsUntilDueOnSteadyClock)
+{
+    ReplayClock clock;
+    clock.start(1.0);
+    ASSERT_GT(ReplayClock::ticks_per_ns(), 0.0);
+
+    const uint64_t t0 = 1'000'000'000;
+    ASSERT_TRUE(clock.starts_group(t0));
+    ASSERT_TRUE(clock.starts_group(t0 + 50'000));
+    clock.spin_until_due();
+    ASSERT_GE(ReplayClock::now_ns(), clock.due_ns());
+    ASSERT_EQ(clock.waited_groups(), 1);
+}
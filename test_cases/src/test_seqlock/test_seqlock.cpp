@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include <utils/seqlock.h>
+
+#include <atomic>
+#include <thread>
+
+struct Block
+{
+    uint64_t values[32];
+};
+
+// Top-of-book sized block (see OrderBook::Bbo)
+struct Top
+{
+    uint64_t values[5];
+};
+
+/***********************************************
+ * TEST 1: Version counts completed writes
+ ***********************************************/
+TEST(SeqLock, VersionCountsWrites)
+{
+    SeqLock<Block> lock;
+    Block out;
+
+    ASSERT_EQ(lock.load(out), 0);
+
+    Block block{};
+    block.values[0] = 7;
+    lock.store(block);
+    lock.write([](Block& b) { b.values[1] = 9; });
+
+    ASSERT_EQ(lock.load(out), 2);
+    ASSERT_EQ(out.values[0], 7);
+    ASSERT_EQ(out.values[1], 9);
+}
+
+/***********************************************
+ * TEST 2: Readers on other threads never see
+ * a half-written block
+ ***********************************************/
+TEST(SeqLock, ReadersNeverSeeTornBlock)
+{
+    static SeqLock<Block> lock;
+    std::atomic<bool> done = false;
+    std::atomic<uint64_t> torn = 0;
+
+    auto reader = [&]()
+    {
+        Block out;
+        while (!done.load())
+        {
+            lock.load(out);
+            for (uint64_t v : out.values)
+            {
+                if (v != out.values[0]) torn++;
+            }
+        }
+    };
+
+    std::thread r1(reader);
+    std::thread r2(reader);
+
+    for (uint64_t i = 1; i <= 200000; ++i)
+    {
+        lock.write([i](Block& b)
+        {
+            for (uint64_t& v : b.values) v = i;
+        });
+    }
+
+    done = true;
+    r1.join();
+    r2.join();
+
+    ASSERT_EQ(torn.load(), 0);
+    ASSERT_EQ(lock.version(), 200000);
+}
+
+/***********************************************
+ * TEST 3: Top-of-book block, split and same
+ * cache line layouts: a reader polling during
+ * a fixed number of writes never sees a torn
+ * block, then sees the last one
+ * (timings: test_cases/benchmarks/bench_seqlock)
+ ***********************************************/
+template <bool SAME_CACHE_LINE>
+static void check_top_of_book_reads()
+{
+    static SeqLock<Top, SAME_CACHE_LINE> lock;
+    constexpr uint64_t WRITES = 50000;
+    std::atomic<bool> done = false;
+    uint64_t torn = 0;
+
+    std::thread reader([&]()
+    {
+        Top out;
+        while (!done.load())
+        {
+            lock.load(out);
+            if (out.values[4] != out.values[0]) torn++;
+        }
+    });
+
+    for (uint64_t i = 1; i <= WRITES; ++i)
+    {
+        lock.write([i](Top& t)
+        {
+            for (uint64_t& v : t.values) v = i;
+        });
+    }
+
+    done = true;
+    reader.join();
+
+    Top out;
+    ASSERT_EQ(lock.load(out), WRITES);
+    ASSERT_EQ(out.values[0], WRITES);
+    ASSERT_EQ(out.values[4], WRITES);
+    ASSERT_EQ(torn, 0);
+}
+
+TEST(SeqLock, TopOfBookReadsNeverTorn)
+{
+    check_top_of_book_reads<false>();
+    check_top_of_book_reads<true>();
+}
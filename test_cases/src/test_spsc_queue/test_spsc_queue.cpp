@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <queue/spsc_queue.h>
+
+#include <thread>
+
+/***********************************************
+ * TEST 1: Push until full, then drain in order
+ ***********************************************/
+TEST(SPSCQueue, FullThenDrainInOrder)
+{
+    SPSCQueue<int, 8> queue;
+
+    for (int i = 0; i < 8; ++i)
+    {
+        ASSERT_TRUE(queue.try_push(i));
+    }
+    ASSERT_FALSE(queue.try_push(8));
+    ASSERT_EQ(queue.size(), 8);
+
+    int out[8];
+    ASSERT_EQ(queue.pop_batch(out, 5), 5);
+    ASSERT_EQ(queue.pop_batch(out + 5, 5), 3);
+    for (int i = 0; i < 8; ++i)
+    {
+        ASSERT_EQ(out[i], i);
+    }
+
+    int item;
+    ASSERT_FALSE(queue.try_pop(item));
+    ASSERT_TRUE(queue.empty());
+}
+
+/***********************************************
+ * TEST 2: One producer thread, one consumer
+ * thread, every item arrives once and in order
+ ***********************************************/
+TEST(SPSCQueue, ProducerConsumerThreads)
+{
+    static SPSCQueue<uint64_t, 1024> queue;
+    const uint64_t count = 1000000;
+
+    std::thread producer([&]()
+    {
+        for (uint64_t i = 0; i < count; ++i)
+        {
+            queue.push(i);
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t batch[64];
+    while (expected < count)
+    {
+        size_t n = queue.pop_batch(batch, 64);
+        for (size_t i = 0; i < n; ++i)
+        {
+            ASSERT_EQ(batch[i], expected++);
+        }
+    }
+
+    producer.join();
+    ASSERT_TRUE(queue.empty());
+}